@@ -5,9 +5,13 @@
  */
 
 #include "Timer.h"
+#include "driverlib/interrupt.h"
 
 volatile uint32_t _timer_ticks;
 
+// Functions called from the system tick interrupt every millisecond
+static void (*tick_hooks[TIMER_TICK_HOOKS])(void);
+
 /// Waits for a given amount of time in milliseconds
 /** This method waits for a given amount of time given in milliseconds.
  * @param micros The amount of time to wait
@@ -154,3 +158,138 @@ clock_t timer_getClock(void) {
 void timer_stopClock(void) {
 	TIMER5_CTL_R &= ~TIMER_CTL_TBEN;
 }
+
+/// Starts the millisecond system tick
+/** This method configures Timer2A as a periodic 1ms interrupt that counts _timer_ticks.
+ * Timer5 is left free for timer_waitMillis and timer_waitMicros.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+void timer_tickInit(void) {
+	//Enable Timer2
+	SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
+
+	//Disable timer (clear bit TnEN in GPTMCTL)
+	TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+
+	//Set as 16-bit timer
+	TIMER2_CFG_R = TIMER_CFG_16_BIT;
+
+	//Configure the timer for periodic mode
+	//and countdown
+	TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+
+	//Load period of 1ms
+	TIMER2_TAILR_R = 999;
+
+	//Set the prescaler to 15 (period = 1us)
+	TIMER2_TAPR_R = 15;
+
+	//Clear the timeout flag
+	TIMER2_ICR_R = TIMER_ICR_TATOCINT;
+
+	//Enable the timeout interrupt
+	TIMER2_IMR_R = TIMER_IMR_TATOIM;
+
+	//Priority 2, below the PING capture interrupt
+	NVIC_PRI5_R = (NVIC_PRI5_R & 0x1FFFFFFF) | 0x40000000;
+
+	//Enable IRQ 23 (Timer2A)
+	NVIC_EN0_R |= 0x00800000;
+
+	IntRegister(INT_TIMER2A, TIMER2A_Handler);
+	IntMasterEnable();
+
+	//Enable Timer2 A
+	TIMER2_CTL_R |= TIMER_CTL_TAEN;
+}
+
+/// Timer 2A ISR
+/** This method is the interrupt handler for the millisecond system tick.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+void TIMER2A_Handler(void) {
+	//Clear the timeout flag
+	TIMER2_ICR_R = TIMER_ICR_TATOCINT;
+
+	_timer_ticks++;
+
+	int i;
+	for (i = 0; i < TIMER_TICK_HOOKS; i++) {
+		if (tick_hooks[i]) {
+			tick_hooks[i]();
+		}
+	}
+}
+
+/// Adds a function to call on every system tick
+/** This method adds a function that is called from the tick interrupt every millisecond.
+ * Adding a function that is already called does nothing.
+ * @param hook The function to call
+ * @return 1, or 0 if all TIMER_TICK_HOOKS are taken
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+int timer_addTickHook(void (*hook)(void)) {
+	int i;
+
+	for (i = 0; i < TIMER_TICK_HOOKS; i++) {
+		if (tick_hooks[i] == hook) {
+			return 1;
+		}
+	}
+	for (i = 0; i < TIMER_TICK_HOOKS; i++) {
+		if (tick_hooks[i] == 0) {
+			tick_hooks[i] = hook;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/// Returns the number of milliseconds since timer_tickInit
+/** This method returns the millisecond system tick count.
+ * @return The number of milliseconds counted by the system tick.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+uint32_t timer_getMillis(void) {
+	return _timer_ticks;
+}
+
+/// Returns the clock cycle counter
+/** This method reads SysTick, which counts down once per clock cycle over its full 24 bit range.
+ * The first call starts it, and nothing stops it, so every caller that times code shares the one counter.
+ * @return The current count, to pass to timer_cyclesSince
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+uint32_t timer_getCycles(void) {
+	if (!(NVIC_ST_CTRL_R & NVIC_ST_CTRL_ENABLE)) {
+		//Keep an interrupt that also starts it from resetting the count in between
+		bool masked = IntMasterDisable();
+		if (!(NVIC_ST_CTRL_R & NVIC_ST_CTRL_ENABLE)) {
+			NVIC_ST_RELOAD_R = 0x00FFFFFF;
+			NVIC_ST_CURRENT_R = 0;
+			NVIC_ST_CTRL_R = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_ENABLE;
+		}
+		if (!masked) {
+			IntMasterEnable();
+		}
+	}
+
+	return NVIC_ST_CURRENT_R;
+}
+
+/// Returns the clock cycles since a count
+/** This method works across the counter wrapping around, so spans up to 2^24 cycles (about 1s) are right.
+ * @param start A count from timer_getCycles
+ * @return The clock cycles since start
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+uint32_t timer_cyclesSince(uint32_t start) {
+	//SysTick counts down, so the elapsed cycles are start - now
+	return (start - NVIC_ST_CURRENT_R) & 0x00FFFFFF;
+}
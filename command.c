@@ -0,0 +1,174 @@
+/**
+ * @file command.c
+ * @brief This file contains the source code for reading operator commands from the uart.
+ *
+ * Received bytes are put together into lines, and complete lines are queued so several commands can be sent
+ * without waiting for each prompt. Each line is a command name followed by integer arguments separated by spaces.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/30/2018
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "uart.h"
+#include "command.h"
+
+/// A complete line waiting to be run
+typedef struct {
+    char text[COMMAND_LINE_SIZE];
+    int too_long;   // 1 if the line was cut off
+} command_line_t;
+
+// Lines waiting to be run
+static command_line_t queue[COMMAND_QUEUE_SIZE];
+static int queue_head = 0;
+static int queue_count = 0;
+
+// Line being typed
+static command_line_t current;
+static int current_length = 0;
+
+/// Queues the line being typed
+/** This method adds the current line to the queue. Blank lines are ignored.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/30/2018
+ */
+static void end_line()
+{
+
+    current.text[current_length] = '\0';
+
+    if (current_length > 0 || current.too_long) {
+        queue[(queue_head + queue_count) % COMMAND_QUEUE_SIZE] = current;
+        queue_count++;
+    }
+
+    current_length = 0;
+    current.too_long = 0;
+
+}
+
+/// Moves received bytes into the line being typed
+/** This method reads the waiting bytes from the uart. Carriage return or newline ends a line
+ * and backspace removes the last character. Once the queue is full the bytes are left in the uart receive buffer.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/30/2018
+ */
+void command_poll()
+{
+
+    int data;
+
+    while (queue_count < COMMAND_QUEUE_SIZE && (data = uart_tryReceive()) >= 0) {
+        if (data == '\r' || data == '\n') {
+            end_line();
+        } else if (data == '\b' || data == 0x7F) {
+            if (current_length > 0) {
+                current_length--;
+            }
+        } else if (current_length < COMMAND_LINE_SIZE - 1) {
+            current.text[current_length++] = data;
+        } else {
+            current.too_long = 1;
+        }
+    }
+
+}
+
+/// Returns the number of complete lines waiting
+/** This method lets a task check for a command without waiting for one. Call command_poll first to take in new bytes.
+ * @return The number of queued lines
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+int command_pending()
+{
+
+    return queue_count;
+
+}
+
+/// Waits for the next queued line and parses it
+/** This method takes the oldest complete line from the queue, waiting for one if none is queued.
+ * @param command Set to the parsed command.
+ * @return COMMAND_OK, or the reason the line could not be parsed
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/30/2018
+ */
+command_result_t command_receive(command_t *command)
+{
+
+    while (queue_count == 0) {
+        command_poll();
+    }
+
+    command_line_t *line = &queue[queue_head];
+    command_result_t result = command_parse(line->text, command);
+    if (line->too_long) {
+        result = COMMAND_TOO_LONG;
+    }
+
+    queue_head = (queue_head + 1) % COMMAND_QUEUE_SIZE;
+    queue_count--;
+
+    return result;
+
+}
+
+/// Splits a line into a name and integer arguments
+/** This method takes the first word of the line as the name and reads the rest of the words as integers.
+ * @param line The line to parse.
+ * @param command Set to the parsed command.
+ * @return COMMAND_OK, or the reason the line could not be parsed
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/30/2018
+ */
+command_result_t command_parse(const char *line, command_t *command)
+{
+
+    int length = 0;
+
+    command->name[0] = '\0';
+    command->argc = 0;
+
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    if (*line == '\0') {
+        return COMMAND_EMPTY;
+    }
+
+    // Read the name
+    while (*line != '\0' && *line != ' ' && *line != '\t') {
+        if (length == COMMAND_NAME_SIZE - 1) {
+            return COMMAND_TOO_LONG;
+        }
+        command->name[length++] = *line++;
+    }
+    command->name[length] = '\0';
+
+    // Read the arguments
+    while (1) {
+        char *end;
+
+        while (*line == ' ' || *line == '\t') {
+            line++;
+        }
+        if (*line == '\0') {
+            return COMMAND_OK;
+        }
+        if (command->argc == COMMAND_MAX_ARGS) {
+            return COMMAND_TOO_MANY_ARGS;
+        }
+
+        command->argv[command->argc] = strtol(line, &end, 10);
+        if (end == line || (*end != '\0' && *end != ' ' && *end != '\t')) {
+            return COMMAND_BAD_NUMBER;
+        }
+        command->argc++;
+        line = end;
+    }
+
+}
@@ -0,0 +1,51 @@
+/*
+ * command.h
+ *
+ *  Created on: Apr 30, 2018
+ *      Author: mmorth
+ */
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+// Longest command line, including the terminating null
+#define COMMAND_LINE_SIZE 48
+
+// Longest command name, including the terminating null
+#define COMMAND_NAME_SIZE 8
+
+// Most arguments a command takes
+#define COMMAND_MAX_ARGS 4
+
+// Complete lines waiting to be run
+#define COMMAND_QUEUE_SIZE 4
+
+/// Result of parsing a command line
+typedef enum {
+    COMMAND_OK,
+    COMMAND_EMPTY,          // Blank line
+    COMMAND_TOO_LONG,       // Line or name was longer than the buffer and was cut off
+    COMMAND_TOO_MANY_ARGS,  // More than COMMAND_MAX_ARGS arguments
+    COMMAND_BAD_NUMBER      // An argument was not an integer
+} command_result_t;
+
+/// A parsed command, such as "sweep 30 150 2"
+typedef struct {
+    char name[COMMAND_NAME_SIZE];   // First word of the line
+    int argc;                       // Number of arguments
+    int argv[COMMAND_MAX_ARGS];     // Integer arguments
+} command_t;
+
+// Moves received bytes into the line being typed and queues the line when it is complete
+void command_poll();
+
+// Returns the number of complete lines waiting to be run
+int command_pending();
+
+// Waits for the next queued line and parses it
+command_result_t command_receive(command_t *command);
+
+// Splits a line into a name and integer arguments
+command_result_t command_parse(const char *line, command_t *command);
+
+#endif /* COMMAND_H_ */
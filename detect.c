@@ -1,140 +1,257 @@
-/**
- * @file detect.c
- * @brief This file contains the source code for detecting objects.
- *
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- *
- * @date 4/12/2018
- */
-
-#include "Timer.h"
-#include "lcd.h"
-#include <stdbool.h>
-#include "driverlib/interrupt.h"
-#include <math.h>
-#include "distance.h"
-#include "ping.h"
-#include "pwm.h"
-#include "uart.h"
-
-#define M_PI 3.14159265358979323846
-
-int index = 0; // Stores the index of the smallest object
-double distance_away = 0; // Stores the distance the object is away from the sensor in cm
-double distance_width = 0; // Stores the width of the front of the object in cm
-int degrees_object_detected = 0; // Stores the number of degrees an object was detect
-int smallest_object = 0; // Stores the number of degrees an object was detected for
-int smallest_index = 0; // Stores the index of the smallest object found
-int degree_location = 0; // Stores the degree location of the smallest object.
-int previous_distance = 0; // Stores the previous sensed distance.
-
-/// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values
-/** This method sweeps for objects that are 180 degree in front of the robot. It returns the servo degree and ir and ping distances.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void sweep_measure() 
-{
-
-    // Stores the degree measurement
-    int degree = 0;
-
-	// Sweep for each degree between 0 and 180 degrees
-	for (degree = 0; degree <= 180; degree++) {
-		// Move servo to degree position
-		move_servo(degree);
-		
-		// Determine IR sensor values
-		adc_receive();
-		int quantization = ADC_read(0);
-		double ir_distance = convert_distance(quantization);
-		
-		// Determine Ping sensor values
-		int time = ping_read();
-        double ping_distance = cycle2dist(time);
-		
-		// Send data to Putty
-        char message[100];
-        sprintf(message, "%d\t%.2lf\t\t%.2lf\n\r", degree, ir_distance, ping_distance);
-		uart_sendStr(message);
-		
-	}
-
-}
-
-/// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values and moves the servo to the smallest object detected.
-/** This method sweeps for objects that are 180 degree in front of the robot. It returns the servo degree and ir and ping distances.
- * It also keeps track and moves the servo in the direction of the smallest object.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void sweep_measure_record() 
-{
-
-    // Stores the degree measurement
-    int degree = 0;
-
-    // Sweep for each degree between 0 and 180 degrees
-	for (degree = 0; degree <= 180; degree++) {
-		// Move servo to degree position
-		move_servo(degree);
-		
-		// Determine IR sensor values
-		adc_receive();
-		int quantization = ADC_read(0);
-		double ir_distance = convert_distance(quantization);
-		
-		// Determine Ping sensor values
-		double time = ping_read();
-        double ping_distance = cycle2dist(time);
-		
-		// Determine degree width of object
-		if (ir_distance <= 80 && degree != 180) { // && abs(ir_distance - previous_distance) < 10
-			// increment number of degrees the object has been detected
-			degrees_object_detected++;
-			// previous_distance = ir_distance;
-		} else {
-			// previous_distance = ir_distance;
-			// Check for faulty data
-			if (degrees_object_detected > 1) { // valid data. Process
-			
-				// Determine width of object
-				double object_width = ping_distance * 2 * tan((degrees_object_detected/2.0) * (M_PI/180));
-				
-				printf("%d\t%d\n", degrees_object_detected, degree);
-
-				// Increase the number of object detected
-				index++;
-				
-				// Determine if object is smaller than the smallest one found so far
-				if (object_width < distance_width) { // compare against smallest value
-					smallest_object = degrees_object_detected;
-					smallest_index = index;
-					distance_away = ping_distance;
-					degree_location = degree - degrees_object_detected/2;
-					distance_width = object_width;
-				} else { // if first object detected
-					if (distance_width == 0) {
-						smallest_object = degrees_object_detected;
-						smallest_index = index;
-						distance_away = ping_distance;
-						degree_location = degree - degrees_object_detected/2;
-						distance_width = object_width;
-					}
-				}
-
-				// Reset number of degrees object has been detected to zero
-				degrees_object_detected = 0;
-			} else { // faulty data. Do not process
-				degrees_object_detected = 0;
-			}
-		}
-		
-        // Send data to Putty
-        char message[100];
-        sprintf(message, "%d\t%.2lf\t\t%.2lf\n\r", degree, ir_distance, ping_distance);
-        uart_sendStr(message);
-		
-	}
-
-}
+/**
+ * @file detect.c
+ * @brief This file contains the source code for detecting objects.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/12/2018
+ */
+
+#include "Timer.h"
+#include "lcd.h"
+#include <stdbool.h>
+#include "driverlib/interrupt.h"
+#include <math.h>
+#include "distance.h"
+#include "ping.h"
+#include "pwm.h"
+#include "uart.h"
+#include "sweep.h"
+#include "detect.h"
+#include "fusion.h"
+
+#define M_PI 3.14159265358979323846
+
+int index = 0; // Stores the index of the smallest object
+double distance_away = 0; // Stores the distance the object is away from the sensor in cm
+double distance_width = 0; // Stores the width of the front of the object in cm
+int degrees_object_detected = 0; // Stores the number of degrees an object was detect
+int smallest_object = 0; // Stores the number of degrees an object was detected for
+int smallest_index = 0; // Stores the index of the smallest object found
+int degree_location = 0; // Stores the degree location of the smallest object.
+int previous_distance = 0; // Stores the previous sensed distance.
+
+object_t objects[OBJECT_MAX]; // Stores the objects found by the last call to detect_objects
+int object_count = 0; // Stores the number of objects recorded in objects
+int objects_dropped = 0; // Stores the number of objects found after objects was full
+int object_range_mm = OBJECT_MAX_MM; // Stores the farthest distance that counts as seeing an object
+
+/// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values
+/** This method sweeps for objects that are 180 degree in front of the robot. It returns the servo degree and ir and ping distances.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void sweep_measure() 
+{
+
+	// Sweep for each degree between 0 and 180 degrees
+	sweep_start(0, 180);
+
+	sweep_sample_t *sample;
+	while ((sample = sweep_next()) != 0) {
+		// Send data to Putty
+        char message[100];
+        sprintf(message, "%d\t%d.%d\t\t%d.%d\n\r", sample->degree, sample->ir_mm / 10, sample->ir_mm % 10, sample->ping_mm / 10, sample->ping_mm % 10);
+		uart_sendStr(message);
+		
+	}
+
+}
+
+/// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values and moves the servo to the smallest object detected.
+/** This method sweeps for objects that are 180 degree in front of the robot. It returns the servo degree and ir and ping distances.
+ * It also keeps track and moves the servo in the direction of the smallest object.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void sweep_measure_record() 
+{
+
+    // Sweep for each degree between 0 and 180 degrees
+	sweep_start(0, 180);
+
+	sweep_sample_t *sample;
+	while ((sample = sweep_next()) != 0) {
+		int degree = sample->degree;
+		double ir_distance = sample->ir_mm / 10.0;
+        double ping_distance = sample->ping_mm / 10.0;
+		
+		// Determine degree width of object
+		if (ir_distance <= 80 && degree != 180) { // && abs(ir_distance - previous_distance) < 10
+			// increment number of degrees the object has been detected
+			degrees_object_detected++;
+			// previous_distance = ir_distance;
+		} else {
+			// previous_distance = ir_distance;
+			// Check for faulty data
+			if (degrees_object_detected > 1) { // valid data. Process
+			
+				// Determine width of object
+				double object_width = ping_distance * 2 * tan((degrees_object_detected/2.0) * (M_PI/180));
+				
+				printf("%d\t%d\n", degrees_object_detected, degree);
+
+				// Increase the number of object detected
+				index++;
+				
+				// Determine if object is smaller than the smallest one found so far
+				if (object_width < distance_width) { // compare against smallest value
+					smallest_object = degrees_object_detected;
+					smallest_index = index;
+					distance_away = ping_distance;
+					degree_location = degree - degrees_object_detected/2;
+					distance_width = object_width;
+				} else { // if first object detected
+					if (distance_width == 0) {
+						smallest_object = degrees_object_detected;
+						smallest_index = index;
+						distance_away = ping_distance;
+						degree_location = degree - degrees_object_detected/2;
+						distance_width = object_width;
+					}
+				}
+
+				// Reset number of degrees object has been detected to zero
+				degrees_object_detected = 0;
+			} else { // faulty data. Do not process
+				degrees_object_detected = 0;
+			}
+		}
+		
+        // Send data to Putty
+        char message[100];
+        sprintf(message, "%d\t%.2lf\t\t%.2lf\n\r", degree, ir_distance, ping_distance);
+        uart_sendStr(message);
+		
+	}
+
+}
+
+/// Checks whether a sampled degree sees an object
+/** An object is seen when the fused distance is between OBJECT_MIN_MM and object_range_mm (10-50cm unless changed)
+ * with at least OBJECT_MIN_CONFIDENCE.
+ * Call fusion_run after the sweep first.
+ * @param degree The degree to check.
+ * @return 1 if an object was detected at the degree, 0 if not or if the degree was not sampled
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/21/2018
+ */
+int object_at(int degree)
+{
+
+    sweep_sample_t *sample = &sweep_samples[degree];
+
+    return sample->valid && sample->confidence >= OBJECT_MIN_CONFIDENCE
+            && sample->fused_mm >= OBJECT_MIN_MM && sample->fused_mm <= object_range_mm;
+
+}
+
+/// Finds the sampled degree that stands in for a degree
+/** A degree that was not sampled takes the readings of the nearer sampled degree on either side, so a sweep that
+ * only sampled every few degrees inside an object still finds the whole object. Degrees before the first or past the
+ * last sampled degree are not filled in.
+ * @param degree The degree.
+ * @return The degree whose readings to use, or -1 if it is outside the sampled degrees
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static int sampled_degree(int degree)
+{
+
+    int below = degree;
+    int above = degree;
+
+    while (below >= 0 && !sweep_samples[below].valid) {
+        below--;
+    }
+    while (above < SWEEP_DEGREES && !sweep_samples[above].valid) {
+        above++;
+    }
+
+    if (below < 0 || above >= SWEEP_DEGREES) {
+        return -1;
+    }
+    return (degree - below <= above - degree) ? below : above;
+
+}
+
+/// Finds the objects in the last sweep
+/** This method fuses the readings of the last sweep and groups the degrees that see an object into object records. An object has to be seen for
+ * at least OBJECT_MIN_DEGREES degrees in a row to count. The readings are stored by degree, so the objects
+ * do not depend on the sweep direction. Degrees that were not sampled take the readings of the nearer sampled degree.
+ * Once objects is full, the remaining objects are counted in objects_dropped instead of being recorded.
+ * @return The number of objects recorded
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/24/2018
+ */
+int detect_objects()
+{
+
+    // Stores the starting degree position of the detected object.
+    int start_degree = 0;
+
+    // Stores the number of degrees the current object has been detected for.
+    int detected_degrees = 0;
+
+    // Stores the sum and minimum of the fused distances of the current object.
+    int distance_sum = 0;
+    int distance_min = 0;
+
+    int degree;
+
+    object_count = 0;
+    objects_dropped = 0;
+
+    // Combine the IR and PING))) readings of each degree
+    fusion_run();
+
+    // Find the objects in the readings for each degree between 0 and 180 degrees
+    for (degree = 0; degree < SWEEP_DEGREES; degree++) {
+        int sampled = sampled_degree(degree);
+        int distance_mm = (sampled >= 0) ? sweep_samples[sampled].fused_mm : 0;
+
+        // Determine degree width of object
+        if (sampled >= 0 && object_at(sampled) && degree != SWEEP_DEGREES - 1) {
+            // Store the starting degree of the object
+            if (detected_degrees == 0) {
+                start_degree = degree;
+                distance_sum = 0;
+                distance_min = distance_mm;
+            }
+
+            // increment number of degrees the object has been detected
+            detected_degrees++;
+            distance_sum += distance_mm;
+            if (distance_mm < distance_min) {
+                distance_min = distance_mm;
+            }
+            continue;
+        }
+
+        // Check for faulty data
+        if (detected_degrees >= OBJECT_MIN_DEGREES) {
+            if (object_count < OBJECT_MAX) {
+                object_t *object = &objects[object_count];
+                object->id = object_count + 1;
+                object->start_degree = start_degree;
+                object->end_degree = degree - 1;
+                object->mean_mm = distance_sum / detected_degrees;
+                object->min_mm = distance_min;
+                object->samples = detected_degrees;
+
+                // Determine front linear width of object
+                object->width_mm = object->mean_mm * 2 * tan((detected_degrees / 2.0) * (M_PI / 180));
+
+                object_count++;
+            } else {
+                objects_dropped++;
+            }
+        }
+
+        // Reset number of degrees object has been detected to zero
+        detected_degrees = 0;
+    }
+
+    return object_count;
+
+}
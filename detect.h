@@ -1,17 +1,60 @@
-/*
- * detect.h
- *
- *  Created on: Mar 13, 2018
- *      Author: mmorth
- */
-
-#ifndef DETECT_H_
-#define DETECT_H_
-
-// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values
-void sweep_measure();
-
-// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values
-void sweep_measure_record();
-
-#endif /* DETECT_H_ */
+/*
+ * detect.h
+ *
+ *  Created on: Mar 13, 2018
+ *      Author: mmorth
+ */
+
+#ifndef DETECT_H_
+#define DETECT_H_
+
+// Most objects recorded from one sweep
+#define OBJECT_MAX 20
+
+// Fewest degrees in a row an object has to be seen for to count
+#define OBJECT_MIN_DEGREES 5
+
+// Lowest fused confidence that counts as seeing an object.
+// Readings only the PING))) cone sees are not enough on their own.
+#define OBJECT_MIN_CONFIDENCE 64
+
+// Closest and default farthest fused distance in mm that counts as seeing an object
+#define OBJECT_MIN_MM 100
+#define OBJECT_MAX_MM 500
+
+/// Object found in a sweep
+typedef struct {
+    int id;             // Object number, starting at 1
+    int start_degree;   // First degree the object was seen at
+    int end_degree;     // Last degree the object was seen at
+    int mean_mm;        // Average fused distance in mm
+    int min_mm;         // Closest fused distance in mm
+    int width_mm;       // Front linear width in mm
+    int samples;        // Number of degrees the object was seen at, counting degrees filled in from a sampled neighbour
+} object_t;
+
+// Objects found by the last call to detect_objects
+extern object_t objects[OBJECT_MAX];
+
+// Number of objects recorded in objects
+extern int object_count;
+
+// Number of objects found after objects was full
+extern int objects_dropped;
+
+// Farthest fused distance in mm that counts as seeing an object, OBJECT_MAX_MM unless a longer sweep is needed
+extern int object_range_mm;
+
+// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values
+void sweep_measure();
+
+// Moves the servo from 0-180 degrees and returns degree, IR, and ping sensor values
+void sweep_measure_record();
+
+// Returns 1 if the sampled degree sees an object
+int object_at(int degree);
+
+// Finds the objects in the last sweep and returns the number recorded
+int detect_objects();
+
+#endif /* DETECT_H_ */
@@ -1,128 +1,269 @@
-/**
- * @file distance.c
- * @brief This file contains the source code for using the ir distance.
- *
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- *
- * @date 4/12/2018
- */
-
-#include "lcd.h"
-#include "Timer.h"
-#include <math.h>
-
-/// Method that initializes the ADC
-/** This methods initializes the registers required for ACD0 and SS1.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void adc_init(void) 
-{
-
-	//enableADC 0 module on port B
-	SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
-	
-	//enable clock for ADC
-	SYSCTL_RCGCADC_R |= 0x1;
-	
-	//enable port B pin 0 to work as alternate functions
-	GPIO_PORTB_AFSEL_R |= 0x04;
-	
-	//set pin to input -0
-	GPIO_PORTB_DEN_R &= 0b11111011;
-	
-	//disable analog isolation for the pin
-	GPIO_PORTB_AMSEL_R |= 0x04;
-	
-	//initialize the port trigger source as processor (default)
-	GPIO_PORTB_ADCCTL_R = 0x00;
-	
-	//disable SS0 sample sequencer to configure it
-	ADC0_ACTSS_R &= ~ADC_ACTSS_ASEN1;
-	
-	//initialize the ADC trigger source as processor (default)
-	ADC0_EMUX_R = ADC_EMUX_EM1_PROCESSOR;
-	
-	//set 1st sample to use the AIN10 ADC pin
-	ADC0_SSMUX1_R |= 0x000A;
-	
-	//enable raw interrupt status
-	ADC0_SSCTL1_R |= (ADC_SSCTL1_IE0 | ADC_SSCTL1_END0);
-	
-	//enable oversampling to average
-	ADC0_SAC_R |= ADC_SAC_AVG_64X;
-	
-	//re-enable ADC0 SS0
-	ADC0_ACTSS_R |= ADC_ACTSS_ASEN1;
-
-}
-
-/// Method that receives ADC data
-/** This method receives ADC data from the ADC.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void adc_receive(void) 
-{
-
-	//initiate SS1 conversion
-	ADC0_PSSI_R|=ADC_PSSI_SS1;
-	
-	//wait for ADC conversion to be complete
-	while((ADC0_RIS_R & ADC_RIS_INR1) == 0){
-		//wait
-	}
-	
-	//grab result
-	int value = ADC0_SSFIFO1_R;
-	
-	// Set averaging to remove jitters
-	ADC0_SAC_R = 0x04;
-
-}
-
-/// Get a reading from a given ADC channel
-/** This method reads a value from the ADC.
- * @param The ADC channel to read from.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-unsigned ADC_read(char channel)
-{
-
-	//disable ADC0SS0 sample sequencer to configure it
-	ADC0_ACTSS_R &= ~ADC_ACTSS_ASEN1;
-	
-	//set 1st sample to use the channel ADC pin
-	ADC0_SSMUX1_R |= channel;
-	
-	//re-enable ADC0 SS0
-	ADC0_ACTSS_R |= ADC_ACTSS_ASEN1;
-	
-	//initiate SS0 conversion
-	ADC0_PSSI_R=ADC_PSSI_SS1;
-	
-	//wait for ADC conversion to be complete
-	while((ADC0_RIS_R & ADC_RIS_INR1) == 0){
-		
-	}
-	
-	//clear interrupt
-	ADC0_ISC_R=ADC_ISC_IN1;
-	
-	// Return result
-	return ADC0_SSFIFO1_R;
-
-}
-
-/// Conversion between quantization number to distance reading
-/** This method converts the quatization number read from the ADC into a distance value.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-double convert_distance(int quantization)
- {
-
-    return 201480 * pow(quantization, -1.254);
-	
-}
+/**
+ * @file distance.c
+ * @brief This file contains the source code for using the ir distance.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/12/2018
+ */
+
+#include "lcd.h"
+#include "Timer.h"
+#include <math.h>
+#include "driverlib/interrupt.h"
+#include "distance.h"
+#include "ping.h"
+#include "ir_table.h"
+
+// Number of conversions timed by conversion_benchmark
+#define BENCHMARK_CONVERSIONS 256
+
+// uDMA channel 15 is the ADC0 SS1 request
+#define IR_DMA_CHANNEL (1 << 15)
+
+// Word offsets of the channel 15 primary and alternate control structures in dma_table
+#define DMA_PRIMARY (15 * 4)
+#define DMA_ALTERNATE (128 + 15 * 4)
+
+/// uDMA channel control table. The controller needs it aligned to 1024 bytes.
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(dma_table, 1024)
+static volatile uint32_t dma_table[256];
+#else
+static volatile uint32_t dma_table[256] __attribute__((aligned(1024)));
+#endif
+
+/// Method that initializes the ADC
+/** This methods initializes the registers required for ACD0 and SS1.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void adc_init(void) 
+{
+
+	//enableADC 0 module on port B
+	SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
+	
+	//enable clock for ADC
+	SYSCTL_RCGCADC_R |= 0x1;
+	
+	//enable port B pin 0 to work as alternate functions
+	GPIO_PORTB_AFSEL_R |= 0x04;
+	
+	//set pin to input -0
+	GPIO_PORTB_DEN_R &= 0b11111011;
+	
+	//disable analog isolation for the pin
+	GPIO_PORTB_AMSEL_R |= 0x04;
+	
+	//initialize the port trigger source as processor (default)
+	GPIO_PORTB_ADCCTL_R = 0x00;
+	
+	//disable SS0 sample sequencer to configure it
+	ADC0_ACTSS_R &= ~ADC_ACTSS_ASEN1;
+	
+	//initialize the ADC trigger source as processor (default)
+	ADC0_EMUX_R = ADC_EMUX_EM1_PROCESSOR;
+	
+	//set 1st sample to use the AIN10 ADC pin
+	ADC0_SSMUX1_R |= 0x000A;
+	
+	//enable raw interrupt status
+	ADC0_SSCTL1_R |= (ADC_SSCTL1_IE0 | ADC_SSCTL1_END0);
+	
+	//enable oversampling to average
+	ADC0_SAC_R |= ADC_SAC_AVG_64X;
+	
+	//re-enable ADC0 SS0
+	ADC0_ACTSS_R |= ADC_ACTSS_ASEN1;
+
+}
+
+/// Starts sampling the IR sensor in the background
+/** This method switches SS1 from the processor trigger to a Timer0A trigger at IR_SAMPLE_HZ and has uDMA
+ * copy each result into the IR buffer (ir_buffer.c) in ping-pong mode. Call after adc_init. Use adc_latest to read the samples.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/25/2018
+ */
+void adc_dma_init(void)
+{
+
+	//enable clock for uDMA and Timer0
+	SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0;
+	SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0;
+
+	//enable the uDMA controller and point it at the control table
+	UDMA_CFG_R = UDMA_CFG_MASTEN;
+	UDMA_CTLBASE_R = (uint32_t) (uintptr_t) dma_table;
+
+	//use the ADC0 SS1 request on channel 15 with default priority, single and burst requests
+	UDMA_CHMAP1_R &= ~0xF0000000;
+	UDMA_PRIOCLR_R = IR_DMA_CHANNEL;
+	UDMA_ALTCLR_R = IR_DMA_CHANNEL;
+	UDMA_USEBURSTCLR_R = IR_DMA_CHANNEL;
+	UDMA_REQMASKCLR_R = IR_DMA_CHANNEL;
+
+	//fill the first half of the buffer from the primary structure, the second half from the alternate
+	ir_buffer_init(&dma_table[DMA_PRIMARY], &dma_table[DMA_ALTERNATE], &ADC0_SSFIFO1_R);
+
+	//enable the channel
+	UDMA_ENASET_R = IR_DMA_CHANNEL;
+
+	//disable SS1 sample sequencer to configure it
+	ADC0_ACTSS_R &= ~ADC_ACTSS_ASEN1;
+
+	//trigger SS1 from the timer
+	ADC0_EMUX_R = (ADC0_EMUX_R & ~ADC_EMUX_EM1_M) | ADC_EMUX_EM1_TIMER;
+
+	//clear interrupt
+	ADC0_ISC_R = ADC_ISC_IN1;
+
+	//re-enable ADC0 SS1
+	ADC0_ACTSS_R |= ADC_ACTSS_ASEN1;
+
+	//uDMA completions are signalled on the SS1 interrupt (IRQ 15)
+	NVIC_EN0_R |= 0x00008000;
+	IntRegister(INT_ADC0SS1, ADC0SS1_Handler);
+	IntMasterEnable();
+
+	//periodic 32 bit Timer0A that triggers the ADC on each timeout
+	TIMER0_CTL_R &= ~TIMER_CTL_TAEN;
+	TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;
+	TIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+	TIMER0_TAILR_R = 16000000 / IR_SAMPLE_HZ - 1;
+	TIMER0_CTL_R |= (TIMER_CTL_TAOTE | TIMER_CTL_TAEN);
+
+}
+
+/// ADC0 SS1 ISR
+/** This method runs when uDMA has filled one half of the IR buffer. The buffer re-arms the structure that is done
+ * while uDMA fills the other half. If the interrupt came too late and uDMA stopped the channel, it is started
+ * again from the primary structure.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/25/2018
+ */
+void ADC0SS1_Handler(void)
+{
+
+	//clear interrupt
+	ADC0_ISC_R = ADC_ISC_IN1;
+
+	if (ir_buffer_complete()) {
+		UDMA_ALTCLR_R = IR_DMA_CHANNEL;
+		UDMA_ENASET_R = IR_DMA_CHANNEL;
+	}
+
+}
+
+/// Returns the latest IR reading
+/** This method averages the most recently filled half of the IR buffer. It does not touch the ADC or wait.
+ * The samples are at most 2 / IR_SAMPLE_HZ * IR_DMA_HALF seconds old.
+ * @return The averaged quantization number
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/25/2018
+ */
+unsigned adc_latest(void)
+{
+
+	return ir_buffer_average();
+
+}
+
+/// Returns the number of buffer halves filled since adc_dma_init
+/** This method lets a caller wait for readings newer than a given point in time.
+ * @return The number of halves of the IR buffer that uDMA has filled
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/25/2018
+ */
+uint32_t adc_count(void)
+{
+
+	return ir_buffer_count();
+
+}
+
+/// Conversion between quantization number to distance reading
+/** This method converts the quatization number read from the ADC into a distance value.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+double convert_distance(int quantization)
+ {
+
+    return 201480 * pow(quantization, -1.254);
+	
+}
+
+/// Conversion between quantization number to distance reading in integer math
+/** This method interpolates the IR distance table instead of evaluating the curve in double precision.
+ * The table is in ir_table.h, generated from convert_distance by tools/ir_table_gen.c.
+ * @param quantization The quantization number read from the ADC (0-4095).
+ * @return The distance in mm
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/23/2018
+ */
+int ir_to_mm(unsigned quantization)
+{
+
+    if (quantization > 4095) {
+        quantization = 4095;
+    }
+
+    // Interpolate between the table entries on either side
+    unsigned index = quantization >> 4;
+    unsigned fraction = quantization & 0xF;
+    int below = ir_table_mm[index];
+    int above = ir_table_mm[index + 1];
+
+    return below - (((below - above) * fraction + 8) >> 4);
+
+}
+
+/// Times the distance conversions
+/** This method counts the clock cycles each IR and PING))) conversion takes,
+ * for both the double precision formulas and the integer versions.
+ * @param ir_double Set to the cycles per convert_distance call.
+ * @param ir_table Set to the cycles per ir_to_mm call.
+ * @param ping_double Set to the cycles per cycle2dist call.
+ * @param ping_int Set to the cycles per ping_cycles_to_mm call.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/23/2018
+ */
+void conversion_benchmark(uint32_t *ir_double, uint32_t *ir_table, uint32_t *ping_double, uint32_t *ping_int)
+{
+
+    // Keeps the compiler from removing the conversions
+    volatile double double_result;
+    volatile int int_result;
+
+    uint32_t start;
+    int i;
+
+    start = timer_getCycles();
+    for (i = 0; i < BENCHMARK_CONVERSIONS; i++) {
+        double_result = convert_distance(400 + i * 14);
+    }
+    *ir_double = timer_cyclesSince(start) / BENCHMARK_CONVERSIONS;
+
+    start = timer_getCycles();
+    for (i = 0; i < BENCHMARK_CONVERSIONS; i++) {
+        int_result = ir_to_mm(400 + i * 14);
+    }
+    *ir_table = timer_cyclesSince(start) / BENCHMARK_CONVERSIONS;
+
+    start = timer_getCycles();
+    for (i = 0; i < BENCHMARK_CONVERSIONS; i++) {
+        double_result = cycle2dist(1000 + i * 1000);
+    }
+    *ping_double = timer_cyclesSince(start) / BENCHMARK_CONVERSIONS;
+
+    start = timer_getCycles();
+    for (i = 0; i < BENCHMARK_CONVERSIONS; i++) {
+        int_result = ping_cycles_to_mm(1000 + i * 1000);
+    }
+    *ping_int = timer_cyclesSince(start) / BENCHMARK_CONVERSIONS;
+
+    (void) double_result;
+    (void) int_result;
+
+}
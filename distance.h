@@ -1,19 +1,34 @@
-/*
- * Header file for distance.c file
-*/
-
-#ifndef DISTANCE_H_
-#define DISTANCE_H_
-
-#include "Timer.h"
-#include "lcd.h"
-
-void adc_init(void);
-
-void adc_receive(void);
-
-unsigned ADC_read(char channel);
-
-double convert_distance(int quantization);
-
-#endif /* DISTANCE_H_ */
+/*
+ * Header file for distance.c file
+*/
+
+#ifndef DISTANCE_H_
+#define DISTANCE_H_
+
+#include "Timer.h"
+#include "lcd.h"
+#include "ir_buffer.h"
+
+// Number of entries in the IR distance table, one every 16 quantization numbers from 0 to 4096
+#define IR_TABLE_SIZE 257
+
+// Rate the IR sensor is sampled at once adc_dma_init is called
+#define IR_SAMPLE_HZ 4000
+
+void adc_init(void);
+
+void adc_dma_init(void);
+
+void ADC0SS1_Handler(void);
+
+unsigned adc_latest(void);
+
+uint32_t adc_count(void);
+
+double convert_distance(int quantization);
+
+int ir_to_mm(unsigned quantization);
+
+void conversion_benchmark(uint32_t *ir_double, uint32_t *ir_table, uint32_t *ping_double, uint32_t *ping_int);
+
+#endif /* DISTANCE_H_ */
@@ -0,0 +1,333 @@
+/**
+ * @file finish.c
+ * @brief This file contains the source code for finding the finish zone in the objects of a sweep.
+ *
+ * The finish zone is marked by four thin posts at the corners of a rectangle. Each object narrow enough
+ * to be a post is placed at its middle relative to the robot, and every set of four is checked: the six
+ * spacings between them, smallest first, must each be within the tolerance of two short sides, two long sides,
+ * and two diagonals, and the two diagonals must not share a post. If no four match, sets of three are checked
+ * as three corners of the rectangle, as long as the fourth corner is hidden behind another object or outside the sweep.
+ * The closest match is taken.
+ *
+ * Spacings are worked out once for each pair in single precision, which the FPU does in hardware.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/7/2018
+ */
+
+#include <math.h>
+#include "sweep.h"
+#include "finish.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Layout searched for by finish_find
+finish_geometry_t finish_geometry = { FINISH_LENGTH_MM, FINISH_WIDTH_MM, FINISH_TOLERANCE_MM,
+                                      FINISH_POST_MAX_WIDTH_MM, FINISH_POST_RADIUS_MM };
+
+/// Middle of a post relative to the middle of the robot
+typedef struct {
+    float x;        // mm forward
+    float y;        // mm left
+    int object;     // Index in the object list
+} post_t;
+
+static post_t posts[OBJECT_MAX]; // Objects narrow enough to be posts
+static float spacing[OBJECT_MAX][OBJECT_MAX]; // Distance between each pair of posts
+
+/// Returns the length of a vector
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+static float length(float x, float y)
+{
+
+    return sqrtf(x * x + y * y);
+
+}
+
+/// Rounds to the nearest whole number
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+static int nearest(float value)
+{
+
+    return (int) (value < 0 ? value - 0.5f : value + 0.5f);
+
+}
+
+/// Places an object relative to the middle of the robot
+/** @param object The object.
+ * @param x Set to the mm forward of the middle of the robot.
+ * @param y Set to the mm left of the middle of the robot.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+static void place(const object_t *object, float *x, float *y)
+{
+
+    // Degree 90 is straight ahead
+    float angle = ((object->start_degree + object->end_degree) / 2.0f - 90) * (float) (M_PI / 180);
+    float range = object->mean_mm + finish_geometry.post_radius_mm;
+
+    *x = SWEEP_SENSOR_OFFSET_MM + range * cosf(angle);
+    *y = range * sinf(angle);
+
+}
+
+/// Sorts a few spacings, smallest first
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+static void sort(float *values, int count)
+{
+
+    int i, j;
+
+    for (i = 1; i < count; i++) {
+        float value = values[i];
+        for (j = i; j > 0 && values[j - 1] > value; j--) {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+
+}
+
+/// Returns the largest difference between sorted spacings and the ones expected
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+static float spacing_error(const float *values, const float *expected, int count)
+{
+
+    float worst = 0;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        float error = fabsf(values[i] - expected[i]);
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    return worst;
+
+}
+
+/// Returns 1 if a point could not have been seen by the sweep
+/** A point is hidden if it is outside the sweep, farther than object_range_mm,
+ * or within FINISH_HIDDEN_DEGREES of an object that is closer.
+ * @param list The objects of the sweep.
+ * @param count The number of objects.
+ * @param x The mm forward of the middle of the robot.
+ * @param y The mm left of the middle of the robot.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+static int hidden(const object_t *list, int count, float x, float y)
+{
+
+    float degree = atan2f(y, x - SWEEP_SENSOR_OFFSET_MM) * (float) (180 / M_PI) + 90;
+    float range = length(x - SWEEP_SENSOR_OFFSET_MM, y);
+    int i;
+
+    if (degree < 0 || degree > 180 || range - finish_geometry.post_radius_mm > object_range_mm) {
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (degree >= list[i].start_degree - FINISH_HIDDEN_DEGREES && degree <= list[i].end_degree + FINISH_HIDDEN_DEGREES
+                && list[i].mean_mm < range) {
+            return 1;
+        }
+    }
+    return 0;
+
+}
+
+/// Fills in the middle and headings of a zone from its corners
+/** @param zone The zone.
+ * @param corner_x The x of the corners in order around the rectangle.
+ * @param corner_y The y of the corners in order around the rectangle.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+static void describe(finish_zone_t *zone, const float *corner_x, const float *corner_y)
+{
+
+    float x = (corner_x[0] + corner_x[1] + corner_x[2] + corner_x[3]) / 4;
+    float y = (corner_y[0] + corner_y[1] + corner_y[2] + corner_y[3]) / 4;
+    float best = -1e9f;
+    float best_x = 1, best_y = 0;
+    int side, sign;
+
+    zone->x_mm = nearest(x);
+    zone->y_mm = nearest(y);
+    zone->distance_mm = nearest(length(x, y));
+    zone->bearing = nearest(atan2f(y, x) * (float) (180 / M_PI));
+
+    // Drive along whichever side of the rectangle points most nearly at the middle
+    for (side = 1; side <= 3; side += 2) {
+        float dx = corner_x[side] - corner_x[0];
+        float dy = corner_y[side] - corner_y[0];
+        float side_length = length(dx, dy);
+        for (sign = -1; sign <= 1; sign += 2) {
+            float along = sign * (dx * x + dy * y) / side_length;
+            if (along > best) {
+                best = along;
+                best_x = sign * dx;
+                best_y = sign * dy;
+            }
+        }
+    }
+    zone->heading = nearest(atan2f(best_y, best_x) * (float) (180 / M_PI));
+
+}
+
+/// Searches the objects of a sweep for the finish zone
+/** This method tries every set of four narrow objects, then every set of three with the fourth hidden,
+ * and keeps the set whose worst spacing is closest to the layout in finish_geometry.
+ * @param list The objects of the sweep, such as objects after detect_objects.
+ * @param count The number of objects.
+ * @param zone Filled in with the zone found. posts is 0 if there is none.
+ * @return The number of posts matched: 4, 3, or 0 if no zone was found
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/7/2018
+ */
+int finish_find(const object_t *list, int count, finish_zone_t *zone)
+{
+
+    float short_side = finish_geometry.width_mm < finish_geometry.length_mm ? finish_geometry.width_mm : finish_geometry.length_mm;
+    float long_side = finish_geometry.width_mm < finish_geometry.length_mm ? finish_geometry.length_mm : finish_geometry.width_mm;
+    float diagonal = length(short_side, long_side);
+    const float four[6] = { short_side, short_side, long_side, long_side, diagonal, diagonal };
+    const float three[3] = { short_side, long_side, diagonal };
+
+    float best = finish_geometry.tolerance_mm;
+    float corner_x[4], corner_y[4];
+    float values[6];
+    int n = 0;
+    int a, b, c, d, i, j;
+
+    zone->posts = 0;
+    for (i = 0; i < 4; i++) {
+        zone->object[i] = -1;
+    }
+
+    for (i = 0; i < count && n < OBJECT_MAX; i++) {
+        if (list[i].width_mm <= finish_geometry.post_max_width_mm) {
+            place(&list[i], &posts[n].x, &posts[n].y);
+            posts[n].object = i;
+            n++;
+        }
+    }
+    zone->candidates = n;
+
+    for (i = 0; i < n; i++) {
+        for (j = i + 1; j < n; j++) {
+            spacing[i][j] = spacing[j][i] = length(posts[i].x - posts[j].x, posts[i].y - posts[j].y);
+        }
+    }
+
+    for (a = 0; a < n; a++) {
+        for (b = a + 1; b < n; b++) {
+            for (c = b + 1; c < n; c++) {
+                for (d = c + 1; d < n; d++) {
+                    values[0] = spacing[a][b];
+                    values[1] = spacing[a][c];
+                    values[2] = spacing[a][d];
+                    values[3] = spacing[b][c];
+                    values[4] = spacing[b][d];
+                    values[5] = spacing[c][d];
+                    sort(values, 6);
+
+                    float error = spacing_error(values, four, 6);
+                    if (error > best) {
+                        continue;
+                    }
+
+                    // The diagonals are the two longest spacings, and each joins a different pair of corners
+                    int set[4] = { a, b, c, d };
+                    int opposite = 1;
+                    for (i = 2; i < 4; i++) {
+                        if (spacing[a][set[i]] > spacing[a][set[opposite]]) {
+                            opposite = i;
+                        }
+                    }
+                    int p = set[opposite == 1 ? 2 : 1];
+                    int q = set[opposite == 3 ? 2 : 3];
+                    if (spacing[p][q] < values[4] - 0.5f) {
+                        continue;
+                    }
+
+                    best = error;
+                    zone->posts = 4;
+                    int order[4] = { a, p, set[opposite], q };
+                    for (i = 0; i < 4; i++) {
+                        corner_x[i] = posts[order[i]].x;
+                        corner_y[i] = posts[order[i]].y;
+                        zone->object[i] = posts[order[i]].object;
+                    }
+                }
+            }
+        }
+    }
+
+    if (zone->posts == 0) {
+        for (a = 0; a < n; a++) {
+            for (b = a + 1; b < n; b++) {
+                for (c = b + 1; c < n; c++) {
+                    values[0] = spacing[a][b];
+                    values[1] = spacing[a][c];
+                    values[2] = spacing[b][c];
+                    sort(values, 3);
+
+                    float error = spacing_error(values, three, 3);
+                    if (error > best) {
+                        continue;
+                    }
+
+                    // The square corner is the one across from the longest spacing
+                    int corner = c, first = a, second = b;
+                    if (spacing[b][c] >= spacing[a][b] && spacing[b][c] >= spacing[a][c]) {
+                        corner = a;
+                        first = b;
+                        second = c;
+                    } else if (spacing[a][c] >= spacing[a][b]) {
+                        corner = b;
+                        first = a;
+                        second = c;
+                    }
+
+                    float hidden_x = posts[first].x + posts[second].x - posts[corner].x;
+                    float hidden_y = posts[first].y + posts[second].y - posts[corner].y;
+                    if (!hidden(list, count, hidden_x, hidden_y)) {
+                        continue;
+                    }
+
+                    best = error;
+                    zone->posts = 3;
+                    int order[3] = { first, corner, second };
+                    for (i = 0; i < 3; i++) {
+                        corner_x[i] = posts[order[i]].x;
+                        corner_y[i] = posts[order[i]].y;
+                        zone->object[i] = posts[order[i]].object;
+                    }
+                    corner_x[3] = hidden_x;
+                    corner_y[3] = hidden_y;
+                    zone->object[3] = -1;
+                }
+            }
+        }
+    }
+
+    if (zone->posts > 0) {
+        zone->error_mm = nearest(best);
+        describe(zone, corner_x, corner_y);
+    }
+    return zone->posts;
+
+}
@@ -0,0 +1,61 @@
+/*
+ * finish.h
+ *
+ *  Created on: May 7, 2018
+ *      Author: mmorth
+ */
+
+#ifndef FINISH_H_
+#define FINISH_H_
+
+#include "detect.h"
+
+// Default layout of the four posts marking the finish zone, in mm between their middles
+#define FINISH_LENGTH_MM 610
+#define FINISH_WIDTH_MM 610
+
+// Default largest difference from the layout allowed in any spacing between posts
+#define FINISH_TOLERANCE_MM 80
+
+// Default widest object that can be a post as the sweep measures it, and the radius of a post,
+// added to the distance of its face to get its middle. The beams make thin posts look wider the farther they are,
+// about 11 degrees across at FINISH_RANGE_MM.
+#define FINISH_POST_MAX_WIDTH_MM 160
+#define FINISH_POST_RADIUS_MM 20
+
+// A post that was not seen is taken to be hidden if it is this many degrees or less behind a seen object,
+// outside the sweep, or farther than the sweep counts objects
+#define FINISH_HIDDEN_DEGREES 6
+
+// Farthest distance in mm to count objects at when sweeping for the finish zone, as far as the IR sensor reads
+#define FINISH_RANGE_MM 800
+
+/// Layout of the finish zone
+typedef struct {
+    int length_mm;          // Spacing along the long side
+    int width_mm;           // Spacing along the short side
+    int tolerance_mm;       // Largest spacing error allowed
+    int post_max_width_mm;  // Widest object that can be a post
+    int post_radius_mm;     // Radius of each post
+} finish_geometry_t;
+
+/// Finish zone found in a sweep
+typedef struct {
+    int posts;          // Posts matched: 4, 3 when the fourth is hidden behind another, or 0 if no zone was found
+    int object[4];      // Index of each matched post in the object list, or -1 for a hidden post
+    int x_mm;           // Middle of the zone in mm forward of the middle of the robot
+    int y_mm;           // Middle of the zone in mm left of the middle of the robot
+    int distance_mm;    // Distance to the middle of the zone
+    int bearing;        // Degrees to turn to face the middle of the zone, positive left
+    int heading;        // Degrees to turn to drive straight into the zone through its nearest side, positive left
+    int error_mm;       // Largest spacing error of the matched posts
+    int candidates;     // Objects narrow enough to be posts
+} finish_zone_t;
+
+// Layout searched for by finish_find
+extern finish_geometry_t finish_geometry;
+
+// Searches the objects of a sweep for the finish zone. Returns the number of posts matched, 0 if none.
+int finish_find(const object_t *list, int count, finish_zone_t *zone);
+
+#endif /* FINISH_H_ */
@@ -0,0 +1,178 @@
+/**
+ * @file fusion.c
+ * @brief This file contains the source code for combining the IR and PING))) readings of a sweep.
+ *
+ * Each sensor gets a noise model. The IR sensor is precise up close but its error grows with the
+ * square of the distance, and it only sees straight ahead. The PING))) sensor has a small error that
+ * grows slowly with distance, but its wide cone also sees objects to either side of the servo degree.
+ * When the two agree, the distances are averaged weighted by the inverse of their variances. When they
+ * do not, the IR reading is used for the direction and the confidence is lowered.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/27/2018
+ */
+
+#include <stdlib.h>
+#include "sweep.h"
+#include "fusion.h"
+
+/// Returns the variance of an IR reading
+/** This method models the IR standard deviation as 5mm plus distance^2 / 16000, in mm.
+ * @param ir_mm The IR distance in mm.
+ * @return The variance in mm^2
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/27/2018
+ */
+static int ir_variance(int ir_mm)
+{
+
+    int sigma = 5 + (ir_mm * ir_mm) / 16000;
+    return sigma * sigma;
+
+}
+
+/// Returns the variance of a PING))) reading
+/** This method models the PING))) standard deviation as 10mm plus 1% of the distance, in mm.
+ * @param ping_mm The PING))) distance in mm.
+ * @return The variance in mm^2
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/27/2018
+ */
+static int ping_variance(int ping_mm)
+{
+
+    int sigma = 10 + ping_mm / 100;
+    return sigma * sigma;
+
+}
+
+/// Returns the integer square root
+/** This method finds the largest integer whose square is not more than value.
+ * @param value The number to take the square root of.
+ * @return The square root rounded down
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/27/2018
+ */
+static int isqrt(int value)
+{
+
+    int root = 0;
+    int bit = 1 << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+
+}
+
+/// Fuses the IR and PING))) readings of one degree
+/** This method combines the two readings into one distance using the noise model of each sensor.
+ * @param ir_mm The IR distance in mm.
+ * @param ping_mm The PING))) distance in mm.
+ * @param echo 1 if the ping got an echo, 0 if it timed out.
+ * @param confidence Set to the confidence in the result, from 0 (no reading) to 255.
+ * @return The fused distance in mm, or FUSION_NO_READING if neither sensor has a reading
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/27/2018
+ */
+int fuse(int ir_mm, int ping_mm, int echo, int *confidence)
+{
+
+    int ir_valid = ir_mm >= FUSION_IR_MIN_MM && ir_mm <= FUSION_IR_MAX_MM;
+    int ping_valid = echo && ping_mm >= FUSION_PING_MIN_MM;
+
+    if (!ir_valid && !ping_valid) {
+        *confidence = 0;
+        return FUSION_NO_READING;
+    }
+    if (!ping_valid) {
+        *confidence = FUSION_CONFIDENCE_IR_ONLY;
+        return ir_mm;
+    }
+    if (!ir_valid) {
+        *confidence = FUSION_CONFIDENCE_PING_ONLY;
+        return ping_mm;
+    }
+
+    int var_ir = ir_variance(ir_mm);
+    int var_ping = ping_variance(ping_mm);
+
+    // The readings agree when they are within 3 standard deviations of their difference
+    int gate = 3 * isqrt(var_ir + var_ping);
+    int difference = abs(ir_mm - ping_mm);
+
+    if (difference > gate) {
+        *confidence = FUSION_CONFIDENCE_DISAGREE;
+        return ir_mm;
+    }
+
+    *confidence = 255 - ((255 - FUSION_CONFIDENCE_AGREE_MIN) * difference) / gate;
+
+    // Inverse variance weighted average
+    return (ir_mm * var_ping + ping_mm * var_ir) / (var_ir + var_ping);
+
+}
+
+/// Returns the median of three readings
+/** This method finds the middle value of three readings.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/27/2018
+ */
+static int median3(int a, int b, int c)
+{
+
+    if (a > b) {
+        int swap = a;
+        a = b;
+        b = swap;
+    }
+    if (b > c) {
+        b = c;
+    }
+    return (a > b) ? a : b;
+
+}
+
+/// Fuses the readings of every sampled degree of the last sweep
+/** This method removes single noisy readings with a median of each degree and its sampled neighbours,
+ * then fuses the IR and PING))) readings of each degree into fused_mm and confidence.
+ * Degrees without two sampled neighbours are fused as they are.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/27/2018
+ */
+void fusion_run()
+{
+
+    int degree;
+
+    for (degree = 0; degree < SWEEP_DEGREES; degree++) {
+        sweep_sample_t *sample = &sweep_samples[degree];
+
+        if (!sample->valid) {
+            continue;
+        }
+
+        int ir_mm = sample->ir_mm;
+        int ping_mm = sample->ping_mm;
+
+        if (degree > 0 && degree < SWEEP_DEGREES - 1 && sample[-1].valid && sample[1].valid) {
+            ir_mm = median3(sample[-1].ir_mm, ir_mm, sample[1].ir_mm);
+            ping_mm = median3(sample[-1].ping_mm, ping_mm, sample[1].ping_mm);
+        }
+
+        sample->fused_mm = fuse(ir_mm, ping_mm, sample->echo, &sample->confidence);
+    }
+
+}
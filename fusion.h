@@ -0,0 +1,33 @@
+/*
+ * fusion.h
+ *
+ *  Created on: Apr 27, 2018
+ *      Author: mmorth
+ */
+
+#ifndef FUSION_H_
+#define FUSION_H_
+
+// Range the IR sensor reads reliably in mm
+#define FUSION_IR_MIN_MM 100
+#define FUSION_IR_MAX_MM 800
+
+// Closest distance the PING))) sensor reads reliably in mm
+#define FUSION_PING_MIN_MM 20
+
+// Confidence given to each kind of estimate (0-255)
+#define FUSION_CONFIDENCE_AGREE_MIN 128     // Both sensors agree, scaled up to 255 as they get closer
+#define FUSION_CONFIDENCE_IR_ONLY 96        // Only the narrow IR beam sees something
+#define FUSION_CONFIDENCE_DISAGREE 64       // The sensors disagree, IR is trusted for the direction
+#define FUSION_CONFIDENCE_PING_ONLY 48      // Only the wide PING))) cone sees something
+
+// Fused distance reported when neither sensor has a reading
+#define FUSION_NO_READING 0xFFFF
+
+// Fuses the IR and PING))) readings of one degree and returns the distance in mm
+int fuse(int ir_mm, int ping_mm, int echo, int *confidence);
+
+// Fuses the readings of every sampled degree of the last sweep
+void fusion_run();
+
+#endif /* FUSION_H_ */
@@ -0,0 +1,321 @@
+/**
+ * @file grid.c
+ * @brief This file contains the source code for the occupancy grid of the course.
+ *
+ * The grid keeps 4 bits of evidence for each cell, two cells to a byte. Each sweep is added at the robot's
+ * odometry pose by tracing the fused reading of every degree out from the sensors: the cells along the way
+ * are seen to be clear, and the cell at the reading is seen to be occupied. Only the state of a cell
+ * (unknown, free, or occupied) is sent, and only when it changes, so the ground station keeps a live map
+ * from a few frames per sweep instead of the whole grid.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/5/2018
+ */
+
+#include "Timer.h"
+#include "grid.h"
+#include "sweep.h"
+#include "fusion.h"
+#include "odometry.h"
+#include "telemetry.h"
+
+// Statistics of the last sweep added
+grid_stats_t grid_stats;
+
+// Evidence of each cell, two to a byte with the even cell in the low bits.
+// Stored xor GRID_EVIDENCE_UNKNOWN so the zeroed RAM starts out unknown.
+static uint8_t evidence[(GRID_CELLS + 1) / 2];
+
+// One bit for each cell whose state changed since it was last sent
+static uint8_t dirty[(GRID_CELLS + 7) / 8];
+
+/// Returns the evidence of a cell
+/** @param cell The cell index.
+ * @return The evidence from 0 to GRID_EVIDENCE_MAX
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+static int get_evidence(int cell)
+{
+
+    int stored = (cell & 1) ? evidence[cell >> 1] >> 4 : evidence[cell >> 1] & 0x0F;
+    return stored ^ GRID_EVIDENCE_UNKNOWN;
+
+}
+
+/// Returns the state of a cell from its evidence
+/** @param cell The cell index.
+ * @return GRID_UNKNOWN, GRID_FREE, or GRID_OCCUPIED
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+static int cell_state(int cell)
+{
+
+    int value = get_evidence(cell);
+
+    if (value >= GRID_OCCUPIED_AT) {
+        return GRID_OCCUPIED;
+    }
+    if (value <= GRID_FREE_AT) {
+        return GRID_FREE;
+    }
+    return GRID_UNKNOWN;
+
+}
+
+/// Adds evidence to a cell
+/** This method adds to the evidence of the cell, keeping it within 4 bits, and marks the cell to be sent
+ * if its state changed.
+ * @param cell The cell index.
+ * @param change The evidence to add, negative for a miss.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+static void add_evidence(int cell, int change)
+{
+
+    int before = cell_state(cell);
+    int value = get_evidence(cell) + change;
+
+    if (value < 0) {
+        value = 0;
+    } else if (value > GRID_EVIDENCE_MAX) {
+        value = GRID_EVIDENCE_MAX;
+    }
+
+    value ^= GRID_EVIDENCE_UNKNOWN;
+    if (cell & 1) {
+        evidence[cell >> 1] = (evidence[cell >> 1] & 0x0F) | (value << 4);
+    } else {
+        evidence[cell >> 1] = (evidence[cell >> 1] & 0xF0) | value;
+    }
+
+    if (cell_state(cell) != before) {
+        dirty[cell >> 3] |= 1 << (cell & 7);
+        grid_stats.changed++;
+    }
+
+}
+
+/// Sets every cell to unknown
+/** This method forgets the map, for example when the robot is put back at the start.
+ * Nothing is marked to be sent, so call grid_mark_all after clearing a map the ground station already has.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void grid_clear(void)
+{
+
+    int i;
+
+    for (i = 0; i < (GRID_CELLS + 1) / 2; i++) {
+        evidence[i] = 0;
+    }
+    for (i = 0; i < (GRID_CELLS + 7) / 8; i++) {
+        dirty[i] = 0;
+    }
+
+}
+
+/// Returns the cell index of a point
+/** @param x_mm The distance forward of the starting pose in mm.
+ * @param y_mm The distance left of the starting pose in mm.
+ * @return The cell index, or -1 if the point is outside the grid
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+int grid_index(int32_t x_mm, int32_t y_mm)
+{
+
+    int32_t x = x_mm + GRID_ORIGIN_X_MM;
+    int32_t y = y_mm + GRID_ORIGIN_Y_MM;
+
+    if (x < 0 || y < 0 || x >= GRID_WIDTH * GRID_CELL_MM || y >= GRID_HEIGHT * GRID_CELL_MM) {
+        return -1;
+    }
+    return (y / GRID_CELL_MM) * GRID_WIDTH + x / GRID_CELL_MM;
+
+}
+
+/// Returns the state of a cell
+/** @param x The column, 0 at the left edge of the grid.
+ * @param y The row, 0 at the bottom edge of the grid.
+ * @return GRID_UNKNOWN, GRID_FREE, or GRID_OCCUPIED
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+int grid_state(int x, int y)
+{
+
+    if (x < 0 || y < 0 || x >= GRID_WIDTH || y >= GRID_HEIGHT) {
+        return GRID_UNKNOWN;
+    }
+    return cell_state(y * GRID_WIDTH + x);
+
+}
+
+/// Traces one reading into the grid
+/** This method steps half a cell at a time from the sensors along the direction of the reading.
+ * Each cell passed through before the reading gets a miss, once, and the cell at the reading gets a hit.
+ * @param x The x position of the sensors in 1/65536 mm.
+ * @param y The y position of the sensors in 1/65536 mm.
+ * @param angle The direction of the reading as a binary angle.
+ * @param range_mm How far out the cells are clear.
+ * @param hit The evidence to add at range_mm, or 0 if nothing was seen.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+static void trace(int32_t x, int32_t y, uint32_t angle, int range_mm, int hit)
+{
+
+    // Half a cell along the direction, in 1/65536 mm
+    int32_t step_x = odometry_cos(angle) * GRID_CELL_MM;
+    int32_t step_y = odometry_sin(angle) * GRID_CELL_MM;
+    int steps = range_mm * 2 / GRID_CELL_MM;
+
+    int end = -1;
+    int last = -1;
+    int i;
+
+    if (hit) {
+        end = grid_index((x + ((odometry_cos(angle) * range_mm) << 1)) >> ODOMETRY_SHIFT,
+                         (y + ((odometry_sin(angle) * range_mm) << 1)) >> ODOMETRY_SHIFT);
+    }
+
+    for (i = 0; i < steps; i++) {
+        int cell = grid_index(x >> ODOMETRY_SHIFT, y >> ODOMETRY_SHIFT);
+        if (cell >= 0 && cell != last && cell != end) {
+            add_evidence(cell, -GRID_EVIDENCE_MISS);
+        }
+        last = cell;
+        x += step_x;
+        y += step_y;
+    }
+
+    if (end >= 0) {
+        add_evidence(end, hit);
+    }
+
+}
+
+/// Adds the last sweep to the grid
+/** This method traces the fused reading of every sampled degree from where the sensors are at the current
+ * odometry pose. Degree 90 points straight ahead and degree 0 to the right. Readings farther than
+ * GRID_MAX_RANGE_MM, and degrees with no reading, only clear the cells out to GRID_CLEAR_RANGE_MM.
+ * Readings only the wide PING))) cone saw add less evidence, since the object may be to either side.
+ * Call fusion_run first.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void grid_add_sweep(void)
+{
+
+    odometry_pose_t pose;
+    int degree;
+
+    uint32_t start = timer_getCycles();
+
+    grid_stats.rays = 0;
+    grid_stats.changed = 0;
+
+    odometry_get(&pose);
+    int32_t x = pose.x + SWEEP_SENSOR_OFFSET_MM * (odometry_cos(pose.heading) << 1);
+    int32_t y = pose.y + SWEEP_SENSOR_OFFSET_MM * (odometry_sin(pose.heading) << 1);
+
+    for (degree = 0; degree < SWEEP_DEGREES; degree++) {
+        const sweep_sample_t *sample = &sweep_samples[degree];
+
+        if (!sample->valid) {
+            continue;
+        }
+
+        uint32_t angle = pose.heading + ODOMETRY_ANGLE_DEGREES(degree - 90);
+
+        if (sample->fused_mm == FUSION_NO_READING || sample->fused_mm > GRID_MAX_RANGE_MM) {
+            trace(x, y, angle, GRID_CLEAR_RANGE_MM, 0);
+        } else {
+            int hit = (sample->confidence > FUSION_CONFIDENCE_PING_ONLY) ? GRID_EVIDENCE_HIT : GRID_EVIDENCE_HIT - 1;
+            trace(x, y, angle, sample->fused_mm, hit);
+        }
+        grid_stats.rays++;
+    }
+
+    grid_stats.cycles = timer_cyclesSince(start);
+
+}
+
+/// Marks every known cell to be sent again
+/** This method lets a ground station that just connected get the whole map from the next grid_send.
+ * Unknown cells are not sent, since the ground station starts with every cell unknown.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void grid_mark_all(void)
+{
+
+    int cell;
+
+    for (cell = 0; cell < GRID_CELLS; cell++) {
+        if (cell_state(cell) != GRID_UNKNOWN) {
+            dirty[cell >> 3] |= 1 << (cell & 7);
+        }
+    }
+
+}
+
+/// Sends the cells that changed
+/** This method sends each changed cell with up to GRID_DELTA_CELLS - 1 cells after it, as long as the last of them
+ * also changed, so cells that changed close together go in one delta. It ends with the size of the grid,
+ * the number of cells sent, and the cell the robot is in.
+ * @return The number of deltas sent
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+int grid_send(void)
+{
+
+    uint8_t states[GRID_DELTA_CELLS];
+    odometry_pose_t pose;
+    int deltas = 0;
+    int cells = 0;
+    int cell = 0;
+
+    while (cell < GRID_CELLS) {
+        // Skip 8 clean cells at a time
+        if ((cell & 7) == 0 && dirty[cell >> 3] == 0) {
+            cell += 8;
+            continue;
+        }
+        if (!(dirty[cell >> 3] & (1 << (cell & 7)))) {
+            cell++;
+            continue;
+        }
+
+        // Take the cells up to the last changed one within reach
+        int count = 0;
+        int i;
+        for (i = 0; i < GRID_DELTA_CELLS && cell + i < GRID_CELLS; i++) {
+            if (dirty[(cell + i) >> 3] & (1 << ((cell + i) & 7))) {
+                count = i + 1;
+            }
+        }
+
+        for (i = 0; i < count; i++) {
+            states[i] = cell_state(cell + i);
+            dirty[(cell + i) >> 3] &= ~(1 << ((cell + i) & 7));
+        }
+
+        telemetry_grid(cell, count, states);
+        deltas++;
+        cells += count;
+        cell += count;
+    }
+
+    odometry_get(&pose);
+    telemetry_grid_end(GRID_WIDTH, GRID_HEIGHT, GRID_CELL_MM, cells,
+                       grid_index(pose.x >> ODOMETRY_SHIFT, pose.y >> ODOMETRY_SHIFT));
+    return deltas;
+
+}
@@ -0,0 +1,79 @@
+/*
+ * grid.h
+ *
+ *  Created on: May 5, 2018
+ *      Author: mmorth
+ */
+
+#ifndef GRID_H_
+#define GRID_H_
+
+#include <stdint.h>
+
+// Size of the course covered by the grid and of each cell in mm.
+// At most 255 cells across and up, and the cell count must fit in 16 bits.
+#define GRID_CELL_MM 50
+#define GRID_WIDTH_MM 4000
+#define GRID_HEIGHT_MM 4000
+
+// Where the starting pose (0, 0) is, in mm from the lower left corner of the grid.
+// The robot starts facing along x, so the grid reaches 3.5m ahead and 2m to each side.
+#define GRID_ORIGIN_X_MM 500
+#define GRID_ORIGIN_Y_MM 2000
+
+// Cells across and up the grid
+#define GRID_WIDTH (GRID_WIDTH_MM / GRID_CELL_MM)
+#define GRID_HEIGHT (GRID_HEIGHT_MM / GRID_CELL_MM)
+#define GRID_CELLS (GRID_WIDTH * GRID_HEIGHT)
+
+// Farthest reading put in the grid, and how far a degree with no reading is taken to be clear
+#define GRID_MAX_RANGE_MM 1000
+#define GRID_CLEAR_RANGE_MM 500
+
+// Each cell keeps 4 bits of evidence. Hits add and misses take away, from unknown in the middle.
+#define GRID_EVIDENCE_UNKNOWN 8
+#define GRID_EVIDENCE_MAX 15
+#define GRID_EVIDENCE_HIT 3
+#define GRID_EVIDENCE_MISS 1
+
+// Evidence at or above which a cell is occupied, and at or below which it is free
+#define GRID_OCCUPIED_AT 11
+#define GRID_FREE_AT 5
+
+// What is sent for each cell, 2 bits each
+#define GRID_UNKNOWN 0
+#define GRID_FREE 1
+#define GRID_OCCUPIED 2
+
+// Cell states sent in one delta
+#define GRID_DELTA_CELLS 20
+
+/// Result of adding a sweep to the grid
+typedef struct {
+    int rays;        // Degrees added
+    int changed;     // Cells whose state changed
+    uint32_t cycles; // Clock cycles spent
+} grid_stats_t;
+
+// Statistics of the last sweep added
+extern grid_stats_t grid_stats;
+
+// Sets every cell to unknown and marks nothing to send
+void grid_clear(void);
+
+// Adds the fused readings of every sampled degree of the last sweep, taken at the current odometry pose
+void grid_add_sweep(void);
+
+// Returns the state of the cell at column x and row y, GRID_UNKNOWN outside the grid
+int grid_state(int x, int y);
+
+// Returns the cell index of a point in mm from the starting pose, or -1 outside the grid
+int grid_index(int32_t x_mm, int32_t y_mm);
+
+// Marks every cell that is not unknown to be sent again
+void grid_mark_all(void);
+
+// Sends the cells that changed since the last call and the grid size. Returns the number of deltas sent.
+int grid_send(void);
+
+#endif /* GRID_H_ */
@@ -0,0 +1,127 @@
+/**
+ * @file ir_buffer.c
+ * @brief This file contains the source code for the bookkeeping of the IR samples uDMA copies from the ADC.
+ *
+ * uDMA fills the buffer in ping-pong mode: the primary control structure fills the first half while the
+ * alternate one waits, then they swap. The completion interrupt finds the structures that are done, re-arms
+ * them, and makes the newest half the one ir_buffer_average reads. The control structures are plain memory,
+ * so this has no register accesses and the host simulation in tools can feed it completions.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/9/2018
+ */
+
+#include "ir_buffer.h"
+
+static volatile uint32_t samples[2 * IR_DMA_HALF]; // IR readings written by uDMA, one half at a time
+static volatile uint32_t *structures[2]; // Primary and alternate control structures of the channel
+static volatile int latest_half = 0; // Half of samples that was filled last
+static volatile int next_half = 0; // Half uDMA fills next
+static volatile uint32_t halves = 0; // Number of halves filled since ir_buffer_init
+
+/// Sets up the ping-pong transfer
+/** This method points the primary structure at the end of the first half of the buffer and the alternate
+ * structure at the end of the second half, both reading from the same source, and arms them.
+ * @param primary The primary control structure of the channel.
+ * @param alternate The alternate control structure of the channel.
+ * @param source The register uDMA copies from.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+void ir_buffer_init(volatile uint32_t *primary, volatile uint32_t *alternate, volatile uint32_t *source)
+{
+
+    int half;
+
+    structures[0] = primary;
+    structures[1] = alternate;
+
+    for (half = 0; half < 2; half++) {
+        structures[half][DMA_SRC] = (uint32_t) (uintptr_t) source;
+        structures[half][DMA_DST] = (uint32_t) (uintptr_t) &samples[half * IR_DMA_HALF + IR_DMA_HALF - 1];
+        structures[half][DMA_CTL] = DMA_CTL_PINGPONG;
+    }
+
+    latest_half = 0;
+    next_half = 0;
+    halves = 0;
+
+}
+
+/// Handles a uDMA completion
+/** This method re-arms each structure that has been left in stop mode and marks its half as filled. uDMA fills
+ * the halves in turn, so they are checked starting from the one it was filling: if the interrupt came late and
+ * both are done, the second one checked is the newer. uDMA stops the channel when it swaps to a structure that
+ * is still in stop mode, which is the only way both can be done.
+ * @return 1 if both halves were done and the channel has to be enabled again from the primary structure, 0 otherwise
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+int ir_buffer_complete(void)
+{
+
+    int done = 0;
+
+    while (done < 2 && (structures[next_half][DMA_CTL] & DMA_CTL_MODE_M) == 0) {
+        structures[next_half][DMA_CTL] = DMA_CTL_PINGPONG;
+        latest_half = next_half;
+        next_half = 1 - next_half;
+        halves++;
+        done++;
+    }
+
+    if (done == 2) {
+        next_half = 0;
+        return 1;
+    }
+
+    return 0;
+
+}
+
+/// Returns the average of the latest half
+/** This method averages the most recently filled half of the buffer while uDMA fills the other one.
+ * @return The averaged quantization number
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+unsigned ir_buffer_average(void)
+{
+
+    const volatile uint32_t *half = &samples[latest_half * IR_DMA_HALF];
+    uint32_t sum = 0;
+    int i;
+
+    for (i = 0; i < IR_DMA_HALF; i++) {
+        sum += half[i] & 0xFFF;
+    }
+
+    return sum / IR_DMA_HALF;
+
+}
+
+/// Returns the number of halves filled
+/** @return The number of halves of the buffer filled since ir_buffer_init
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+uint32_t ir_buffer_count(void)
+{
+
+    return halves;
+
+}
+
+/// Returns a half of the buffer
+/** @param half 0 for the half the primary structure fills, 1 for the alternate's.
+ * @return The first sample of the half
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+volatile uint32_t *ir_buffer_half(int half)
+{
+
+    return &samples[half * IR_DMA_HALF];
+
+}
@@ -0,0 +1,47 @@
+/*
+ * ir_buffer.h
+ *
+ *  Created on: May 9, 2018
+ *      Author: mmorth
+ */
+
+#ifndef IR_BUFFER_H_
+#define IR_BUFFER_H_
+
+#include <stdint.h>
+
+// Number of IR samples averaged by adc_latest. uDMA fills a buffer of twice this many.
+#define IR_DMA_HALF 4
+
+// Word offsets within a uDMA channel control structure
+#define DMA_SRC 0
+#define DMA_DST 1
+#define DMA_CTL 2
+
+// Control word: 32 bit words from the fixed FIFO address into an incrementing buffer,
+// one word per request, IR_DMA_HALF words, ping-pong mode
+#define DMA_CTL_PINGPONG ((2u << 30) | (2u << 28) | (3u << 26) | (2u << 24) | ((IR_DMA_HALF - 1) << 4) | 3u)
+
+// Transfer size field of the control word, one less than the words left to transfer
+#define DMA_CTL_XFERSIZE_M (0x3FFu << 4)
+
+// Transfer mode field of the control word. 0 (stop) once the transfer is done.
+#define DMA_CTL_MODE_M 0x7
+
+// Points the primary and alternate control structures of a channel at the two halves of the buffer, reading from source
+void ir_buffer_init(volatile uint32_t *primary, volatile uint32_t *alternate, volatile uint32_t *source);
+
+// Marks the halves whose structures are done as filled and re-arms them. Call from the uDMA completion interrupt.
+// Returns 1 if both were done, which means uDMA stopped the channel and it has to be enabled again from the primary structure.
+int ir_buffer_complete(void);
+
+// Returns the average of the half that was filled last
+unsigned ir_buffer_average(void);
+
+// Returns the number of halves filled since ir_buffer_init
+uint32_t ir_buffer_count(void);
+
+// Returns the first sample of a half of the buffer, 0 for the primary structure's half and 1 for the alternate's
+volatile uint32_t *ir_buffer_half(int half);
+
+#endif /* IR_BUFFER_H_ */
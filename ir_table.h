@@ -0,0 +1,39 @@
+/*
+ * ir_table.h
+ *
+ *  Generated by tools/ir_table_gen.c. Change convert_distance and run it again instead of editing this file.
+ */
+
+#ifndef IR_TABLE_H_
+#define IR_TABLE_H_
+
+/// IR distance in mm for every 16th quantization number, from convert_distance in mm
+/** Entry i is the distance at quantization number 16 * i, rounded. Distances past 65535mm are clamped.
+ * tools/conversion_check.c checks how far ir_to_mm strays from convert_distance.
+ */
+static const uint16_t ir_table_mm[IR_TABLE_SIZE] = {
+    65535, 62268, 26108, 15702, 10947, 8275, 6584, 5426, 4590, 3960, 3469, 3079,
+    2760, 2497, 2275, 2087, 1924, 1784, 1660, 1551, 1455, 1368, 1291, 1221,
+    1157, 1100, 1047, 998, 954, 913, 875, 840, 807, 776, 748, 721,
+    696, 673, 650, 630, 610, 591, 574, 557, 541, 526, 512, 498,
+    485, 473, 461, 450, 439, 429, 419, 409, 400, 391, 383, 375,
+    367, 359, 352, 345, 338, 332, 326, 319, 314, 308, 302, 297,
+    292, 287, 282, 277, 273, 268, 264, 260, 256, 252, 248, 244,
+    241, 237, 234, 230, 227, 224, 221, 218, 215, 212, 209, 206,
+    203, 201, 198, 196, 193, 191, 189, 186, 184, 182, 180, 178,
+    176, 174, 172, 170, 168, 166, 164, 162, 160, 159, 157, 155,
+    154, 152, 151, 149, 148, 146, 145, 143, 142, 140, 139, 138,
+    136, 135, 134, 133, 131, 130, 129, 128, 127, 126, 125, 123,
+    122, 121, 120, 119, 118, 117, 116, 115, 114, 113, 112, 112,
+    111, 110, 109, 108, 107, 106, 106, 105, 104, 103, 102, 102,
+    101, 100, 99, 99, 98, 97, 97, 96, 95, 94, 94, 93,
+    93, 92, 91, 91, 90, 89, 89, 88, 88, 87, 86, 86,
+    85, 85, 84, 84, 83, 83, 82, 82, 81, 81, 80, 80,
+    79, 79, 78, 78, 77, 77, 76, 76, 75, 75, 74, 74,
+    74, 73, 73, 72, 72, 72, 71, 71, 70, 70, 70, 69,
+    69, 68, 68, 68, 67, 67, 67, 66, 66, 66, 65, 65,
+    64, 64, 64, 63, 63, 63, 63, 62, 62, 62, 61, 61,
+    61, 60, 60, 60, 59
+};
+
+#endif /* IR_TABLE_H_ */
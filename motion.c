@@ -0,0 +1,366 @@
+/**
+ * @file motion.c
+ * @brief This file contains the source code for the non-blocking motion primitives.
+ *
+ * A move is started with one of the motion_start functions and then stepped from the millisecond
+ * system tick. Each step takes the newest odometry frame from the Open Interface stream, adds it to
+ * the progress, and stops the wheels once the move is complete or a stop condition is met.
+ * The program is free to sweep, receive commands, and send data while the robot moves, and can end
+ * the move early with motion_cancel.
+ * While a move runs, the tick is the only reader of the stream and owns the frames and the distance and angle
+ * totals. Anything else that reads or stops the stream calls motion_cancel first so no frame is taken from the move.
+ * Drives started with motion_start_profile ramp their speed up and down along a velocity profile (profile.c)
+ * instead of jumping straight to full speed and back to 0.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/3/2018
+ */
+
+#include <stdbool.h>
+#include "Timer.h"
+#include "motion.h"
+#include "profile.h"
+#include "driverlib/interrupt.h"
+
+static oi_t *motion_sensor = 0; // Sensor data the odometry frames are read into
+
+static volatile motion_status_t status = MOTION_IDLE; // State of the move
+static volatile int turning = 0; // 1 for a turn, 0 for a drive
+static volatile int target = 0; // Millimeters or degrees to go
+static volatile int progress = 0; // Millimeters or degrees covered so far
+static volatile int stop_on = 0; // Stop conditions of the drive
+static volatile int tape_threshold = 0; // Cliff signal above which the floor is tape
+static volatile int hazard = 0; // Stop condition that ended the move
+static volatile uint32_t frames = 0; // Odometry frames used by the move
+static volatile uint32_t last_frame_ms = 0; // Tick count when the last frame arrived
+static volatile uint32_t start_ms = 0; // Tick count when the move started
+
+static volatile int profiled = 0; // 1 if the wheel speeds follow a velocity profile
+static profile_t profile; // Velocity profile of the drive
+static int16_t cruise_right = 0; // Right wheel speed at the top of the profile
+static int16_t cruise_left = 0; // Left wheel speed at the top of the profile
+
+/// Lets the system tick step moves
+/** This method registers motion_step with the system tick. Moves need the Roomba to stream odometry,
+ * so the motion preset is streamed if nothing is streaming yet.
+ * If no tick hook is free, moves stay unavailable and the motion_start functions return 0.
+ * @param sensor The Roomba sensor information the frames are read into.
+ * @return 1, or 0 if all TIMER_TICK_HOOKS are taken
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+int motion_init(oi_t *sensor)
+{
+
+    if (!timer_addTickHook(motion_step)) {
+        return 0;
+    }
+
+    motion_sensor = sensor;
+
+    if (!oi_streamActive()) {
+        oi_streamPreset(OI_PRESET_MOTION);
+    }
+
+    return 1;
+
+}
+
+/// Sets the wheels to a speed along the velocity profile
+/** This method scales both cruise wheel speeds by the same amount, so a drive that needs one wheel faster
+ * to go straight keeps the same ratio at every speed.
+ * @param speed The speed of the faster wheel in mm/s.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/4/2018
+ */
+static void motion_set_speed(int speed)
+{
+
+    oi_setWheels(cruise_right * speed / profile.cruise, cruise_left * speed / profile.cruise);
+
+}
+
+/// Starts a move
+/** This method sets up the move and starts the wheels. Frames that arrived before the move are thrown away
+ * so they are not counted. A move that is already running is replaced.
+ * @param turn 1 for a turn, 0 for a drive.
+ * @param distance Millimeters or degrees to go.
+ * @param right_wheel The speed of the right wheel in mm/s.
+ * @param left_wheel The speed of the left wheel in mm/s.
+ * @param stop_conditions The stop conditions of a drive.
+ * @param threshold The cliff signal above which the floor is tape.
+ * @param ramp 1 to speed up and slow down along a velocity profile with the wheel speeds at the top.
+ * @return 1, or 0 if motion_init has not been called.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+static int motion_start(int turn, int distance, int16_t right_wheel, int16_t left_wheel, int stop_conditions, int threshold, int ramp)
+{
+
+    if (motion_sensor == 0) {
+        return 0;
+    }
+
+    // Keep the tick from stepping the move while it is being set up
+    bool masked = IntMasterDisable();
+
+    oi_streamRead(motion_sensor);
+    turning = turn;
+    stop_on = stop_conditions;
+    tape_threshold = threshold;
+    target = distance;
+    progress = 0;
+    hazard = 0;
+    frames = 0;
+    last_frame_ms = timer_getMillis();
+    start_ms = last_frame_ms;
+
+    profiled = ramp;
+    if (ramp) {
+        int right = (right_wheel < 0) ? -right_wheel : right_wheel;
+        int left = (left_wheel < 0) ? -left_wheel : left_wheel;
+        profile_plan(&profile, distance, (right > left) ? right : left, PROFILE_ACCEL, PROFILE_MIN_SPEED);
+        cruise_right = right_wheel;
+        cruise_left = left_wheel;
+        motion_set_speed(profile.min_speed);
+    } else {
+        oi_setWheels(right_wheel, left_wheel);
+    }
+    status = MOTION_RUNNING;
+
+    if (!masked) {
+        IntMasterEnable();
+    }
+
+    return 1;
+
+}
+
+/// Starts a drive
+/** This method starts the wheels and lets the system tick stop them once the robot has gone the distance
+ * or one of the stop conditions is met.
+ * @param millimeters The millimeters to go, negative for backward.
+ * @param right_wheel The speed of the right wheel in mm/s.
+ * @param left_wheel The speed of the left wheel in mm/s.
+ * @param stop_conditions MOTION_STOP_BUMP, MOTION_STOP_CLIFF, and MOTION_STOP_TAPE or'd together, or 0.
+ * @param threshold The cliff signal above which the floor is tape, for MOTION_STOP_TAPE.
+ * @return 1, or 0 if motion_init has not been called.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+int motion_start_drive(int millimeters, int16_t right_wheel, int16_t left_wheel, int stop_conditions, int threshold)
+{
+
+    return motion_start(0, millimeters, right_wheel, left_wheel, stop_conditions, threshold, 0);
+
+}
+
+/// Starts a drive along a velocity profile
+/** This method is motion_start_drive, except that the wheels speed up from PROFILE_MIN_SPEED at PROFILE_ACCEL,
+ * cruise at the given wheel speeds, and slow down to stop on the target. The speed is updated on every odometry frame.
+ * @param millimeters The millimeters to go, negative for backward.
+ * @param right_wheel The cruise speed of the right wheel in mm/s.
+ * @param left_wheel The cruise speed of the left wheel in mm/s.
+ * @param stop_conditions MOTION_STOP_BUMP, MOTION_STOP_CLIFF, and MOTION_STOP_TAPE or'd together, or 0.
+ * @param threshold The cliff signal above which the floor is tape, for MOTION_STOP_TAPE.
+ * @return 1, or 0 if motion_init has not been called.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/4/2018
+ */
+int motion_start_profile(int millimeters, int16_t right_wheel, int16_t left_wheel, int stop_conditions, int threshold)
+{
+
+    return motion_start(0, millimeters, right_wheel, left_wheel, stop_conditions, threshold, 1);
+
+}
+
+/// Starts a turn
+/** This method turns the robot in place and lets the system tick stop it once it has turned the angle.
+ * @param degrees The degrees to turn. A positive degree is a left turn.
+ * @param speed The speed of each wheel in mm/s.
+ * @return 1, or 0 if motion_init has not been called.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+int motion_start_turn(int degrees, int16_t speed)
+{
+
+    if (degrees > 0) {
+        return motion_start(1, degrees, speed, -speed, 0, 0, 0);
+    }
+    return motion_start(1, degrees, -speed, speed, 0, 0, 0);
+
+}
+
+/// Returns the stop condition the latest frame meets
+/** This method checks the bumpers, cliff sensors, and cliff signals against the stop conditions of the drive.
+ * @return The stop condition met, or 0.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+static int motion_check_hazards(void)
+{
+
+    oi_t *sensor = motion_sensor;
+
+    if ((stop_on & MOTION_STOP_BUMP) && (sensor->bumpLeft || sensor->bumpRight)) {
+        return MOTION_STOP_BUMP;
+    }
+    if ((stop_on & MOTION_STOP_CLIFF) && (sensor->cliffLeft || sensor->cliffFrontLeft
+            || sensor->cliffFrontRight || sensor->cliffRight)) {
+        return MOTION_STOP_CLIFF;
+    }
+    if ((stop_on & MOTION_STOP_TAPE) && (sensor->cliffLeftSignal > tape_threshold
+            || sensor->cliffFrontLeftSignal > tape_threshold
+            || sensor->cliffFrontRightSignal > tape_threshold
+            || sensor->cliffRightSignal > tape_threshold)) {
+        return MOTION_STOP_TAPE;
+    }
+    return 0;
+
+}
+
+/// Stops the wheels and ends the move
+/** This method stops the wheels and records why the move ended.
+ * @param result The state the move ended in.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+static void motion_end(motion_status_t result)
+{
+
+    oi_setWheels(0, 0);
+    status = result;
+
+}
+
+/// Advances the move
+/** This method is called from the system tick every millisecond. Once a new odometry frame has arrived,
+ * it checks the stop conditions, adds the frame to the progress, and stops the wheels when the move is complete.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+void motion_step(void)
+{
+
+    if (status != MOTION_RUNNING) {
+        return;
+    }
+
+    if (!oi_streamRead(motion_sensor)) {
+        if (timer_getMillis() - last_frame_ms > MOTION_FRAME_TIMEOUT_MS) {
+            motion_end(MOTION_FAILED);
+        }
+        return;
+    }
+    last_frame_ms = timer_getMillis();
+    frames++;
+
+    // A hazard stops the move before this frame's movement is counted
+    hazard = motion_check_hazards();
+    if (hazard) {
+        motion_end(MOTION_HAZARD);
+        return;
+    }
+
+    progress += turning ? motion_sensor->angle : motion_sensor->distance;
+    if ((target >= 0 && progress >= target) || (target < 0 && progress <= target)) {
+        motion_end(MOTION_DONE);
+        return;
+    }
+
+    // Plan the speed again from the distance left
+    if (profiled) {
+        int speed = profile_speed(&profile, progress, last_frame_ms - start_ms);
+        if (speed > 0) {
+            motion_set_speed(speed);
+        }
+    }
+
+}
+
+/// Returns whether the move has stopped
+/** This method returns 1 once the move has stopped for any reason. See motion_status for the reason.
+ * @return 1 if no move is running, 0 otherwise.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+int motion_is_done(void)
+{
+
+    return status != MOTION_RUNNING;
+
+}
+
+/// Ends the move early
+/** This method stops the wheels if a move is running. The progress made so far is kept.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+void motion_cancel(void)
+{
+
+    bool masked = IntMasterDisable();
+
+    if (status == MOTION_RUNNING) {
+        motion_end(MOTION_CANCELLED);
+    }
+
+    if (!masked) {
+        IntMasterEnable();
+    }
+
+}
+
+/// Returns the state of the move
+/** This method returns whether the move is running, and if not, why it ended.
+ * @return The state of the move.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+motion_status_t motion_status(void)
+{
+
+    return status;
+
+}
+
+/// Returns how far the move has gone
+/** This method returns the millimeters driven or degrees turned since the move started.
+ * @return The progress of the move.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+int motion_progress(void)
+{
+
+    return progress;
+
+}
+
+/// Returns what stopped the move
+/** This method returns the stop condition that ended the move.
+ * @return MOTION_STOP_BUMP, MOTION_STOP_CLIFF, MOTION_STOP_TAPE, or 0 if no stop condition was met.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+int motion_hazard(void)
+{
+
+    return hazard;
+
+}
+
+/// Returns the number of odometry frames used
+/** This method returns the number of frames the move has read, so a caller can tell when the sensor data changed.
+ * @return The frame count of the move.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+uint32_t motion_frames(void)
+{
+
+    return frames;
+
+}
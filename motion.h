@@ -0,0 +1,65 @@
+/*
+ * motion.h
+ *
+ *  Created on: May 3, 2018
+ *      Author: mmorth
+ */
+
+#ifndef MOTION_H_
+#define MOTION_H_
+
+#include <stdint.h>
+#include "open_interface.h"
+
+// Longest a move may go without an odometry frame before the wheels are stopped
+#define MOTION_FRAME_TIMEOUT_MS 100
+
+// Conditions that stop a drive before it has gone the distance
+#define MOTION_STOP_BUMP 0x01  // Either bumper pressed
+#define MOTION_STOP_CLIFF 0x02 // Any cliff sensor triggered
+#define MOTION_STOP_TAPE 0x04  // Any cliff signal above the tape threshold
+
+/// State of the move being run
+typedef enum {
+    MOTION_IDLE,      // Nothing has been started
+    MOTION_RUNNING,   // The wheels are turning
+    MOTION_DONE,      // The move went the whole distance or angle
+    MOTION_HAZARD,    // A stop condition was met
+    MOTION_CANCELLED, // motion_cancel was called
+    MOTION_FAILED     // Odometry frames stopped arriving
+} motion_status_t;
+
+// Lets the system tick step moves, reading odometry frames into sensor. Returns 0 if no tick hook is free.
+int motion_init(oi_t *sensor);
+
+// Starts driving the wheels until the robot has gone millimeters (negative for backward) or a stop condition is met
+int motion_start_drive(int millimeters, int16_t right_wheel, int16_t left_wheel, int stop_on, int tape_threshold);
+
+// Same as motion_start_drive, but speeds up and slows down along a velocity profile topping out at the wheel speeds
+int motion_start_profile(int millimeters, int16_t right_wheel, int16_t left_wheel, int stop_on, int tape_threshold);
+
+// Starts turning in place until the robot has turned degrees (positive turns left)
+int motion_start_turn(int degrees, int16_t speed);
+
+// Advances the move. Called from the system tick.
+void motion_step(void);
+
+// Returns 1 once the move has stopped for any reason
+int motion_is_done(void);
+
+// Stops the wheels and ends the move
+void motion_cancel(void);
+
+// Returns the state of the move
+motion_status_t motion_status(void);
+
+// Returns the millimeters or degrees covered so far
+int motion_progress(void);
+
+// Returns the stop condition that ended the move, or 0
+int motion_hazard(void);
+
+// Returns the number of odometry frames the move has used
+uint32_t motion_frames(void);
+
+#endif /* MOTION_H_ */
@@ -1,266 +1,699 @@
-/**
- * @file movement.c
- * @brief This file contains the source code for the movement of the robot.
- *
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- *
- * @date 4/12/2018
- */
-
-// Include necessary files
-#include "movement.h"
-#include "open_interface.h"
-#include "lcd.h"
-#include"timer.h"
-#include"uart.h"
-#include <string.h>
-
-/// Moves the robot forward a given amount
-/** This method moves the robot forward a given amount without using any sensors to detect objects.
- * @param sensor The Roomba sensor information.
- * @param millimeters The number of millimeters to move the robot forward.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void move_forward(oi_t *sensor, int millimeters) 
-{
-
-    // Have the robot move 50 millimeters forward then stop
-    int sum = 0;
-    oi_setWheels(125, 100); // move forward; full speed
-
-    // Move robot forward
-    while (sum < millimeters) {
-        oi_update(sensor);
-        sum += sensor->distance;
-    }
-
-    // Have the robot stop once it has traveled 1 meter
-    oi_setWheels(0, 0); 
-
-}
-
-/// Turns the robot a given amount
-/** This method turns the robot a specified amount left or right.
- * @param sensor The Roomba sensor information.
- * @param degrees The number of degrees to turn the robot. A positive degree is a right turn. A negative degree is a left turn.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void turn(oi_t *sensor, int degrees) 
-{
-
-    // Have the robot turn the specified degrees
-    int sum = 0;
-    if (degrees > 0) {
-        oi_setWheels(250, -250);
-    } else {
-        oi_setWheels(-250, 250);
-    }
-    if (degrees > 0) {
-        while (sum < degrees) {
-            oi_update(sensor);
-            sum += sensor->angle;
-        }
-    } else {
-        while (sum > degrees - 5) {
-            oi_update(sensor);
-            sum += sensor->angle;
-        }
-    }
-
-    // Have the robot stop once it has turned the specified degree value
-    oi_setWheels(0, 0);
-
-}
-
-/// Moves to avoid the obstacle
-/** This method is called to avoid objects. The robot will backup, turn, then face forward again.
- * @param sensor The Roomba sensor information.
- * @param direction The direction the object was detected.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void avoid_obstacle(oi_t *sensor, int direction) 
-{
-
-    // Move the robot to avoid the obstacle
-    move_backward(sensor, -150);
-    if (direction == 0) {
-        turn(sensor, 90);
-        move_forward(sensor, 250);
-        turn(sensor, -90);
-    } else {
-        turn(sensor, -90);
-        move_forward(sensor, 250);
-        turn(sensor, 90);
-    }
-
-}
-
-/// Moves the robot backward a specified amount
-/** This method moves the robot backward a specified distance in millimeters.
- * @param sensor The Roomba sensor information.
- * @param millimeters The number of millimeters to move the robot backward.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void move_backward(oi_t *sensor, int millimeters) 
-{
-    // Have the robot millimeters backward then stop
-    int sum = 0;
-    oi_setWheels(-110, -100); // move forward; full speed
-
-    // Move robot backward
-    while (sum > millimeters) {
-        oi_update(sensor);
-        sum += sensor->distance;
-    }
-
-    // Have the robot stop once it has traveled 1 meter
-    oi_setWheels(0, 0); // stopoi_free(sensor_data); }
-}
-
-/// Moves the robot forward a given amount
-/** This method moves the robot forward and returns the distance the robot actually moved forward in case it bumped into an object.
- * @param sensor The Roomba sensor information.
- * @param millimeters The number of millimeters to move the robot forward.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-int move_forward_return(oi_t *sensor, int millimeters) 
-{
-
-    // Have the robot move 50 millimeters forward then stop
-    int sum = 0;
-    int bumperHit = 0;
-    oi_setWheels(250, 250); // move forward; full speed
-
-    // Move robot forward
-    while (sum <= millimeters) {
-        oi_update(sensor);
-        sum += sensor->distance;
-        if (sensor->bumpLeft == 1) {
-            avoid_obstacle(sensor, 1);
-            bumperHit = 1;
-            break;
-        } else if (sensor->bumpRight == 1) {
-            avoid_obstacle(sensor, 0);
-            bumperHit = 1;
-            break;
-        }
-    }
-
-    // Have the robot stop
-    oi_setWheels(0, 0); // stopoi_free(sensor_data); }
-
-    // Update distance travelled if object was hit
-    if (bumperHit == 1) {
-        sum -= 150;
-        bumperHit = 0;
-    }
-
-    return sum;
-}
-
-/// Moves the robot forward a given amount and detect the cliff
-/** This method moves the robot forward and returns the distance the robot actually moved forward in case it detected a cliff.
- * @param sensor The Roomba sensor information.
- * @param millimeters The number of millimeters to move the robot forward.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void move_forward_cliff(oi_t *sensor, int millimeters) 
-{
-
-    int sum = 0;
-    oi_setWheels(20, 20); // move forward
-
-    // Move robot forward
-    while (sum < millimeters) {
-        oi_update(sensor);
-        if(sensor->cliffFrontLeft ||sensor->cliffLeft || sensor->cliffFrontRight ||sensor->cliffRight)
-        {
-            move_backward(sensor, -100);
-            break;
-        }
-        sum += sensor->distance;
-    }
-
-    // Stop robot
-    oi_setWheels(0, 0);
-
-}
-
-/// Moves the robot forward a given amount and detect the white tape
-/// Moves the robot forward a given amount
-/** This method moves the robot forward and returns the distance the robot actually moved forward in case it detects the white tape.
- * @param sensor The Roomba sensor information.
- * @param millimeters The number of millimeters to move the robot forward.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void move_forward_color(oi_t *sensor, int millimeters) 
-{
-
-    int sum = 0;
-    oi_setWheels(20, 20); // move forward
-
-    // Move forward
-    while (sum < millimeters) {
-        oi_update(sensor);
-        lcd_printf("%d",sensor->cliffFrontLeftSignal);
-        if(sensor->cliffFrontLeftSignal>2600 ||sensor->cliffLeftSignal>2600  || sensor->cliffFrontRightSignal>2600  ||sensor->cliffRightSignal>2600)
-        {
-            move_backward(sensor, -100);
-            break;
-        }
-        sum += sensor->distance;
-    }
-
-    // Stop robot
-    oi_setWheels(0, 0);
-
-}
-
-/// Moves the robot forward a given distance until an object is detected.
-/** This method moves the robot forward and returns the distance the robot actually moved forward in case it bumped into an object, detects a cliff, or detects the white tape.
- * @param sensor The Roomba sensor information.
- * @param millimeters The number of millimeters to move the robot forward.
- * @return The number of millimeters the robot actuall traveled until it stopped.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-int move_forward_amount(oi_t *sensor, int millimeters) 
-{
-
-    int sum = 0;
-    oi_setWheels(110, 100); // move forward
-//        uart_sendStr("Cliff: Left FrontLeft FrontRight Right\n\r");
-    uart_sendStr("LBump LCliff LCliffS FLCliff FLCliffS FRCliff FRCliffS RCliff RCliffS RBump \n\r");
-    // Move forward
-    while (sum < millimeters) {
-        oi_update(sensor);
-           char message[100];
-           sprintf(message, "%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n\r",
-                   sensor->bumpLeft, sensor->cliffLeft,
-                   sensor->cliffLeftSignal, sensor->cliffFrontLeft,
-                   sensor->cliffFrontLeftSignal, sensor->cliffFrontRight,
-                   sensor->cliffFrontRightSignal, sensor->cliffRight,
-                   sensor->cliffRightSignal, sensor->bumpRight);
-           uart_sendStr(message);
-
-        // Detect sensors
-        if(sensor->cliffFrontLeftSignal>2700 ||sensor->cliffLeftSignal>2700  || sensor->cliffFrontRightSignal>2700  ||sensor->cliffRightSignal>2700||sensor->cliffFrontLeft ||sensor->cliffLeft || sensor->cliffFrontRight ||sensor->cliffRight||sensor->bumpLeft||sensor->bumpRight)
-        {
-            move_backward(sensor, -100);
-            return sum-100;
-        }
-        sum += sensor->distance;
-    }
-
-    // Stop the robot
-    oi_setWheels(0, 0);
-    return sum;
-
-}
+/**
+ * @file movement.c
+ * @brief This file contains the source code for the movement of the robot.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/12/2018
+ */
+
+// Include necessary files
+#include "movement.h"
+#include "motion.h"
+#include "open_interface.h"
+#include "lcd.h"
+#include"timer.h"
+#include"uart.h"
+#include "sched.h"
+#include <string.h>
+#include "driverlib/sysctl.h"
+
+move_mode_t move_mode = MOVE_POLL;
+move_report_t move_report;
+int move_distance;
+
+/// How move_task starts a move
+typedef struct {
+    int turning;            // 1 to turn, 0 to drive
+    int profiled;           // 1 to drive along the velocity profile, 0 to drive at the wheel speeds the whole way
+    int16_t right_wheel;    // Right wheel speed in mm/s, or the turn speed
+    int16_t left_wheel;     // Left wheel speed in mm/s
+    int stop_on;            // MOTION_STOP_* conditions, 0 for a move that may run as a script
+    int tape_threshold;     // Cliff signal that counts as the tape
+} move_kind_t;
+
+static const move_kind_t move_ahead = { 0, 1, 125, 100, 0, 0 };
+static const move_kind_t move_back = { 0, 1, -110, -100, 0, 0 };
+static const move_kind_t move_turn = { 1, 0, 250, 0, 0, 0 };
+static const move_kind_t move_to_bump = { 0, 1, 250, 250, MOTION_STOP_BUMP, 0 };
+static const move_kind_t move_to_cliff = { 0, 0, 20, 20, MOTION_STOP_CLIFF, 0 };
+static const move_kind_t move_to_tape = { 0, 0, 20, 20, MOTION_STOP_TAPE, 2600 };
+static const move_kind_t move_to_hazard = { 0, 1, 110, 100, MOTION_STOP_BUMP | MOTION_STOP_CLIFF | MOTION_STOP_TAPE, 2700 };
+
+/// What move_task is doing
+typedef enum {
+    MOVE_IDLE,      // No move is running
+    MOVE_SCRIPTING, // The Roomba is running a script
+    MOVE_STEPPING,  // The system tick is stepping the move
+    MOVE_SETTLING,  // The wheels are coming to rest
+    MOVE_MEASURING  // Reading how far the wheels went after the stop
+} move_phase_t;
+
+/// State of the move being run
+static int move_scheduled = 0;
+static move_phase_t move_phase = MOVE_IDLE;
+static oi_t *move_sensor;
+static const move_kind_t *move_kind;
+static int move_requested;
+static int move_sum;
+static uint32_t move_start_ms;
+static uint32_t move_duration_ms;
+static uint32_t move_frames;
+static motion_status_t move_status;
+static void (*move_each)(oi_t *sensor);
+static void (*move_done)(void);
+static int move_querying;
+
+/// State of the script move being run
+static int script_active = 0;
+static int script_turning;
+static int script_target;
+static int script_sum;
+static int script_moving;
+static uint32_t script_start_ms;
+static uint32_t script_busy_cycles;
+
+/// State of the moves made of several moves
+static void (*move_then)(void);
+static int avoid_direction;
+static int avoid_step;
+
+/// Takes the odometry without waiting on the Roomba
+/** This method reads a stream frame, or keeps one odometry query going while the Roomba is not streaming.
+ * @param sensor The Roomba sensor information.
+ * @return 1 if the distance and angle were read, 0 while waiting, or -1 if the query failed
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static int move_read(oi_t *sensor)
+{
+
+    if (oi_streamActive()) {
+        return oi_streamRead(sensor);
+    }
+
+    if (!move_querying) {
+        move_querying = oi_queryStartPreset(OI_PRESET_ODOMETRY) > 0;
+    }
+    int bytes = oi_queryPoll(sensor);
+    if (bytes != 0) {
+        move_querying = 0;
+    }
+
+    return (bytes > 0) ? 1 : bytes;
+
+}
+
+/// Lets move_task run the moves
+/** This method registers move_task with the scheduler once. Call after sched_init.
+ * @return 1, or 0 if all SCHED_MAX_TASKS entries are taken and moves cannot be started
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+int move_init(void)
+{
+
+    move_scheduled = sched_every("move", move_task, MOVE_POLL_MS) >= 0;
+    return move_scheduled;
+
+}
+
+/// Starts the system tick on the part of the move a script did not do
+/** This method starts the motion for what is left of the move and has move_task wait for it.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static void move_step(void)
+{
+
+    int left = move_requested - move_sum;
+
+    move_start_ms = timer_getMillis();
+    move_frames = motion_frames();
+
+    if (move_kind->turning) {
+        motion_start_turn(left, move_kind->right_wheel);
+    } else if (move_kind->profiled) {
+        motion_start_profile(left, move_kind->right_wheel, move_kind->left_wheel, move_kind->stop_on, move_kind->tape_threshold);
+    } else {
+        motion_start_drive(left, move_kind->right_wheel, move_kind->left_wheel, move_kind->stop_on, move_kind->tape_threshold);
+    }
+
+    move_phase = MOVE_STEPPING;
+
+}
+
+/// Starts a move run by move_task
+/** This method starts the wheels and returns. move_task stops them, fills in move_report, and then calls done.
+ * Plain moves are run as a script when move_mode is MOVE_SCRIPT.
+ * @param sensor The Roomba sensor information.
+ * @param kind How to move.
+ * @param amount The millimeters to move, negative for backward, or the degrees to turn, positive for left.
+ * @param each The function to call after each odometry frame, or 0 for none.
+ * @param done The function to call once the move is over, or 0 for none.
+ * @return 1, or 0 if a move is already running or move_init failed
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static int move_begin(oi_t *sensor, const move_kind_t *kind, int amount, void (*each)(oi_t *sensor), void (*done)(void))
+{
+
+    if (!move_scheduled || move_phase != MOVE_IDLE) {
+        return 0;
+    }
+
+    move_sensor = sensor;
+    move_kind = kind;
+    move_requested = amount;
+    move_sum = 0;
+    move_each = each;
+    move_done = done;
+    move_status = MOTION_DONE;
+
+    if (kind->stop_on == 0 && move_mode == MOVE_SCRIPT
+            && move_scriptStart(sensor, kind->turning ? 0 : amount, kind->turning ? amount : 0)) {
+        move_phase = MOVE_SCRIPTING;
+        return 1;
+    }
+
+    // Have the system tick stop the wheels
+    move_step();
+    return 1;
+
+}
+
+/// Ends the move and calls its done function
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static void move_end(void)
+{
+
+    void (*done)(void) = move_done;
+
+    // The done function may start the next move
+    move_phase = MOVE_IDLE;
+    move_done = 0;
+    if (done) {
+        done();
+    }
+
+}
+
+/// Runs the move started by move_forward, move_backward, turn, or the others
+/** This method is the periodic move task. It checks on the script or the move the system tick is stepping,
+ * lets the wheels come to rest, and reads how far they went after the stop, without waiting for any of it.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+void move_task(void)
+{
+
+    int result;
+
+    switch (move_phase) {
+    case MOVE_IDLE:
+        break;
+
+    case MOVE_SCRIPTING:
+        result = move_scriptPoll(move_sensor);
+        if (result > 0) {
+            move_end();
+        } else if (result < 0) {
+            // The Roomba could not run the script, so finish the move from here
+            move_sum = move_report.moved;
+            move_step();
+        }
+        break;
+
+    case MOVE_STEPPING:
+        if (move_each && motion_frames() != move_frames) {
+            move_frames = motion_frames();
+            move_each(move_sensor);
+        }
+        if (!motion_is_done()) {
+            break;
+        }
+
+        // The stream is read here from now on, so the tick must not be reading it for a move
+        move_status = motion_status();
+        move_sum += motion_progress();
+        move_duration_ms = timer_getMillis() - move_start_ms;
+        motion_cancel();
+        move_start_ms = timer_getMillis();
+        move_querying = 0;
+        move_phase = MOVE_SETTLING;
+        break;
+
+    case MOVE_SETTLING:
+        if (timer_getMillis() - move_start_ms < MOVE_SETTLE_MS) {
+            break;
+        }
+
+        move_phase = MOVE_MEASURING;
+        break;
+
+    case MOVE_MEASURING:
+        // Count what the robot did after being told to stop
+        result = move_read(move_sensor);
+        if (result == 0) {
+            break;
+        }
+        if (result > 0) {
+            move_sum += move_kind->turning ? move_sensor->angle : move_sensor->distance;
+        }
+
+        // Nothing else could be done while the wheels were stepped from here
+        move_report.requested = move_requested;
+        move_report.moved = move_sum;
+        move_report.duration_ms = move_duration_ms;
+        move_report.busy_us = move_duration_ms * 1000;
+        move_report.scripted = 0;
+        move_end();
+        break;
+    }
+
+}
+
+/// Returns whether a move is running
+/** @return 1 from the start of a move until its done function is called, 0 otherwise
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+int move_busy(void)
+{
+
+    return move_phase != MOVE_IDLE;
+
+}
+
+/// Stops the wheels and the move being run
+/** This method stops the move without calling its done function, along with the rest of a move made of several moves.
+ * The Roomba does not take commands while it waits in a script, so a script move goes on until the script ends.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+void move_stop(void)
+{
+
+    motion_cancel();
+    oi_setWheels(0, 0);
+
+    script_active = 0;
+    move_querying = 0;
+    move_phase = MOVE_IDLE;
+    move_done = 0;
+    move_then = 0;
+
+}
+
+/// Starts a move the Roomba stops itself
+/** This method sends a script that drives the wheels, waits on the Roomba until it has gone the distance or turned the angle, and stops them.
+ * Call move_scriptPoll until it is done, or let move_task do it. The robot is free to do other things in between.
+ * @param sensor The Roomba sensor information.
+ * @param millimeters The millimeters to move, negative for backward. Ignored if degrees is not 0.
+ * @param degrees The degrees to turn. A positive degree is a left turn.
+ * @return 1, or 0 if the script could not be sent.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/2/2018
+ */
+int move_scriptStart(oi_t *sensor, int millimeters, int degrees)
+{
+
+    // The script move reads the stream itself, so stop a move the tick is running and reading it for
+    motion_cancel();
+
+    // Clear the Roomba's distance and angle so only this move is counted
+    oi_updatePreset(sensor, OI_PRESET_ODOMETRY);
+
+    int sent;
+    if (degrees != 0) {
+        sent = (degrees > 0) ? oi_scriptAngle(250, -250, degrees) : oi_scriptAngle(-250, 250, degrees);
+    } else if (millimeters > 0) {
+        sent = oi_scriptDistance(125, 100, millimeters);
+    } else {
+        sent = oi_scriptDistance(-110, -100, millimeters);
+    }
+    if (!sent) {
+        return 0;
+    }
+
+    script_active = 1;
+    script_turning = (degrees != 0);
+    script_target = script_turning ? degrees : millimeters;
+    script_sum = 0;
+    move_querying = 0;
+    script_moving = 0;
+    script_busy_cycles = 0;
+    script_start_ms = timer_getMillis();
+
+    return 1;
+
+}
+
+/// Checks on a script move
+/** This method reads the odometry without waiting on the Roomba. While the script waits, the Roomba does not answer,
+ * so the move is done once readings come back again with the wheels no longer turning.
+ * A Roomba without scripts (Create 2) runs the opcodes as ordinary commands and stops straight away, which shows up as a short move.
+ * @param sensor The Roomba sensor information.
+ * @return 1 once done, 0 while moving, or -1 if the Roomba did not run the script or it timed out. The wheels are stopped either way.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/2/2018
+ */
+int move_scriptPoll(oi_t *sensor)
+{
+
+    uint32_t start = timer_getCycles();
+    int result = 0;
+
+    if (!script_active) {
+        return 1;
+    }
+
+    // Take a stream frame, or keep one odometry query going
+    int fresh = move_read(sensor) > 0;
+
+    uint32_t elapsed = timer_getMillis() - script_start_ms;
+    if (fresh) {
+        int delta = script_turning ? sensor->angle : sensor->distance;
+        script_sum += delta;
+        if (delta != 0) {
+            script_moving = 1;
+        } else if (script_moving) {
+            // The wheels turned and have stopped, so the script is over
+            result = 1;
+        } else if (elapsed > MOVE_SCRIPT_START_MS) {
+            result = -1;
+        }
+    }
+    if (result == 0 && elapsed > MOVE_SCRIPT_TIMEOUT_MS) {
+        result = -1;
+    }
+
+    // A Roomba without scripts ran the drive and stop opcodes one after the other
+    int target = (script_target < 0) ? -script_target : script_target;
+    int sum = (script_sum < 0) ? -script_sum : script_sum;
+    if (result == 1 && sum < target / 2) {
+        result = -1;
+    }
+
+    script_busy_cycles += timer_cyclesSince(start);
+
+    if (result != 0) {
+        if (result < 0) {
+            oi_setWheels(0, 0);
+        }
+        script_active = 0;
+
+        move_report.requested = script_target;
+        move_report.moved = script_sum;
+        move_report.duration_ms = elapsed;
+        move_report.busy_us = script_busy_cycles / (SysCtlClockGet() / 1000000);
+        move_report.scripted = (result > 0);
+    }
+
+    return result;
+
+}
+
+/// Calls the done function of a move made of several moves
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static void move_finish(void)
+{
+
+    void (*then)(void) = move_then;
+
+    move_then = 0;
+    if (then) {
+        then();
+    }
+
+}
+
+/// Backs up after a hazard stopped the move
+/** This method is called once a move that stops for hazards is over. It sets move_distance, and backs up 100 millimeters
+ * if a hazard stopped the move.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static void move_back_off(void)
+{
+
+    move_distance = move_report.moved;
+
+    if (move_status == MOTION_HAZARD) {
+        move_distance -= 100;
+        move_begin(move_sensor, &move_back, -100, 0, move_finish);
+        return;
+    }
+
+    move_finish();
+
+}
+
+/// Moves the robot forward a given amount
+/** This method starts moving the robot forward a given amount without using any sensors to detect objects, and returns.
+ * @param sensor The Roomba sensor information.
+ * @param millimeters The number of millimeters to move the robot forward.
+ * @param done The function to call once move_report is filled in, or 0 for none.
+ * @return 1, or 0 if a move is already running
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int move_forward(oi_t *sensor, int millimeters, void (*done)(void)) 
+{
+
+    return move_begin(sensor, &move_ahead, millimeters, 0, done);
+
+}
+
+/// Turns the robot a given amount
+/** This method starts turning the robot a specified amount left or right, and returns.
+ * @param sensor The Roomba sensor information.
+ * @param degrees The number of degrees to turn the robot. A positive degree is a left (counterclockwise) turn. A negative degree is a right turn.
+ * @param done The function to call once move_report is filled in, or 0 for none.
+ * @return 1, or 0 if a move is already running
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int turn(oi_t *sensor, int degrees, void (*done)(void)) 
+{
+
+    return move_begin(sensor, &move_turn, degrees, 0, done);
+
+}
+
+/// Makes the next move of avoid_obstacle
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static void avoid_next(void)
+{
+
+    // Back up, turn away from the object, go past it, and face forward again
+    int away = (avoid_direction == 0) ? 90 : -90;
+
+    avoid_step++;
+    switch (avoid_step) {
+    case 1:
+        move_begin(move_sensor, &move_back, -150, 0, avoid_next);
+        break;
+    case 2:
+        move_begin(move_sensor, &move_turn, away, 0, avoid_next);
+        break;
+    case 3:
+        move_begin(move_sensor, &move_ahead, 250, 0, avoid_next);
+        break;
+    case 4:
+        move_begin(move_sensor, &move_turn, -away, 0, avoid_next);
+        break;
+    default:
+        move_finish();
+        break;
+    }
+
+}
+
+/// Moves to avoid the obstacle
+/** This method is called to avoid objects. The robot will backup, turn, then face forward again.
+ * It starts the first move and returns. The others follow from move_task.
+ * @param sensor The Roomba sensor information.
+ * @param direction The direction the object was detected.
+ * @param done The function to call once the robot faces forward again, or 0 for none.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void avoid_obstacle(oi_t *sensor, int direction, void (*done)(void)) 
+{
+
+    // Move the robot to avoid the obstacle
+    move_sensor = sensor;
+    move_then = done;
+    avoid_direction = direction;
+    avoid_step = 0;
+    avoid_next();
+
+}
+
+/// Moves the robot backward a specified amount
+/** This method starts moving the robot backward a specified distance in millimeters, and returns.
+ * @param sensor The Roomba sensor information.
+ * @param millimeters The number of millimeters to move the robot backward.
+ * @param done The function to call once move_report is filled in, or 0 for none.
+ * @return 1, or 0 if a move is already running
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int move_backward(oi_t *sensor, int millimeters, void (*done)(void)) 
+{
+
+    return move_begin(sensor, &move_back, millimeters, 0, done);
+
+}
+
+/// Goes around the object a bumper hit
+/** This method is called once the move of move_forward_return is over. It sets move_distance, and avoids the object
+ * if a bumper was hit.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+static void move_bumped(void)
+{
+
+    move_distance = move_report.moved;
+
+    // Update distance travelled if object was hit
+    if (move_status == MOTION_HAZARD) {
+        move_distance -= 150;
+        avoid_obstacle(move_sensor, move_sensor->bumpLeft ? 1 : 0, move_then);
+        return;
+    }
+
+    move_finish();
+
+}
+
+/// Moves the robot forward a given amount
+/** This method starts moving the robot forward until it goes the distance or bumps into an object, and returns.
+ * After a bump the robot goes around the object with avoid_obstacle.
+ * @param sensor The Roomba sensor information.
+ * @param millimeters The number of millimeters to move the robot forward.
+ * @param done The function to call once move_distance holds the distance the robot actually moved forward, or 0 for none.
+ * @return 1, or 0 if a move is already running
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int move_forward_return(oi_t *sensor, int millimeters, void (*done)(void)) 
+{
+
+    // Move robot forward until it goes the distance or a bumper is hit
+    if (!move_begin(sensor, &move_to_bump, millimeters, 0, move_bumped)) {
+        return 0;
+    }
+    move_then = done;
+    return 1;
+
+}
+
+/// Moves the robot forward a given amount and detect the cliff
+/** This method starts moving the robot forward, backing up if it detects a cliff, and returns.
+ * @param sensor The Roomba sensor information.
+ * @param millimeters The number of millimeters to move the robot forward.
+ * @param done The function to call once move_distance holds the distance the robot actually moved forward, or 0 for none.
+ * @return 1, or 0 if a move is already running
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int move_forward_cliff(oi_t *sensor, int millimeters, void (*done)(void)) 
+{
+
+    // Move robot forward until it goes the distance or a cliff is found
+    if (!move_begin(sensor, &move_to_cliff, millimeters, 0, move_back_off)) {
+        return 0;
+    }
+    move_then = done;
+    return 1;
+
+}
+
+/// Shows the front left cliff signal
+/** This method prints the front left cliff signal on the LCD while looking for the white tape.
+ * @param sensor The Roomba sensor information.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+static void print_cliff_signal(oi_t *sensor)
+{
+
+    lcd_printf("%d",sensor->cliffFrontLeftSignal);
+
+}
+
+/// Sends the bump and cliff sensors
+/** This method sends one row of bumper, cliff, and cliff signal readings for the table started by move_forward_amount.
+ * @param sensor The Roomba sensor information.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/3/2018
+ */
+static void send_hazard_sensors(oi_t *sensor)
+{
+
+    char message[100];
+    sprintf(message, "%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n\r",
+            sensor->bumpLeft, sensor->cliffLeft,
+            sensor->cliffLeftSignal, sensor->cliffFrontLeft,
+            sensor->cliffFrontLeftSignal, sensor->cliffFrontRight,
+            sensor->cliffFrontRightSignal, sensor->cliffRight,
+            sensor->cliffRightSignal, sensor->bumpRight);
+    uart_sendStr(message);
+
+}
+
+/// Moves the robot forward a given amount and detect the white tape
+/** This method starts moving the robot forward, backing up if it detects the white tape, and returns.
+ * @param sensor The Roomba sensor information.
+ * @param millimeters The number of millimeters to move the robot forward.
+ * @param done The function to call once move_distance holds the distance the robot actually moved forward, or 0 for none.
+ * @return 1, or 0 if a move is already running
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int move_forward_color(oi_t *sensor, int millimeters, void (*done)(void)) 
+{
+
+    // Move forward until it goes the distance or the tape is found
+    if (!move_begin(sensor, &move_to_tape, millimeters, print_cliff_signal, move_back_off)) {
+        return 0;
+    }
+    move_then = done;
+    return 1;
+
+}
+
+/// Moves the robot forward a given distance until an object is detected.
+/** This method starts moving the robot forward and returns. It stops if it bumps into an object, detects a cliff, or detects the white tape,
+ * and then backs up. The bump and cliff sensors are sent after every odometry frame.
+ * @param sensor The Roomba sensor information.
+ * @param millimeters The number of millimeters to move the robot forward.
+ * @param done The function to call once move_distance holds the number of millimeters the robot actually traveled, or 0 for none.
+ * @return 1, or 0 if a move is already running
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int move_forward_amount(oi_t *sensor, int millimeters, void (*done)(void)) 
+{
+
+    // Move forward until it goes the distance, a bumper is hit, or a cliff or the tape is found
+    if (!move_begin(sensor, &move_to_hazard, millimeters, send_hazard_sensors, move_back_off)) {
+        return 0;
+    }
+    move_then = done;
+
+//        uart_sendStr("Cliff: Left FrontLeft FrontRight Right\n\r");
+    uart_sendStr("LBump LCliff LCliffS FLCliff FLCliffS FRCliff FRCliffS RCliff RCliffS RBump \n\r");
+
+    return 1;
+
+}
@@ -1,28 +1,85 @@
-/*
- * movement.h
- *
- *  Created on: Jan 22, 2018
- *      Author: mmorth
- */
-
-#ifndef MOVEMENT_H_
-#define MOVEMENT_H_
-
-#include "open_interface.h"
-
-// Moves the robot forward a specified amount
-void move_forward(oi_t *sensor, int centimeters);
-
-// Moves the robot forward until it hits an object, then it returns the distance traveled
-int move_forward_return(oi_t *sensor, int centimeters);
-
-// Turns the robot a specified amount
-void turn(oi_t *sensor, int degrees);
-
-// Moves the robot backward a specified amount
-void move_backward(oi_t *sensor, int centimeters);
-
-// Move the robot forward a specified amount
-int move_forward_amount(oi_t *sensor, int millimeters);
-
-#endif /* MOVEMENT_H_ */
+/*
+ * movement.h
+ *
+ *  Created on: Jan 22, 2018
+ *      Author: mmorth
+ */
+
+#ifndef MOVEMENT_H_
+#define MOVEMENT_H_
+
+#include "open_interface.h"
+
+// Time to let the wheels come to rest before measuring how far a move went
+#define MOVE_SETTLE_MS 50
+
+// Time between checks by move_task on the move being run
+#define MOVE_POLL_MS 10
+
+// Time a script move may take before the wheels are stopped from here
+#define MOVE_SCRIPT_TIMEOUT_MS 10000
+
+// Time a script move may go without the wheels turning before it is given up on
+#define MOVE_SCRIPT_START_MS 500
+
+// How move_forward, move_backward and turn stop the wheels
+typedef enum {
+    MOVE_POLL,  // Poll the odometry and stop the wheels from here
+    MOVE_SCRIPT // Run a script that lets the Roomba stop them itself. Falls back to MOVE_POLL without script support.
+} move_mode_t;
+
+// How the last move_forward, move_backward or turn went
+typedef struct {
+    int requested;        // Millimeters or degrees asked for
+    int moved;            // Millimeters or degrees measured once the wheels stopped
+    uint32_t duration_ms; // Time from starting the wheels to knowing they stopped
+    uint32_t busy_us;     // Time spent on the move that could not be spent on anything else
+    int scripted;         // 1 if a script stopped the wheels
+} move_report_t;
+
+// How moves are stopped, MOVE_POLL unless changed
+extern move_mode_t move_mode;
+
+// How the last move went
+extern move_report_t move_report;
+
+// Starts a move the Roomba stops itself. Give millimeters, or degrees to turn.
+int move_scriptStart(oi_t *sensor, int millimeters, int degrees);
+
+// Checks on a script move. Returns 1 once done, 0 while moving, -1 if the Roomba did not run it.
+int move_scriptPoll(oi_t *sensor);
+
+// Distance the last move_forward_return, move_forward_cliff, move_forward_color or move_forward_amount went
+extern int move_distance;
+
+// Lets move_task run the moves. Call after sched_init. Returns 0 if no task is free.
+int move_init(void);
+
+// Runs the move being made, called by the scheduler every MOVE_POLL_MS
+void move_task(void);
+
+// Returns 1 while a move is running
+int move_busy(void);
+
+// Stops the wheels and the move being run, without calling its done function
+void move_stop(void);
+
+// The moves below start the wheels and return. Each calls done, unless it is 0, once the move is over.
+// They return 0 without moving if a move is already running.
+
+// Moves the robot forward a specified amount
+int move_forward(oi_t *sensor, int millimeters, void (*done)(void));
+
+// Moves the robot forward until it hits an object and goes around it. Sets move_distance.
+int move_forward_return(oi_t *sensor, int millimeters, void (*done)(void));
+
+// Turns the robot a specified amount
+int turn(oi_t *sensor, int degrees, void (*done)(void));
+
+// Moves the robot backward a specified amount
+int move_backward(oi_t *sensor, int millimeters, void (*done)(void));
+
+// Move the robot forward a specified amount, backing up from a bump, cliff, or the tape. Sets move_distance.
+int move_forward_amount(oi_t *sensor, int millimeters, void (*done)(void));
+
+#endif /* MOVEMENT_H_ */
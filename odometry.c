@@ -0,0 +1,242 @@
+/**
+ * @file odometry.c
+ * @brief This file contains the source code for the wheel encoder odometry.
+ *
+ * The pose (x, y, heading) is worked out from the change in the raw wheel encoder counts on every update.
+ * Positions are kept in 1/65536 mm and the heading as a binary angle, where 2^32 is a whole turn, so it wraps
+ * around by itself and no turn is ever rounded away. The encoder counts are 16 bits and wrap around too,
+ * so each change is taken as a signed 16 bit difference.
+ * Everything is integer math with no hardware dependencies, so the replay tool in tools can run it on the host.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/5/2018
+ */
+
+#include "odometry.h"
+
+/// Sine from 0 to 90 degrees in 256 steps, in 1/32768
+static const uint16_t sine_table[257] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210, 2411, 2611, 2811, 3012,
+    3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609, 4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195,
+    6393, 6590, 6787, 6983, 7180, 7376, 7571, 7767, 7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+    9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605, 11793, 11980, 12167, 12354,
+    12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828, 14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+    15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673, 16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001, 20160, 20318, 20475, 20632,
+    20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856, 22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028,
+    23170, 23312, 23453, 23593, 23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199, 26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+    27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002, 28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803,
+    28899, 28993, 29086, 29178, 29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784, 30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298,
+    31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737, 31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099,
+    32138, 32177, 32214, 32251, 32286, 32319, 32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+    32768
+};
+
+static odometry_pose_t pose; // Where the robot is
+static volatile uint32_t pose_version = 0; // Odd while the pose is being changed
+
+static int started = 0; // 0 until the first encoder counts have been seen
+static uint16_t last_left = 0; // Left encoder count of the last update
+static uint16_t last_right = 0; // Right encoder count of the last update
+static uint32_t last_ms = 0; // Time of the last update
+static uint32_t reported_heading = 0; // Heading up to which odometry_take_degrees has reported
+
+static int speed = 0; // Speed in mm/s over the last update
+static int turn_rate = 0; // Turn rate in tenths of a degree per second over the last update
+
+/// Returns the sine of a binary angle
+/** This method looks the angle up in the quarter wave table, mirrored for the other quarters, and interpolates between steps.
+ * @param angle The angle, 2^32 per turn.
+ * @return The sine in 1/32768.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+int32_t odometry_sin(uint32_t angle)
+{
+
+    uint32_t quarter = angle >> 30;
+    uint32_t position = angle & 0x3FFFFFFF;
+
+    // The second and fourth quarters run back down the table
+    if (quarter & 1) {
+        position = 0x40000000 - position;
+    }
+
+    uint32_t index = position >> 22;
+    int32_t value;
+    if (index >= 256) {
+        value = sine_table[256];
+    } else {
+        int32_t low = sine_table[index];
+        int32_t high = sine_table[index + 1];
+        value = low + (((high - low) * (int32_t) ((position >> 6) & 0xFFFF)) >> 16);
+    }
+
+    return (quarter & 2) ? -value : value;
+
+}
+
+/// Returns the cosine of a binary angle
+/** This method returns the sine a quarter turn further on.
+ * @param angle The angle, 2^32 per turn.
+ * @return The cosine in 1/32768.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+int32_t odometry_cos(uint32_t angle)
+{
+
+    return odometry_sin(angle + 0x40000000);
+
+}
+
+/// Starts the pose over
+/** This method sets the pose to 0. The next encoder counts are taken as the starting point instead of a move.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void odometry_reset(void)
+{
+
+    pose_version++;
+    pose.x = 0;
+    pose.y = 0;
+    pose.heading = 0;
+    reported_heading = 0;
+    started = 0;
+    speed = 0;
+    turn_rate = 0;
+    pose_version++;
+
+}
+
+/// Sets the pose
+/** This method moves the pose to a known place, such as a position worked out from landmarks.
+ * @param new_pose The pose to use from now on.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void odometry_set_pose(const odometry_pose_t *new_pose)
+{
+
+    pose_version++;
+    reported_heading += new_pose->heading - pose.heading;
+    pose = *new_pose;
+    pose_version++;
+
+}
+
+/// Moves the pose by the change in the encoder counts
+/** This method takes the distance each wheel went since the last update, turns the heading by their difference,
+ * and moves the position by their average along the heading halfway through the turn.
+ * @param left_count The raw left encoder count.
+ * @param right_count The raw right encoder count.
+ * @param now_ms The time of the counts in milliseconds, for the velocity.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void odometry_update(uint16_t left_count, uint16_t right_count, uint32_t now_ms)
+{
+
+    if (!started) {
+        last_left = left_count;
+        last_right = right_count;
+        last_ms = now_ms;
+        started = 1;
+        return;
+    }
+
+    // A signed 16 bit difference is right across the wrap from 65535 to 0
+    int32_t left = (int16_t) (uint16_t) (left_count - last_left);
+    int32_t right = (int16_t) (uint16_t) (right_count - last_right);
+    last_left = left_count;
+    last_right = right_count;
+
+    int32_t distance = (int32_t) (((int64_t) (left + right) * ODOMETRY_MM_PER_COUNT) / 2);
+    uint32_t turn = (uint32_t) ((int64_t) (right - left) * ODOMETRY_ANGLE_PER_COUNT);
+    uint32_t middle = pose.heading + (uint32_t) ((int32_t) turn / 2);
+
+    pose_version++;
+    pose.x += (int32_t) (((int64_t) distance * odometry_cos(middle)) >> 15);
+    pose.y += (int32_t) (((int64_t) distance * odometry_sin(middle)) >> 15);
+    pose.heading += turn;
+    pose_version++;
+
+    uint32_t elapsed = now_ms - last_ms;
+    last_ms = now_ms;
+    if (elapsed > 0) {
+        speed = (int32_t) (((int64_t) distance * 1000 / (int32_t) elapsed) >> ODOMETRY_SHIFT);
+        turn_rate = (int32_t) ((int64_t) (int32_t) turn * 3600 * 1000 / (int32_t) elapsed >> 32);
+    }
+
+}
+
+/// Copies the pose
+/** This method copies the pose, trying again if an update changed it part way through.
+ * @param copy Set to the pose.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void odometry_get(odometry_pose_t *copy)
+{
+
+    uint32_t version;
+
+    do {
+        version = pose_version;
+        *copy = pose;
+    } while ((version & 1) || version != pose_version);
+
+}
+
+/// Returns a heading in tenths of a degree
+/** This method converts a binary angle to tenths of a degree, rounded, from -1800 to 1799.
+ * @param heading The binary angle.
+ * @return The heading in tenths of a degree.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+int odometry_heading_tenths(uint32_t heading)
+{
+
+    int tenths = (int) (((int64_t) (int32_t) heading * 3600 + (1LL << 31)) >> 32);
+    return (tenths >= 1800) ? tenths - 3600 : tenths;
+
+}
+
+/// Returns the whole degrees turned since the last call
+/** This method reports the turn in whole degrees like the Roomba's angle packet, but keeps the part of a degree
+ * left over for the next call, so small turns add up instead of rounding to 0.
+ * @return The whole degrees turned, positive counterclockwise.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+int odometry_take_degrees(void)
+{
+
+    int32_t turned = (int32_t) (pose.heading - reported_heading);
+    int degrees = (int) (((int64_t) turned * 360) / 4294967296LL);
+
+    reported_heading += ODOMETRY_ANGLE_DEGREES(degrees);
+    return degrees;
+
+}
+
+/// Gets the velocity
+/** This method returns the speed and turn rate over the last update.
+ * @param mm_per_s Set to the speed in mm/s, negative backward.
+ * @param tenths_per_s Set to the turn rate in tenths of a degree per second, positive counterclockwise.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void odometry_velocity(int *mm_per_s, int *tenths_per_s)
+{
+
+    *mm_per_s = speed;
+    *tenths_per_s = turn_rate;
+
+}
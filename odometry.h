@@ -0,0 +1,61 @@
+/*
+ * odometry.h
+ *
+ *  Created on: May 5, 2018
+ *      Author: mmorth
+ */
+
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+#include <stdint.h>
+
+// Millimeters of wheel travel per encoder count, in 1/65536 mm: 72mm wheels, 508.8 counts per turn, 72 pi / 508.8 * 65536
+#define ODOMETRY_MM_PER_COUNT 29135
+
+// Heading change per encoder count of difference between the wheels, as a binary angle: 235mm between the wheels,
+// 72 pi / 508.8 / 235 / (2 pi) * 2^32
+#define ODOMETRY_ANGLE_PER_COUNT 1293146
+
+// Positions are in 1/65536 mm. Shift right by this to get mm.
+#define ODOMETRY_SHIFT 16
+
+// Binary angles turn all the way around in 2^32. Sines and cosines are in 1/32768.
+#define ODOMETRY_ANGLE_DEGREES(degrees) ((uint32_t) ((int64_t) (degrees) * 4294967296LL / 360))
+#define ODOMETRY_ONE 32768
+
+/// Where the robot is, from where odometry was last reset
+typedef struct {
+    int32_t x;        // Millimeters forward of the start, in 1/65536 mm
+    int32_t y;        // Millimeters left of the start, in 1/65536 mm
+    uint32_t heading; // Counterclockwise from the start heading as a binary angle, 2^32 per turn
+} odometry_pose_t;
+
+// Sets the pose to 0 and starts over from the next encoder counts
+void odometry_reset(void);
+
+// Sets the pose, keeping the encoder counts
+void odometry_set_pose(const odometry_pose_t *pose);
+
+// Moves the pose by the change in the raw encoder counts since the last update. Counts may wrap around.
+void odometry_update(uint16_t left_count, uint16_t right_count, uint32_t now_ms);
+
+// Copies the pose
+void odometry_get(odometry_pose_t *pose);
+
+// Returns the heading in tenths of a degree, -1800 to 1799
+int odometry_heading_tenths(uint32_t heading);
+
+// Returns the whole degrees turned since the last call. The rest is kept for the next call.
+int odometry_take_degrees(void);
+
+// Gets the speed in mm/s and the turn rate in tenths of a degree per second over the last update
+void odometry_velocity(int *mm_per_s, int *tenths_per_s);
+
+// Returns the sine of a binary angle in 1/32768
+int32_t odometry_sin(uint32_t angle);
+
+// Returns the cosine of a binary angle in 1/32768
+int32_t odometry_cos(uint32_t angle);
+
+#endif /* ODOMETRY_H_ */
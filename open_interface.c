@@ -14,6 +14,12 @@
  */
 
 #include "open_interface.h"
+#include "uart.h"
+#include "odometry.h"
+#include "sched.h"
+#include <stdbool.h>
+#include "driverlib/sysctl.h"
+#include "driverlib/interrupt.h"
 
 #define OI_OPCODE_START            128
 #define OI_OPCODE_BAUD             129
@@ -80,6 +86,141 @@
 
 #define SENSOR_PACKET_SIZE	80
 
+// First and last single sensor packet ID
+#define OI_PACKET_FIRST 7
+#define OI_PACKET_LAST 58
+
+// First byte of every stream frame
+#define OI_STREAM_HEADER 19
+
+///Number of data bytes of each single sensor packet, indexed by packet ID. 0 for IDs that are groups.
+static const uint8_t oi_packetSize[OI_PACKET_LAST + 1] = {
+	0, 0, 0, 0, 0, 0, 0,		// 0-6 are groups
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	// 7-16
+	1, 1, 2, 2, 1, 2, 2, 1, 2, 2,	// 17-26
+	2, 2, 2, 2, 2, 1, 2, 1, 1, 1,	// 27-36
+	1, 1, 2, 2, 2, 2, 2, 2, 1, 2,	// 37-46
+	2, 2, 2, 2, 2, 1, 1, 2, 2, 2,	// 47-56
+	2, 1				// 57-58
+};
+
+///Moves the odometry pose and gets the degrees turned, in place of the Roomba's angle packet
+static int oi_odometryDegrees(oi_t *self);
+
+///Receive buffers. The interrupt fills one while the other holds the latest complete response or stream frame.
+static volatile uint8_t oi_rxBuffer[2][SENSOR_PACKET_SIZE];
+static volatile uint8_t oi_rxLength[2];
+static volatile int oi_rxWrite = 0;
+static volatile int oi_rxReady = -1;
+
+///What the receiver is expecting
+typedef enum {
+	OI_RX_IDLE,	// Nothing. Bytes go to oi_uartReceive.
+	OI_RX_RESPONSE,	// The response to a query, oi_rxExpected bytes long
+	OI_RX_STREAM	// Stream frames
+} oi_rx_mode_t;
+static volatile oi_rx_mode_t oi_rxMode = OI_RX_IDLE;
+
+///State of the response to the last query
+#define OI_QUERY_WAITING 0	// Bytes are still arriving
+#define OI_QUERY_COMPLETE 1	// Every byte arrived and is waiting to be decoded
+#define OI_QUERY_FAILED -1	// A byte had a framing error or the response timed out
+#define OI_QUERY_NONE 2		// No query is waiting to be decoded
+
+///Response being received: bytes expected and received, and its state
+static volatile int oi_rxExpected = 0;
+static volatile int oi_rxIndex = 0;
+static volatile int oi_rxStatus = OI_QUERY_NONE;
+
+///Query waiting for its response
+static const uint8_t *oi_queryIds;
+static int oi_queryCount;
+static uint32_t oi_queryStartMs;
+
+///Stream frame being received
+typedef enum { WAIT_HEADER, WAIT_LENGTH, WAIT_DATA, WAIT_CHECKSUM } oi_stream_state_t;
+static oi_stream_state_t oi_streamState = WAIT_HEADER;
+static uint8_t oi_streamLength, oi_streamSum;
+
+///Bytes after a false stream header, to be looked through again for the real header.
+///	A frame is at most OI_STREAM_MAX_BYTES + 2 bytes after its header and a replayed one can fail again.
+#define OI_REPLAY_SIZE (2 * (OI_STREAM_MAX_BYTES + 2))
+static uint8_t oi_replayBuffer[OI_REPLAY_SIZE];
+static int oi_replayHead = 0;
+static int oi_replayCount = 0;
+
+///Commands waiting to be sent. The UART4 interrupt drains them into the FIFO.
+#define OI_TX_MASK (OI_TX_BUFFER_SIZE - 1)
+static volatile uint8_t oi_txBuffer[OI_TX_BUFFER_SIZE];
+static volatile uint16_t oi_txHead = 0;
+static volatile uint16_t oi_txTail = 0;
+static oi_tx_stats_t oi_txStats_;
+
+///Position of a drive wheels command that has not started going out, or -1. A newer one overwrites it.
+static volatile int oi_wheelsAt = -1;
+
+///Wheel bytes of the last drive wheels command queued, and 0 until one has been queued since the Roomba was started
+static uint8_t oi_wheelsLast[4];
+static int oi_wheelsKnown = 0;
+
+///Bytes received while idle, for oi_uartReceive
+#define OI_RAW_SIZE 64
+static volatile uint8_t oi_rawBuffer[OI_RAW_SIZE];
+static volatile int oi_rawHead = 0;
+static volatile int oi_rawTail = 0;
+
+///Complete responses and stream frames, and the count when the program last read a stream frame
+static volatile uint32_t oi_rxPackets = 0;
+static uint32_t oi_streamLastRead = 0;
+
+///Receive error counts
+static volatile oi_rx_stats_t oi_rxStats_;
+
+///Time the last response or stream frame arrived, to keep queries OI_QUERY_INTERVAL_MS apart
+static volatile uint32_t oi_lastReceive = 0;
+
+///Distance and angle deltas of every frame since the program last read one
+static volatile int32_t oi_streamDistance = 0;
+static volatile int32_t oi_streamAngle = 0;
+
+///1 while the Roomba is streaming
+static volatile int oi_streaming = 0;
+
+///Packet IDs of each preset. OI_PRESET_EVERYTHING is queried as group 100 instead of a list.
+static const uint8_t oi_presetOdometry[] = { 19, 20, 43, 44 };
+static const uint8_t oi_presetHazards[] = { 7, 9, 10, 11, 12, 28, 29, 30, 31, 45 };
+static const uint8_t oi_presetMotion[] = { 7, 9, 10, 11, 12, 19, 20, 28, 29, 30, 31, 43, 44 };
+
+static const uint8_t * const oi_presetIds[OI_PRESET_COUNT] = {
+	oi_presetOdometry, oi_presetHazards, oi_presetMotion, 0
+};
+static const uint8_t oi_presetCount[OI_PRESET_COUNT] = {
+	sizeof(oi_presetOdometry), sizeof(oi_presetHazards), sizeof(oi_presetMotion), 0
+};
+
+///Decode a list of packets that arrived back to back
+///	internal function
+static void oi_decodeList(oi_t* self, const uint8_t ids[], int count, const uint8_t data[]);
+
+///Decode one single sensor packet into the oi_t struct
+///	internal function
+void oi_decodePacket(oi_t* self, uint8_t id, const uint8_t data[]);
+
+///Queue a command for the Roomba without waiting
+///	internal function
+static int oi_txCommand(const uint8_t command[], int length);
+
+///Queue a command, with interrupts disabled
+///	internal function
+static int oi_txPut(const uint8_t command[], int length);
+
+///Move queued bytes into the transmit FIFO
+///	internal function
+static void oi_txFill(void);
+
+///Handle the UART4 receive and transmit interrupts
+void UART4_Handler(void);
+
 
 /// Initialize the iRobot open interface without updating a struct
 /// internal function
@@ -134,6 +275,7 @@ void oi_free(oi_t *self)
 void oi_init_noupdate()
 {
 	oi_uartInit();
+	oi_wheelsKnown = 0;	//the Roomba starts with its wheels stopped, but do not count on it
 	oi_uartSendChar(OI_OPCODE_START);
 
 	oi_uartSendChar(OI_OPCODE_FULL);		//Use full mode, unrestricted control
@@ -155,6 +297,7 @@ void oi_init_noupdate()
 void oi_init(oi_t *self)
 {
 	oi_init_noupdate();
+	odometry_reset();	//the pose starts where the robot is now
 
 	oi_update(self);
 	oi_update(self); //Call twice to clear distance/angle
@@ -164,124 +307,732 @@ void oi_init(oi_t *self)
 void oi_close() {
 	oi_setWheels(0, 0);
 	oi_uartSendChar(OI_OPCODE_STOP);
+	oi_wheelsKnown = 0;
+
+	//Nothing may run after this to let the interrupt send them
+	oi_txFlush();
 }
 
 ///Update all sensor and store in oi_t struct
+///	While streaming, waits for the next stream frame instead of querying group 100
 void oi_update(oi_t *self)
 {
-	uint8_t sensorBuffer[SENSOR_PACKET_SIZE];
+	oi_updatePreset(self, OI_PRESET_EVERYTHING);
+}
+
+///Update the sensors of a preset and store them in oi_t struct
+///	While streaming, waits for the next stream frame instead, so the stream should cover the preset
+void oi_updatePreset(oi_t *self, oi_preset_t preset)
+{
+	if (oi_streaming) {
+		oi_streamWait(self);
+		return;
+	}
+
+	oi_queryPreset(self, preset);
+}
+
+/**
+ * Query the sensors of a preset and decode only those packets.
+ *
+ * OI_PRESET_EVERYTHING asks for group 100 (opcode 142), the others send their packet list (opcode 149).
+ *
+ * @param self the struct to update
+ * @param preset the packets to query
+ * @return the number of data bytes received, or 0 while streaming or if the response failed
+ */
+int oi_queryPreset(oi_t *self, oi_preset_t preset)
+{
+	if (!oi_queryStartPreset(preset)) {
+		return 0;
+	}
+	return oi_queryWait(self);
+}
+
+/**
+ * Query a list of single sensor packets (opcode 149) and decode only those packets.
+ *
+ * With packets 43 and 44 (encoder counts) the angle turned is worked out from them like oi_parsePacket does.
+ *
+ * @param self the struct to update
+ * @param ids the packet IDs, each 7-58
+ * @param count the number of packet IDs
+ * @return the number of data bytes received, or 0 if the list is not valid, the Roomba is streaming, or the response failed
+ */
+int oi_query(oi_t *self, const uint8_t ids[], int count)
+{
+	if (!oi_queryStart(ids, count)) {
+		return 0;
+	}
+	return oi_queryWait(self);
+}
+
+///Get the receiver ready for a response of expected bytes
+///	internal function
+static void oi_responseBegin(int expected)
+{
+	//Keep the Roomba from being asked faster than it updates its sensors
+	while (timer_getMillis() - oi_lastReceive < OI_QUERY_INTERVAL_MS) {
+		sched_idle();
+	}
+
+	//Bytes left over from a response that timed out are thrown away
+	bool masked = IntMasterDisable();
+	oi_rawTail = oi_rawHead;
+	oi_rxIndex = 0;
+	oi_rxExpected = expected;
+	oi_rxStatus = OI_QUERY_WAITING;
+	oi_rxMode = OI_RX_RESPONSE;
+	if (!masked) {
+		IntMasterEnable();
+	}
+
+	oi_queryStartMs = timer_getMillis();
+}
+
+/**
+ * Send a query list (opcode 149) without waiting for the response.
+ *
+ * The UART4 interrupt collects the response. Call oi_queryPoll or oi_queryWait to decode it.
+ *
+ * @param ids the packet IDs, each 7-58. Must stay valid until the response is decoded.
+ * @param count the number of packet IDs
+ * @return the number of data bytes expected, or 0 if the list is not valid or the Roomba is streaming
+ */
+int oi_queryStart(const uint8_t ids[], int count)
+{
+	int bytes = 0;
+	int i;
 
-	//Query list of sensors
-	oi_uartSendChar(OI_OPCODE_SENSORS);
-	oi_uartSendChar(OI_SENSOR_PACKET_GROUP100);
+	for (i = 0; i < count; i++) {
+		if (oi_packetBytes(ids[i]) == 0) {
+			return 0;
+		}
+		bytes += oi_packetBytes(ids[i]);
+	}
+	if (oi_streaming || count == 0 || bytes > SENSOR_PACKET_SIZE) {
+		return 0;
+	}
 
-	// Read all the sensor data
-	uint8_t i;
-	for (i = 0; i < SENSOR_PACKET_SIZE; i++) {
-		// read each sensor byte
-		sensorBuffer[i] = oi_uartReceive();
+	uint8_t command[2 + SENSOR_PACKET_SIZE];
+	command[0] = OI_OPCODE_QUERY_LIST;
+	command[1] = count;
+	for (i = 0; i < count; i++) {
+		command[2 + i] = ids[i];
 	}
 
-	//Parse the sensor data into the struct
-	oi_parsePacket(self, sensorBuffer);
+	oi_queryIds = ids;
+	oi_queryCount = count;
+	oi_responseBegin(bytes);
+	oi_txCommand(command, 2 + count);
 
-	timer_waitMillis(25); // reduces USART errors that occur when continuously transmitting/receiving min wait time=15ms
+	return bytes;
+}
+
+///Send the query for a preset without waiting for the response. Returns the number of data bytes expected, or 0 while streaming.
+int oi_queryStartPreset(oi_preset_t preset)
+{
+	if (preset != OI_PRESET_EVERYTHING) {
+		return oi_queryStart(oi_presetIds[preset], oi_presetCount[preset]);
+	}
+	if (oi_streaming) {
+		return 0;
+	}
+
+	//Group 100 is parsed with oi_parsePacket
+	oi_queryIds = 0;
+	oi_queryCount = 0;
+	oi_responseBegin(SENSOR_PACKET_SIZE);
+
+	const uint8_t command[2] = { OI_OPCODE_SENSORS, OI_SENSOR_PACKET_GROUP100 };
+	oi_txCommand(command, sizeof(command));
+
+	return SENSOR_PACKET_SIZE;
+}
+
+///Check on the response to the last query without decoding it
+///	internal function
+///	@return the number of bytes once complete, 0 while waiting, or -1 if it failed, timed out, or was already decoded
+static int oi_queryCheck(void)
+{
+	if (oi_rxStatus == OI_QUERY_WAITING && timer_getMillis() - oi_queryStartMs > OI_RESPONSE_TIMEOUT_MS) {
+		//Check again with the receiver held off in case the last byte just arrived
+		bool masked = IntMasterDisable();
+		if (oi_rxStatus == OI_QUERY_WAITING) {
+			oi_rxMode = OI_RX_IDLE;
+			oi_rxStatus = OI_QUERY_FAILED;
+			oi_rxStats_.timeouts++;
+			oi_lastReceive = timer_getMillis();
+		}
+		if (!masked) {
+			IntMasterEnable();
+		}
+	}
+
+	if (oi_rxStatus == OI_QUERY_COMPLETE) {
+		return oi_rxLength[oi_rxReady];
+	}
+	return (oi_rxStatus == OI_QUERY_WAITING) ? 0 : -1;
+}
+
+///Decode the response to the last query
+///	internal function
+static void oi_queryDecode(oi_t *self)
+{
+	//The receiver is idle until the next query, so the buffer is not changing
+	const uint8_t *data = (const uint8_t *) oi_rxBuffer[oi_rxReady];
+
+	if (oi_queryIds == 0) {
+		oi_parsePacket(self, (uint8_t *) data);
+	} else {
+		oi_decodeList(self, oi_queryIds, oi_queryCount, data);
+	}
+}
+
+/**
+ * Check on the response to the last query and decode it once it is complete.
+ *
+ * @param self the struct to update
+ * @return the number of data bytes decoded, 0 while waiting, or -1 if the response failed or timed out
+ */
+int oi_queryPoll(oi_t *self)
+{
+	int result = oi_queryCheck();
+
+	if (result > 0) {
+		oi_queryDecode(self);
+		oi_rxStatus = OI_QUERY_NONE;
+	}
+
+	return result;
+}
+
+/**
+ * Wait for the response to the last query and decode it.
+ *
+ * @param self the struct to update
+ * @return the number of data bytes decoded, or 0 if the response failed or timed out
+ */
+int oi_queryWait(oi_t *self)
+{
+	int result;
+
+	while ((result = oi_queryPoll(self)) == 0) {
+		sched_idle();
+	}
+
+	return (result > 0) ? result : 0;
+}
+
+static void oi_decodeList(oi_t* self, const uint8_t ids[], int count, const uint8_t data[]) {
+	int encoders = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		oi_decodePacket(self, ids[i], data);
+		data += oi_packetSize[ids[i]];
+		if (ids[i] == 43 || ids[i] == 44) {
+			encoders = 1;
+		}
+	}
+
+	if (encoders) {
+		self->angle = oi_odometryDegrees(self);
+	}
+}
+
+///Return the number of data bytes a preset query receives and set request_bytes to the number it sends
+int oi_presetBytes(oi_preset_t preset, int *request_bytes)
+{
+	int i;
+	int bytes = 0;
+
+	if (preset == OI_PRESET_EVERYTHING) {
+		*request_bytes = 2;
+		return SENSOR_PACKET_SIZE;
+	}
+
+	for (i = 0; i < oi_presetCount[preset]; i++) {
+		bytes += oi_packetSize[oi_presetIds[preset][i]];
+	}
+	*request_bytes = 2 + oi_presetCount[preset];
+	return bytes;
+}
+
+/**
+ * Time one query of a preset.
+ *
+ * Not available while streaming.
+ *
+ * @param self the struct to update
+ * @param preset the packets to query
+ * @param cost set to the bytes sent and received, the round trip time, and the clock cycles spent decoding
+ * @return 1, or 0 while streaming
+ */
+int oi_queryBenchmark(oi_t *self, oi_preset_t preset, oi_query_cost_t *cost)
+{
+	int request_bytes;
+	int bytes = oi_presetBytes(preset, &request_bytes);
+	int result;
+
+	if (oi_streaming) {
+		return 0;
+	}
+
+	uint32_t start_ms = timer_getMillis();
+
+	oi_queryStartPreset(preset);
+	while ((result = oi_queryCheck()) == 0) {
+		sched_idle();
+	}
+	if (result < 0) {
+		return 0;
+	}
+
+	cost->round_trip_ms = timer_getMillis() - start_ms;
+
+	uint32_t start = timer_getCycles();
+	oi_queryDecode(self);
+	cost->parse_cycles = timer_cyclesSince(start);
+	oi_rxStatus = OI_QUERY_NONE;
+
+	cost->request_bytes = request_bytes;
+	cost->response_bytes = bytes;
+
+	return 1;
+}
+
+///Start the Roomba streaming the packets of a preset. OI_PRESET_EVERYTHING does not fit in a stream frame.
+int oi_streamPreset(oi_preset_t preset)
+{
+	return oi_streamStart(oi_presetIds[preset], oi_presetCount[preset]);
 }
 
 void oi_parsePacket(oi_t* self, uint8_t packet[]) {
-	self->wheelDropLeft = !!(packet[0] & 0x08);
-	self->wheelDropRight = !!(packet[0] & 0x04);
-	self->bumpLeft = !!(packet[0] & 0x02);
-	self->bumpRight = packet[0] & 0x01;
+	uint8_t id;
+
+	//Group 100 is packets 7-58 back to back
+	for (id = OI_PACKET_FIRST; id <= OI_PACKET_LAST; id++) {
+		oi_decodePacket(self, id, packet);
+		packet += oi_packetSize[id];
+	}
+
+	self->angle = oi_odometryDegrees(self);
+}
+
+void oi_decodePacket(oi_t* self, uint8_t id, const uint8_t data[]) {
+	switch (id) {
+	case 7:
+		self->wheelDropLeft = !!(data[0] & 0x08);
+		self->wheelDropRight = !!(data[0] & 0x04);
+		self->bumpLeft = !!(data[0] & 0x02);
+		self->bumpRight = data[0] & 0x01;
+		break;
+	case 8: self->wallSensor = data[0]; break;
+	case 9: self->cliffLeft = data[0]; break;
+	case 10: self->cliffFrontLeft = data[0]; break;
+	case 11: self->cliffFrontRight = data[0]; break;
+	case 12: self->cliffRight = data[0]; break;
+	case 13: self->virtualWall = data[0]; break;
+	case 14:
+		self->overcurrentLeftWheel = !!(data[0] & 0x10);
+		self->overcurrentRightWheel = !!(data[0] & 0x08);
+		self->overcurrentMainBrush = !!(data[0] & 0x04);
+		self->overcurrentSideBrush = data[0] & 0x01;
+		break;
+	case 15: self->dirtDetect = data[0]; break;
+	case 17: self->infraredCharOmni = data[0]; break;
+	case 18:
+		self->buttonClock = !!(data[0] & 0x80);
+		self->buttonSchedule = !!(data[0] & 0x40);
+		self->buttonDay = !!(data[0] & 0x20);
+		self->buttonHour = !!(data[0] & 0x10);
+		self->buttonMinute = !!(data[0] & 0x08);
+		self->buttonDock = !!(data[0] & 0x04);
+		self->buttonSpot = !!(data[0] & 0x02);
+		self->buttonClean = data[0] & 0x01;
+		break;
+	case 19: self->distance = oi_parseInt((uint8_t *) data); break;
+	case 20: self->angle = oi_parseInt((uint8_t *) data); break;
+	case 21: self->chargingState = data[0]; break;
+	case 22: self->batteryVoltage = oi_parseInt((uint8_t *) data); break;
+	case 23: self->batteryCurrent = oi_parseInt((uint8_t *) data); break;
+	case 24: self->batteryTemperature = data[0]; break;
+	case 25: self->batteryCharge = oi_parseInt((uint8_t *) data); break;
+	case 26: self->batteryCapacity = oi_parseInt((uint8_t *) data); break;
+	case 27: self->wallSignal = oi_parseInt((uint8_t *) data); break;
+	case 28: self->cliffLeftSignal = oi_parseInt((uint8_t *) data); break;
+	case 29: self->cliffFrontLeftSignal = oi_parseInt((uint8_t *) data); break;
+	case 30: self->cliffFrontRightSignal = oi_parseInt((uint8_t *) data); break;
+	case 31: self->cliffRightSignal = oi_parseInt((uint8_t *) data); break;
+	case 34: self->chargingSourcesAvailable = data[0]; break;
+	case 35: self->oiMode = data[0]; break;
+	case 36: self->songNumber = data[0]; break;
+	case 37: self->songPlaying = data[0]; break;
+	case 38: self->numberOfStreamPackets = data[0]; break;
+	case 39: self->requestedVelocity = oi_parseInt((uint8_t *) data); break;
+	case 40: self->requestedRadius = oi_parseInt((uint8_t *) data); break;
+	case 41: self->requestedRightVelocity = oi_parseInt((uint8_t *) data); break;
+	case 42: self->requestedLeftVelocity = oi_parseInt((uint8_t *) data); break;
+	case 43: self->leftEncoderCount = oi_parseInt((uint8_t *) data); break;
+	case 44: self->rightEncoderCount = oi_parseInt((uint8_t *) data); break;
+	case 45:
+		self->lightBumperRight = !!(data[0] & 0x20);
+		self->lightBumperFrontRight = !!(data[0] & 0x10);
+		self->lightBumperCenterRight = !!(data[0] & 0x08);
+		self->lightBumperCenterLeft = !!(data[0] & 0x04);
+		self->lightBumperFrontLeft = !!(data[0] & 0x02);
+		self->lightBumperLeft = data[0] & 0x01;
+		break;
+	case 46: self->lightBumpLeftSignal = oi_parseInt((uint8_t *) data); break;
+	case 47: self->lightBumpFrontLeftSignal = oi_parseInt((uint8_t *) data); break;
+	case 48: self->lightBumpCenterLeftSignal = oi_parseInt((uint8_t *) data); break;
+	case 49: self->lightBumpCenterRightSignal = oi_parseInt((uint8_t *) data); break;
+	case 50: self->lightBumpFrontRightSignal = oi_parseInt((uint8_t *) data); break;
+	case 51: self->lightBumpRightSignal = oi_parseInt((uint8_t *) data); break;
+	case 52: self->infraredCharLeft = data[0]; break;
+	case 53: self->infraredCharRight = data[0]; break;
+	case 54: self->leftMotorCurrent = oi_parseInt((uint8_t *) data); break;
+	case 55: self->rightMotorCurrent = oi_parseInt((uint8_t *) data); break;
+	case 56: self->mainBrushMotorCurrent = oi_parseInt((uint8_t *) data); break;
+	case 57: self->sideBrushMotorCurrent = oi_parseInt((uint8_t *) data); break;
+	case 58: self->stasis = data[0]; break;
+	default: break;	//16, 32 and 33 are unused
+	}
+}
+
+///Return the number of data bytes of a single sensor packet, or 0 if the ID is not a single packet
+int oi_packetBytes(uint8_t id) {
+	return (id <= OI_PACKET_LAST) ? oi_packetSize[id] : 0;
+}
+
+/**
+ * Start the Roomba streaming a list of single sensor packets every 15ms.
+ *
+ * A UART4 interrupt receives the frames and checks their checksums in the background.
+ * While streaming, oi_update waits for the next frame and decodes only the packets in the list.
+ * With packets 43 and 44 (encoder counts) the angle turned is worked out from them like oi_parsePacket does,
+ * otherwise packet 20 is used.
+ *
+ * @param ids the packet IDs to stream, each 7-58
+ * @param count the number of packet IDs
+ * @return 1, or 0 if an ID is not a single packet or the frame would not fit in OI_STREAM_MAX_BYTES
+ */
+int oi_streamStart(const uint8_t ids[], int count) {
+	int i;
+	int bytes = 0;
+
+	for (i = 0; i < count; i++) {
+		if (oi_packetBytes(ids[i]) == 0) {
+			return 0;
+		}
+		bytes += 1 + oi_packetBytes(ids[i]);
+	}
+	if (count == 0 || bytes > OI_STREAM_MAX_BYTES) {
+		return 0;
+	}
 
-	self->wallSensor = packet[1];
+	oi_streamStop();
+
+	//A query that was never decoded is abandoned
+	bool masked = IntMasterDisable();
+	oi_rxReady = -1;
+	oi_rxStatus = OI_QUERY_NONE;
+	oi_streamState = WAIT_HEADER;
+	oi_replayCount = 0;
+	oi_streamDistance = 0;
+	oi_streamAngle = 0;
+	oi_streamLastRead = oi_rxPackets;
+	oi_rxMode = OI_RX_STREAM;
+	oi_streaming = 1;
+	if (!masked) {
+		IntMasterEnable();
+	}
 
-	self->cliffLeft = packet[2];
-	self->cliffFrontLeft = packet[3];
-	self->cliffFrontRight = packet[4];
-	self->cliffRight = packet[5];
+	uint8_t command[2 + OI_STREAM_MAX_BYTES / 2];
+	command[0] = OI_OPCODE_STREAM;
+	command[1] = count;
+	for (i = 0; i < count; i++) {
+		command[2 + i] = ids[i];
+	}
+	oi_txCommand(command, 2 + count);
 
-	self->virtualWall = packet[6];
+	return 1;
+}
 
-	self->overcurrentLeftWheel = !!(packet[7] & 0x10);
-	self->overcurrentRightWheel = !!(packet[7] & 0x08);
-	self->overcurrentMainBrush = !!(packet[7] & 0x04);
-	self->overcurrentSideBrush = packet[7] & 0x01;
+///Stop the Roomba streaming and go back to querying group 100 in oi_update
+void oi_streamStop(void) {
+	if (!oi_streaming) {
+		return;
+	}
 
-	self->dirtDetect = packet[8];
+	const uint8_t command[2] = { OI_OPCODE_DO_STREAM, 0 };
+	oi_txCommand(command, sizeof(command));
+
+	//Let a frame that was already being sent finish, then stop looking for frames
+	sched_sleep(OI_STREAM_PERIOD_MS + 5);
+	bool masked = IntMasterDisable();
+	oi_rxMode = OI_RX_IDLE;
+	oi_rawTail = oi_rawHead;
+	oi_streaming = 0;
+	oi_lastReceive = timer_getMillis();
+	if (!masked) {
+		IntMasterEnable();
+	}
+}
 
-	//Byte 9 unused
+///Return 1 while the Roomba is streaming
+int oi_streamActive(void) {
+	return oi_streaming;
+}
 
-	self->infraredCharOmni = packet[10];
+/**
+ * Decode the latest stream frame into the oi_t struct.
+ *
+ * Fields of packets not in the stream are left alone. distance and angle are the totals
+ * since the last read, so no movement is lost when frames are not read.
+ *
+ * @param self the struct to update
+ * @return 1 if a frame arrived since the last read, 0 if not (self is not changed)
+ */
+int oi_streamRead(oi_t *self) {
+	uint8_t frame[OI_STREAM_MAX_BYTES];
+	uint8_t length;
+	int32_t distance, angle;
+	int i;
 
-	self->buttonClock = !!(packet[11] & 0x80);
-	self->buttonSchedule = !!(packet[11] & 0x40);
-	self->buttonDay = !!(packet[11] & 0x20);
-	self->buttonHour = !!(packet[11] & 0x10);
-	self->buttonMinute = !!(packet[11] & 0x08);
-	self->buttonDock = !!(packet[11] & 0x04);
-	self->buttonSpot = !!(packet[11] & 0x02);
-	self->buttonClean = packet[11] & 0x01;
+	//Hold off the interrupts while taking the frame and the totals. The receiver is not held off through
+	//UART4_IM_R, since the system tick reads the stream during a move and its wheel commands change that register.
+	bool masked = IntMasterDisable();
+	int ready = oi_rxReady;
+	int fresh = (oi_rxPackets != oi_streamLastRead);
+	if (ready >= 0 && fresh) {
+		length = oi_rxLength[ready];
+		for (i = 0; i < length; i++) {
+			frame[i] = oi_rxBuffer[ready][i];
+		}
+		distance = oi_streamDistance;
+		angle = oi_streamAngle;
+		oi_streamDistance = 0;
+		oi_streamAngle = 0;
+		oi_streamLastRead = oi_rxPackets;
+	}
+	if (!masked) {
+		IntMasterEnable();
+	}
 
-	self->distance = oi_parseInt(packet + 12);
+	if (ready < 0 || !fresh) {
+		return 0;
+	}
 
+	//The frame was checked by the interrupt, so each ID is known and the sizes add up
+	int encoders = 0;
+	for (i = 0; i < length; i += 1 + oi_packetSize[frame[i]]) {
+		oi_decodePacket(self, frame[i], &frame[i + 1]);
+		if (frame[i] == 43 || frame[i] == 44) {
+			encoders = 1;
+		}
+	}
 
-	self->chargingState = packet[16];
-	self->batteryVoltage = oi_parseInt(packet + 17);
-	self->batteryCurrent = oi_parseInt(packet + 19);
-	self->batteryTemperature = packet[21];
-	self->batteryCharge = oi_parseInt(packet + 22);
-	self->batteryCapacity = oi_parseInt(packet + 24);
+	//Use the encoder counts for the angle like oi_parsePacket, or the Roomba's own angle without them
+	self->distance = distance;
+	self->angle = encoders ? oi_odometryDegrees(self) : angle;
 
-	self->wallSignal = oi_parseInt(packet + 26);
+	return 1;
+}
 
-	self->cliffLeftSignal = oi_parseInt(packet + 28);
-	self->cliffFrontLeftSignal = oi_parseInt(packet + 30);
-	self->cliffFrontRightSignal = oi_parseInt(packet + 32);
-	self->cliffRightSignal = oi_parseInt(packet + 34);
+///Wait for the next stream frame, up to OI_STREAM_TIMEOUT_MS, and decode it into the oi_t struct
+void oi_streamWait(oi_t *self) {
+	uint32_t start = timer_getMillis();
 
-	//Bytes 36-38 unused
+	while (oi_rxPackets == oi_streamLastRead && timer_getMillis() - start < OI_STREAM_TIMEOUT_MS) {
+		sched_idle();
+	}
 
-	self->chargingSourcesAvailable = packet[39];
-	self->oiMode = packet[40];
+	oi_streamRead(self);
+}
 
-	self->songNumber = packet[41];
-	self->songPlaying = packet[42];
+///Copy the receive counts: responses and stream frames received, and everything that went wrong
+void oi_rxStats(oi_rx_stats_t *stats) {
+	bool masked = IntMasterDisable();
+	stats->packets = oi_rxPackets;
+	stats->dropped = oi_rxStats_.dropped;
+	stats->resyncs = oi_rxStats_.resyncs;
+	stats->framing_errors = oi_rxStats_.framing_errors;
+	stats->timeouts = oi_rxStats_.timeouts;
+	stats->stray = oi_rxStats_.stray;
+	if (!masked) {
+		IntMasterEnable();
+	}
+}
 
-	self->numberOfStreamPackets = packet[43];
+///Check a complete stream frame and add its distance and angle to the totals
+///	internal function
+///	@return 1 if every packet ID is known and the packet sizes add up to the frame length
+static int oi_streamAccept(const volatile uint8_t frame[], uint8_t length) {
+	int i = 0;
+	int16_t distance = 0, angle = 0;
+
+	while (i < length) {
+		uint8_t id = frame[i];
+		if (oi_packetBytes(id) == 0 || i + 1 + oi_packetSize[id] > length) {
+			return 0;
+		}
+		if (id == 19) {
+			distance = (frame[i + 1] << 8) | frame[i + 2];
+		} else if (id == 20) {
+			angle = (frame[i + 1] << 8) | frame[i + 2];
+		}
+		i += 1 + oi_packetSize[id];
+	}
 
-	self->requestedVelocity = oi_parseInt(packet + 44);
-	self->requestedRadius = oi_parseInt(packet + 46);
-	self->requestedRightVelocity = oi_parseInt(packet + 48);
-	self->requestedLeftVelocity = oi_parseInt(packet + 50);
-	self->leftEncoderCount = oi_parseInt(packet + 52);
-	self->rightEncoderCount = oi_parseInt(packet + 54);
+	oi_streamDistance += distance;
+	oi_streamAngle += angle;
+	return 1;
+}
 
-	self->lightBumperRight = !!(packet[56] & 0x20);
-	self->lightBumperFrontRight = !!(packet[56] & 0x10);
-	self->lightBumperCenterRight = !!(packet[56] & 0x08);
-	self->lightBumperCenterLeft = !!(packet[56] & 0x04);
-	self->lightBumperFrontLeft = !!(packet[56] & 0x02);
-	self->lightBumperLeft = packet[56] & 0x01;
+///Publish the buffer the interrupt was filling as the latest response or stream frame
+///	internal function
+static void oi_rxPublish(uint8_t length) {
+	oi_rxLength[oi_rxWrite] = length;
+	oi_rxReady = oi_rxWrite;
+	oi_rxWrite ^= 1;
+	oi_rxPackets++;
+	oi_lastReceive = timer_getMillis();
+}
+
+///Look for the next header in the bytes after a false one
+///	internal function
+static void oi_streamReplay(uint8_t length, uint8_t checksum) {
+	const volatile uint8_t *frame = oi_rxBuffer[oi_rxWrite];
+	int i;
+
+	oi_replayBuffer[(oi_replayHead + oi_replayCount++) % OI_REPLAY_SIZE] = length;
+	for (i = 0; i < length; i++) {
+		oi_replayBuffer[(oi_replayHead + oi_replayCount++) % OI_REPLAY_SIZE] = frame[i];
+	}
+	oi_replayBuffer[(oi_replayHead + oi_replayCount++) % OI_REPLAY_SIZE] = checksum;
+}
+
+///Receive one byte of a stream frame: header 19, byte count, packet IDs and data, checksum
+///	internal function
+static void oi_streamByte(uint8_t data) {
+	switch (oi_streamState) {
+	case WAIT_HEADER:
+		if (data == OI_STREAM_HEADER) {
+			oi_streamSum = data;
+			oi_streamState = WAIT_LENGTH;
+		}
+		break;
+	case WAIT_LENGTH:
+		if (data == 0 || data > OI_STREAM_MAX_BYTES) {
+			//The 19 was data, and this byte could be the real header
+			oi_rxStats_.resyncs++;
+			oi_streamState = WAIT_HEADER;
+			oi_streamByte(data);
+			break;
+		}
+		oi_streamLength = data;
+		oi_rxIndex = 0;
+		oi_streamSum += data;
+		oi_streamState = WAIT_DATA;
+		break;
+	case WAIT_DATA:
+		oi_rxBuffer[oi_rxWrite][oi_rxIndex++] = data;
+		oi_streamSum += data;
+		if (oi_rxIndex == oi_streamLength) {
+			oi_streamState = WAIT_CHECKSUM;
+		}
+		break;
+	case WAIT_CHECKSUM:
+		//All bytes of the frame, including the checksum, add up to 0
+		oi_streamSum += data;
+		oi_streamState = WAIT_HEADER;
+		if (oi_streamSum == 0 && oi_streamAccept(oi_rxBuffer[oi_rxWrite], oi_streamLength)) {
+			oi_rxPublish(oi_streamLength);
+		} else {
+			//Either the frame was damaged or the header was a 19 in the data of another frame
+			oi_rxStats_.dropped++;
+			oi_rxStats_.resyncs++;
+			oi_streamReplay(oi_streamLength, data);
+		}
+		break;
+	}
+}
 
-	self->lightBumpLeftSignal = oi_parseInt(packet + 57);
-	self->lightBumpFrontLeftSignal = oi_parseInt(packet + 59);
-	self->lightBumpCenterLeftSignal = oi_parseInt(packet + 61);
-	self->lightBumpCenterRightSignal = oi_parseInt(packet + 63);
-	self->lightBumpFrontRightSignal = oi_parseInt(packet + 65);
-	self->lightBumpRightSignal = oi_parseInt(packet + 67);
+///Give up on the response or stream frame being received after a byte arrived damaged
+///	internal function
+static void oi_rxError(void) {
+	oi_rxStats_.framing_errors++;
+
+	if (oi_rxMode == OI_RX_RESPONSE) {
+		oi_rxMode = OI_RX_IDLE;
+		oi_rxStatus = OI_QUERY_FAILED;
+		oi_rxStats_.dropped++;
+		oi_lastReceive = timer_getMillis();
+	} else if (oi_rxMode == OI_RX_STREAM && oi_streamState != WAIT_HEADER) {
+		oi_streamState = WAIT_HEADER;
+		oi_rxStats_.dropped++;
+	}
+}
 
-	self->infraredCharLeft = packet[69];
-	self->infraredCharRight = packet[70];
+/**
+ * Receive everything the Roomba sends.
+ *
+ * Responses to queries and checked stream frames go into the buffer the program is not reading,
+ * which is then swapped with the one holding the last complete response or frame.
+ * Bytes nobody asked for go to oi_uartReceive.
+ */
+static void oi_rxDrain(void) {
+	while (!(UART4_FR_R & UART_FR_RXFE)) {
+		uint32_t word = UART4_DR_R;
+		uint8_t data = word & 0xFF;
+
+		if (word & (UART_DR_OE | UART_DR_BE | UART_DR_PE | UART_DR_FE)) {
+			oi_rxError();
+			continue;
+		}
 
-	self->leftMotorCurrent = oi_parseInt(packet + 71);
-	self->rightMotorCurrent = oi_parseInt(packet + 73);
-	self->mainBrushMotorCurrent = oi_parseInt(packet + 75);
-	self->sideBrushMotorCurrent = oi_parseInt(packet + 77);
+		switch (oi_rxMode) {
+		case OI_RX_IDLE:
+			oi_rxStats_.stray++;
+			if ((oi_rawHead + 1) % OI_RAW_SIZE != oi_rawTail) {
+				oi_rawBuffer[oi_rawHead] = data;
+				oi_rawHead = (oi_rawHead + 1) % OI_RAW_SIZE;
+			}
+			break;
+		case OI_RX_RESPONSE:
+			oi_rxBuffer[oi_rxWrite][oi_rxIndex++] = data;
+			if (oi_rxIndex == oi_rxExpected) {
+				oi_rxMode = OI_RX_IDLE;
+				oi_rxStatus = OI_QUERY_COMPLETE;
+				oi_rxPublish(oi_rxExpected);
+			}
+			break;
+		case OI_RX_STREAM:
+			oi_streamByte(data);
+			while (oi_replayCount > 0) {
+				uint8_t replay = oi_replayBuffer[oi_replayHead];
+				oi_replayHead = (oi_replayHead + 1) % OI_REPLAY_SIZE;
+				oi_replayCount--;
+				oi_streamByte(replay);
+			}
+			break;
+		}
+	}
+}
 
-	self->stasis = packet[79];
+///Receive from and send to the Roomba. Each direction is only handled when its own interrupt is unmasked.
+void UART4_Handler(void) {
+	if (UART4_MIS_R & (UART_MIS_RXMIS | UART_MIS_RTMIS)) {
+		UART4_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC;
+		oi_rxDrain();
+	}
 
-	self->angle = getDegrees(self);
+	if (UART4_MIS_R & UART_MIS_TXMIS) {
+		UART4_ICR_R = UART_ICR_TXIC;
+		oi_txFill();
+	}
 }
 
 inline int16_t oi_parseInt(uint8_t* theInt) {
@@ -295,32 +1046,138 @@ inline int16_t oi_parseInt(uint8_t* theInt) {
 /// \param power_intensity (0-255) 0=off, 255=full intensity
 void oi_setLeds(uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint8_t power_intensity)
 {
+	uint8_t command[4];
+
 	// LED Opcode
-	oi_uartSendChar(OI_OPCODE_LEDS);
+	command[0] = OI_OPCODE_LEDS;
 
 	// Set the Play and Advance LEDs
-	oi_uartSendChar(advance_led << 3 && play_led << 2);
+	command[1] = (advance_led << 3) | (play_led << 2);
 
 	// Set the power led color
-	oi_uartSendChar(power_color);
+	command[2] = power_color;
 
 	// Set the power led intensity
-	oi_uartSendChar(power_intensity);
+	command[3] = power_intensity;
+
+	oi_txCommand(command, sizeof(command));
 }
 
 /// \brief Set direction and speed of the robot's wheels
+/// Does nothing if the wheels were already told to do this. Replaces a wheel command that has not gone out yet.
 /// \param linear velocity in mm/s values range from -500 -> 500 of right wheel
 /// \param linear velocity in mm/s values range from -500 -> 500 of left wheel
 void oi_setWheels(int16_t right_wheel, int16_t left_wheel)
 {
-	oi_uartSendChar(OI_OPCODE_DRIVE_WHEELS);
-	oi_uartSendChar(right_wheel>>8);
-	oi_uartSendChar(right_wheel & 0xff);
-	oi_uartSendChar(left_wheel>>8);
-	oi_uartSendChar(left_wheel& 0xff);
+	const uint8_t command[5] = {
+		OI_OPCODE_DRIVE_WHEELS, right_wheel >> 8, right_wheel & 0xff, left_wheel >> 8, left_wheel & 0xff
+	};
+	int i;
+
+	//The control tick sends wheel commands too, so nothing may interrupt this
+	bool masked = IntMasterDisable();
+
+	int same = oi_wheelsKnown;
+	for (i = 0; i < 4; i++) {
+		same = same && (oi_wheelsLast[i] == command[1 + i]);
+	}
+
+	if (same) {
+		oi_txStats_.coalesced++;
+	} else if (oi_wheelsAt >= 0) {
+		//Only the newest speeds matter, so overwrite the ones still waiting to go out
+		for (i = 0; i < 4; i++) {
+			oi_txBuffer[(oi_wheelsAt + 1 + i) & OI_TX_MASK] = command[1 + i];
+			oi_wheelsLast[i] = command[1 + i];
+		}
+		oi_txStats_.coalesced++;
+	} else {
+		int at = oi_txPut(command, sizeof(command));
+		if (at >= 0) {
+			oi_wheelsAt = at;
+			for (i = 0; i < 4; i++) {
+				oi_wheelsLast[i] = command[1 + i];
+			}
+			oi_wheelsKnown = 1;
+		}
+	}
+
+	oi_txFill();
+	if (!masked) {
+		IntMasterEnable();
+	}
 }
 
 
+/**
+ * Load a script (opcode 152) and play it (opcode 153).
+ *
+ * The Roomba runs the script on its own. During its wait commands it does not answer queries
+ * or react to anything else. The Create 2 firmware does not have scripts and runs the
+ * opcodes of the script as ordinary commands instead.
+ *
+ * @param script the opcodes of the script
+ * @param length the number of bytes, at most OI_SCRIPT_MAX_BYTES
+ * @return 1, or 0 if it is too long or there was no room to queue it
+ */
+int oi_scriptRun(const uint8_t script[], int length)
+{
+	uint8_t command[2 + OI_SCRIPT_MAX_BYTES + 1];
+	int i;
+
+	if (length <= 0 || length > OI_SCRIPT_MAX_BYTES) {
+		return 0;
+	}
+
+	command[0] = OI_OPCODE_SCRIPT;
+	command[1] = length;
+	for (i = 0; i < length; i++) {
+		command[2 + i] = script[i];
+	}
+	command[2 + length] = OI_OPCODE_PLAY_SCRIPT;
+
+	//The script moves the wheels, so the last wheel command no longer says what they are doing
+	bool masked = IntMasterDisable();
+	oi_wheelsKnown = 0;
+	oi_wheelsAt = -1;
+	int at = oi_txPut(command, 3 + length);
+	oi_txFill();
+	if (!masked) {
+		IntMasterEnable();
+	}
+
+	return at >= 0;
+}
+
+///Run a script that drives the wheels until a wait command finishes, then stops them
+///	internal function
+static int oi_scriptDrive(int16_t right_wheel, int16_t left_wheel, uint8_t wait_opcode, int16_t amount)
+{
+	const uint8_t script[13] = {
+		OI_OPCODE_DRIVE_WHEELS, right_wheel >> 8, right_wheel & 0xff, left_wheel >> 8, left_wheel & 0xff,
+		wait_opcode, amount >> 8, amount & 0xff,
+		OI_OPCODE_DRIVE_WHEELS, 0, 0, 0, 0
+	};
+
+	return oi_scriptRun(script, sizeof(script));
+}
+
+/// \brief Drive the wheels until the Roomba has gone a distance, stopped by the Roomba itself
+/// \param millimeters distance to go, negative for backward, with wheel speeds to match
+/// \return 1, or 0 if the script could not be queued
+int oi_scriptDistance(int16_t right_wheel, int16_t left_wheel, int16_t millimeters)
+{
+	return oi_scriptDrive(right_wheel, left_wheel, OI_OPCODE_WAIT_DISTANCE, millimeters);
+}
+
+/// \brief Drive the wheels until the Roomba has turned an angle, stopped by the Roomba itself
+/// \param degrees angle to turn, positive for counterclockwise, with wheel speeds to match
+/// \return 1, or 0 if the script could not be queued
+int oi_scriptAngle(int16_t right_wheel, int16_t left_wheel, int16_t degrees)
+{
+	return oi_scriptDrive(right_wheel, left_wheel, OI_OPCODE_WAIT_ANGLE, degrees);
+}
+
 /// \brief Load song sequence
 /// \param An integer value from 0 - 15 that acts as a label for note sequence
 /// \param An integer value from 1 - 16 indicating the number of notes in the sequence
@@ -328,20 +1185,28 @@ void oi_setWheels(int16_t right_wheel, int16_t left_wheel)
 /// \param A pointer to a sequence of durations that correspond to the notes
 void oi_loadSong(int song_index, int num_notes, unsigned char  *notes, unsigned char  *duration)
 {
+	uint8_t command[OI_TX_BUFFER_SIZE - 1];
 	int i;
-	oi_uartSendChar(OI_OPCODE_SONG);
-	oi_uartSendChar(song_index);
-	oi_uartSendChar(num_notes);
+
+	if (3 + 2 * num_notes > (int) sizeof(command)) {
+		oi_txStats_.dropped++;
+		return;
+	}
+
+	command[0] = OI_OPCODE_SONG;
+	command[1] = song_index;
+	command[2] = num_notes;
 	for (i=0;i<num_notes;i++) {
-		oi_uartSendChar(notes[i]);
-		oi_uartSendChar(duration[i]);
+		command[3 + 2 * i] = notes[i];
+		command[4 + 2 * i] = duration[i];
 	}
+	oi_txCommand(command, 3 + 2 * num_notes);
 }
 
 /// Plays a given song; use oi_load_song(...) first
 void oi_play_song(int index){
-	oi_uartSendChar(OI_OPCODE_PLAY);
-	oi_uartSendChar(index);
+	const uint8_t command[2] = { OI_OPCODE_PLAY, index };
+	oi_txCommand(command, sizeof(command));
 }
 
 
@@ -370,9 +1235,9 @@ void go_charge(void) {
 ///	internal function
 void oi_uartInit(void)
 {
-	//Calculated Baudrate for 115200;
-	uint16_t iBRD = 0x08;//BRD=SYSCLK/((ClkDiv)(BaudRate)), HSE=0 ClkDiv=16, BaudRate=115,200
-	uint16_t fBRD = 44;//Fractional remainder is 0.6805, DIVFRAC = (.6805)(64)+0.5 = 44
+	//Calculate Baudrate for 115200 from the system clock
+	uint16_t iBRD, fBRD;
+	uart_baudDivisors(SysCtlClockGet(), 115200, &iBRD, &fBRD);
 
 	SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R2; //enable GPIO Port C
 
@@ -389,40 +1254,116 @@ void oi_uartInit(void)
 	UART4_IBRD_R = iBRD;
 	UART4_FBRD_R = fBRD;
 
-	UART4_LCRH_R = UART_LCRH_WLEN_8; //8 bit, 1 stop, no parity, no FIFO
+	UART4_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN; //8 bit, 1 stop, no parity, FIFO on
 	UART4_CC_R = UART_CC_CS_SYSCLK; //Use System Clock
+	UART4_IFLS_R = UART_IFLS_TX1_8 | UART_IFLS_RX4_8; //Transmit interrupt at 2 bytes left, receive interrupt at 8 bytes
+	UART4_IM_R = UART_IM_RXIM | UART_IM_RTIM; //Receive everything in the background. Damaged bytes are caught as they are read.
 	UART4_CTL_R = UART_CTL_RXE | UART_CTL_TXE | UART_CTL_UARTEN; //Enable Rx, Tx and UART module
+
+	NVIC_PRI15_R = (NVIC_PRI15_R & 0xFFFFFF1F) | 0x00000040; //Priority 2
+	NVIC_EN1_R |= 0x10000000; //Enable IRQ 60 (UART4)
+	IntRegister(INT_UART4, UART4_Handler);
+	IntMasterEnable();
+}
+
+///Move queued bytes into the transmit FIFO while it has room, and interrupt for more only while bytes are waiting
+///	internal function, called with interrupts disabled or from the interrupt
+static void oi_txFill(void)
+{
+	while (oi_txTail != oi_txHead && !(UART4_FR_R & UART_FR_TXFF)) {
+		//A wheel command can no longer be replaced once its opcode goes out
+		if (oi_txTail == oi_wheelsAt) {
+			oi_wheelsAt = -1;
+		}
+		UART4_DR_R = oi_txBuffer[oi_txTail];
+		oi_txTail = (oi_txTail + 1) & OI_TX_MASK;
+	}
+
+	if (oi_txTail != oi_txHead) {
+		UART4_IM_R |= UART_IM_TXIM;
+	} else {
+		UART4_IM_R &= ~UART_IM_TXIM;
+	}
+}
+
+///Queue a whole command, or none of it if it does not fit
+///	internal function, called with interrupts disabled
+///	@return the position of its first byte, or -1 if it was dropped
+static int oi_txPut(const uint8_t command[], int length)
+{
+	int used = (oi_txHead - oi_txTail) & OI_TX_MASK;
+	int at = oi_txHead;
+	int i;
+
+	if (used + length > OI_TX_BUFFER_SIZE - 1) {
+		oi_txStats_.dropped++;
+		return -1;
+	}
+
+	for (i = 0; i < length; i++) {
+		oi_txBuffer[(at + i) & OI_TX_MASK] = command[i];
+	}
+	oi_txHead = (at + length) & OI_TX_MASK;
+
+	oi_txStats_.commands++;
+	if ((uint32_t) (used + length) > oi_txStats_.high_water) {
+		oi_txStats_.high_water = used + length;
+	}
+	return at;
+}
+
+///Queue a command for the Roomba without waiting
+///	internal function
+///	@return 1, or 0 if there was no room and it was dropped
+static int oi_txCommand(const uint8_t command[], int length)
+{
+	bool masked = IntMasterDisable();
+	int at = oi_txPut(command, length);
+	oi_txFill();
+	if (!masked) {
+		IntMasterEnable();
+	}
+
+	return at >= 0;
+}
+
+///Wait until every queued command has been sent
+void oi_txFlush(void)
+{
+	while (oi_txTail != oi_txHead || (UART4_FR_R & UART_FR_BUSY));
+}
+
+///Copy the transmit counts: commands queued, coalesced and dropped, and the most bytes waiting at once
+void oi_txStats(oi_tx_stats_t *stats)
+{
+	bool masked = IntMasterDisable();
+	*stats = oi_txStats_;
+	if (!masked) {
+		IntMasterEnable();
+	}
 }
 
 ///transmit character
 ///	internal function
 void oi_uartSendChar(char data)
 {
-	while((UART4_FR_R & UART_FR_TXFF) != 0); //holds until no data in transmit buffer
-
-	UART4_DR_R = data; //puts data in transmission buffer
+	uint8_t command = data;
 
-	//For debugging
-	//timer_waitMicros(1000);
+	oi_txCommand(&command, 1);
 }
 
 char oi_uartReceive(void)
 {
-	static int count = 0;
-	//uint32_t tempData; //used for error checking
 	char data;
 
-	while((UART4_FR_R & UART_FR_RXFE)); //wait here until data is recieved
-
-	data = (char)(UART4_DR_R & 0xFF);
+	while (oi_rawTail == oi_rawHead); //wait here until the interrupt has received a byte
 
-	count++;
+	data = (char) oi_rawBuffer[oi_rawTail];
+	oi_rawTail = (oi_rawTail + 1) % OI_RAW_SIZE;
 
-	//ToDo: Implement error checking
 	return data;
 }
 
-
 ///transmit character array
 void oi_uartSendStr(const char *theData)
 {
@@ -436,12 +1377,7 @@ void oi_uartSendStr(const char *theData)
 
 void oi_uartSendBuff(const uint8_t theData[], uint8_t theSize)
 {
-	int i;
-
-	for(i = 0; i < theSize; i++)
-	{
-		oi_uartSendChar(theData[i]);
-	}
+	oi_txCommand(theData, theSize);
 }
 
 char* oi_checkFirmware() {
@@ -508,47 +1444,19 @@ void GPIOF_Handler(void) {
 
 
 /**
- * Get the moved degrees from the previous call of oi_update
+ * Moves the odometry pose by the new encoder counts and gets the degrees turned since the last call
  * @param self : the sensor data
+ * @return the whole degrees turned, the part of a degree left over is kept for the next call
  */
-int getDegrees(oi_t *self){
-	static int iterations = 0;
-	static int prevLeft = 0;
-	static int prevRight = 0;
-
-
-	//if(self->leftEncoderCount == 0 || self->rightEncoderCount == 0){  // update was called with no movement of the bot
-	//	return 0;
-	//}
-
-	if((self->leftEncoderCount == prevLeft) && (self->rightEncoderCount == prevRight)){ // if the bot has not moved since previous update
-		prevLeft = self->leftEncoderCount;
-		prevRight = self->rightEncoderCount;
-		return 0;
+static int oi_odometryDegrees(oi_t *self){
+	//The system tick decodes frames during a move, so keep it from updating the pose part way through this update
+	bool masked = IntMasterDisable();
+	odometry_update(self->leftEncoderCount, self->rightEncoderCount, timer_getMillis());
+	int degrees = odometry_take_degrees();
+	if (!masked) {
+		IntMasterEnable();
 	}
-	//ignore the first run, such that we do not have prevLeft or right=0, this would give a very large degree moved.
-	else if(iterations == 0){
-		prevLeft = self->leftEncoderCount;
-		prevRight = self->rightEncoderCount;
-		iterations++;
-		return 0;
-	}
-
-	//get distance moved in mm for the left and right wheel
-	// equation: ticks * (1/508)*72pi
-	//update the previous values to be correct
-	int distLeft = (self->leftEncoderCount - prevLeft)*(0.445265);
-	int distRight = (self->rightEncoderCount - prevRight)*(0.445265);
-	prevLeft = self->leftEncoderCount;
-	prevRight = self->rightEncoderCount;
-
-
-	//calculate the degree travelled by (right-left)/wheel base in mm
-	double deg = (distRight - distLeft)/178.5;//change 178.5 to improve accuracy of turning if needed
-	deg = (deg*180)/M_PI;
-
-	return (deg);
-
+	return degrees;
 }
 
 
@@ -25,6 +25,62 @@
 
 #define M_PI 3.14159265358979323846
 
+/// Time between stream frames sent by the Roomba
+#define OI_STREAM_PERIOD_MS 15
+
+/// Longest oi_update waits for a stream frame before returning the last one
+#define OI_STREAM_TIMEOUT_MS 50
+
+/// Most bytes of packet IDs and data in one stream frame
+#define OI_STREAM_MAX_BYTES 64
+
+/// Shortest time between a response arriving and the next query. The Roomba updates its sensors every 15ms.
+#define OI_QUERY_INTERVAL_MS 15
+
+/// Longest a query waits for its response
+#define OI_RESPONSE_TIMEOUT_MS 30
+
+/// Bytes of commands that can wait to be sent to the Roomba. Must be a power of 2.
+#define OI_TX_BUFFER_SIZE 128
+
+/// Longest script the Roomba can hold
+#define OI_SCRIPT_MAX_BYTES 100
+
+/// Common sets of sensor packets
+typedef enum {
+	OI_PRESET_ODOMETRY,	// distance, angle, and encoder counts
+	OI_PRESET_HAZARDS,	// bumps and wheel drops, cliffs, cliff signals, and light bumpers
+	OI_PRESET_MOTION,	// odometry and hazards, minus the light bumpers
+	OI_PRESET_EVERYTHING,	// every packet, 7-58
+	OI_PRESET_COUNT
+} oi_preset_t;
+
+/// Bytes and time of one sensor query
+typedef struct {
+	int request_bytes;	// Bytes sent to the Roomba
+	int response_bytes;	// Bytes received from the Roomba
+	uint32_t round_trip_ms;	// Time from sending the request to receiving the last byte
+	uint32_t parse_cycles;	// Clock cycles spent decoding the bytes
+} oi_query_cost_t;
+
+/// Counts kept by the UART4 receive interrupt
+typedef struct {
+	uint32_t packets;	// Complete responses and stream frames
+	uint32_t dropped;	// Responses and stream frames thrown away
+	uint32_t resyncs;	// Times the stream receiver hunted for the next header
+	uint32_t framing_errors;	// Bytes received with an overrun, break, parity or framing error
+	uint32_t timeouts;	// Responses that did not arrive in OI_RESPONSE_TIMEOUT_MS
+	uint32_t stray;	// Bytes received while no response or stream frame was expected
+} oi_rx_stats_t;
+
+/// Counts kept by the command queue
+typedef struct {
+	uint32_t commands;	// Commands queued
+	uint32_t coalesced;	// Wheel commands skipped or merged into one still waiting
+	uint32_t dropped;	// Commands dropped because the queue was full
+	uint32_t high_water;	// Most bytes waiting at once
+} oi_tx_stats_t;
+
 /// iRobot Create Sensor Data
 typedef struct {
 	//Boolean sensor values
@@ -136,6 +192,66 @@ void oi_close();
 ///Update sensor data
 void oi_update(oi_t *self);
 
+///Update the sensors of a preset. While streaming, waits for the next stream frame instead.
+void oi_updatePreset(oi_t *self, oi_preset_t preset);
+
+///Query the sensors of a preset. Returns the number of data bytes received, or 0 while streaming.
+int oi_queryPreset(oi_t *self, oi_preset_t preset);
+
+///Query a list of single sensor packets (7-58). Returns the number of data bytes received, or 0 if not valid or streaming.
+int oi_query(oi_t *self, const uint8_t ids[], int count);
+
+///Send a query list without waiting. Returns the number of data bytes expected, or 0 if not valid or streaming.
+int oi_queryStart(const uint8_t ids[], int count);
+
+///Send the query for a preset without waiting. Returns the number of data bytes expected, or 0 while streaming.
+int oi_queryStartPreset(oi_preset_t preset);
+
+///Decode the response to the last query once complete. Returns its bytes, 0 while waiting, or -1 if it failed or timed out.
+int oi_queryPoll(oi_t *self);
+
+///Wait for the response to the last query and decode it. Returns its bytes, or 0 if it failed or timed out.
+int oi_queryWait(oi_t *self);
+
+///Number of data bytes a preset query receives. Sets request_bytes to the number it sends.
+int oi_presetBytes(oi_preset_t preset, int *request_bytes);
+
+///Time one query of a preset. Returns 0 while streaming.
+int oi_queryBenchmark(oi_t *self, oi_preset_t preset, oi_query_cost_t *cost);
+
+///Start the Roomba streaming the packets of a preset (not OI_PRESET_EVERYTHING)
+int oi_streamPreset(oi_preset_t preset);
+
+///Number of data bytes of a single sensor packet (7-58), or 0 if it is not one
+int oi_packetBytes(uint8_t id);
+
+/// \brief Start the Roomba streaming sensor packets every 15ms. oi_update then waits for the next frame.
+/// \param ids the packet IDs to stream, each 7-58
+/// \param count the number of packet IDs
+/// \return 1, or 0 if the list is not valid
+int oi_streamStart(const uint8_t ids[], int count);
+
+///Stop streaming and go back to querying every sensor in oi_update
+void oi_streamStop(void);
+
+///1 while the Roomba is streaming
+int oi_streamActive(void);
+
+///Decode the latest stream frame. Returns 1 if one arrived since the last read, 0 if not.
+int oi_streamRead(oi_t *self);
+
+///Wait for the next stream frame and decode it
+void oi_streamWait(oi_t *self);
+
+///Get the counts of responses and stream frames received, dropped, and everything that went wrong
+void oi_rxStats(oi_rx_stats_t *stats);
+
+///Get the counts of commands queued, coalesced and dropped
+void oi_txStats(oi_tx_stats_t *stats);
+
+///Wait until every queued command has been sent to the Roomba
+void oi_txFlush(void);
+
 /// \brief Set the LEDS on the Create
 /// \param play_led 0=off, 1=on
 /// \param advance_led 0=off, 1=on
@@ -149,6 +265,18 @@ void oi_setLeds(uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint
 void oi_setWheels(int16_t right_wheel, int16_t left_wheel);
 
 
+/// \brief Load a script and play it on the Roomba. Not supported by the Create 2 firmware.
+/// \param script the opcodes of the script
+/// \param length the number of bytes, at most OI_SCRIPT_MAX_BYTES
+/// \return 1, or 0 if it is too long or could not be queued
+int oi_scriptRun(const uint8_t script[], int length);
+
+/// \brief Drive the wheels until the Roomba has gone a distance (negative for backward), then stop
+int oi_scriptDistance(int16_t right_wheel, int16_t left_wheel, int16_t millimeters);
+
+/// \brief Drive the wheels until the Roomba has turned an angle (positive for counterclockwise), then stop
+int oi_scriptAngle(int16_t right_wheel, int16_t left_wheel, int16_t degrees);
+
 /// \brief Load song sequence
 /// \param An integer value from 0 - 15 that acts as a label for note sequence
 /// \param An integer value from 1 - 16 indicating the number of notes in the sequence
@@ -172,7 +300,4 @@ void oi_shutoff_init(void);
 //used to handle interrupt to shut off OI
 void GPIOF_Handler(void);
 
-//used to get the current moved degrees from encoder count
-int getDegrees(oi_t *self);
-
 #endif /* OPEN_INTERFACE_H_ */
@@ -1,235 +1,374 @@
-/**
- * @file ping.c
- * @brief This file contains the source code for finding the distance from the ping sensor.
- *
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- *
- * @date 4/12/2018
- */
-
-#include "Timer.h"
-#include "lcd.h"
-#include <stdbool.h>
-#include "driverlib/interrupt.h"
-#include <math.h>
-
-// Stores the last event time
-volatile double last_event_time;
-// Stores the states of the wave
-volatile enum{LOW, HIGH, DONE} state;
-// start time of the return pulse
-volatile unsigned rising_time;
-// end time of the return pulse
-volatile unsigned falling_time;
-// Stores the event time
-volatile int event_time;
-// Stores the edge of the wave
-// 0 is positive edge, 1 is negative edge
-volatile int edge = 0;
-// Stores number of overflows
-volatile int overflows = 0;
-// Stores state of interrupt handle
-volatile int interrupt_occurred = 0;
-
-// Configures and initializes Timer3B
-void timer3_init();
-// Configures and initializes the PING))) sensor
-void ping_init();
-// Timer 3B ISR
-void TIMER3B_Handler(void);
-/* send out a pulse on PB3 */
-void send_pulse();
-/* start and read the ping sensor once, return distance in cm */
-int ping_read();
-/* convert time in clock counts to single-trip distance in cm */
-double cycle2dist(int clock_cycles);
-
-/// Timer 3B ISR
-/** This method is the interrupt handler for timer3.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void TIMER3B_Handler(void)
-{
-
-    // clear the status flag
-    TIMER3_ICR_R |= TIMER_ICR_CBECINT;
-
-    // Determine whether there is a rising or falling edge
-    if (edge == 0) { // && (TIMER3_MIS_R & 0x400) == 1
-        rising_time = TIMER3_TBR_R;
-
-		// Update edge status
-        edge = 1;
-        interrupt_occurred = 0;
-    } else {
-        falling_time = TIMER3_TBR_R;
-
-		// Update edge and interrupt status
-        edge = 0;
-		interrupt_occurred = 1;
-
-    }
-
-}
-
-/// Configures and initializes Timer3B
-/** This method initializes the registers for timer 3 for use by the ping sensor.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void timer3_init() 
-{
-
-    // Turn on clock for timer3
-    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R3;
-
-    // Disable Timer3B before changing settings
-    TIMER3_CTL_R &= ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN);
-
-    // clear the status flag
-    TIMER3_ICR_R |= TIMER_ICR_CBECINT;
-
-	// Split 32 bit timer into 2 16 bit timers
-	TIMER3_CFG_R = TIMER_CFG_16_BIT;
-
-	// Set to edge-time mode and set to capture mode
-	TIMER3_TBMR_R |= TIMER_TBMR_TBMR_CAP;
-	TIMER3_TBMR_R |= TIMER_TBMR_TBCMR;
-
-	// Set timer to trigger on both edges
-	TIMER3_CTL_R |= TIMER_CTL_TBEVENT_BOTH;
-
-    // Load the timer start value
-	TIMER3_TBPR_R = 0xFF;
-	TIMER3_TBILR_R = 0xFFFF;
-
-	// Set interrupt priority
-	NVIC_PRI9_R |= 0x20;
-
-	// Enable the NVIC
-	NVIC_EN1_R |= 0x10;
-
-	// Enable Timer3B
-	TIMER3_CTL_R |= TIMER_CTL_TBEN;
-
-    // Enable interrupts
-    TIMER3_IMR_R |= TIMER_IMR_CBEIM;
-
-	// Register the interrupt
-    IntRegister(INT_TIMER3B, TIMER3B_Handler);
-
-    // Enable master interrupts
-    IntMasterEnable();
-
-}
-
-/// Configures and initializes the PING))) sensor
-/** This method configures the ping sensor.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void ping_init() 
-{
-
-    //enable ADC0 module on port B
-	SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
-
-	// Digital enable port B pin 4
-	GPIO_PORTB_DEN_R |= 0b00001000;
-
-    // set PB3 as input
-    GPIO_PORTB_DIR_R &= 0xF7;
-
-    // Set input capture alternate function
-    GPIO_PORTB_AFSEL_R |= 0x08;
-    GPIO_PORTB_PCTL_R |= 0x00007000;
-
-}
-
-/// Sends out a pulse on PB3
-/** This method sends out a pulse from the ping sensor.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void send_pulse()
-{
-
-    // Disable interrupts
-    TIMER3_IMR_R &= ~TIMER_IMR_CBEIM;
-
-    // clear the status flag
-    TIMER3_ICR_R |= TIMER_ICR_CBECINT;
-
-    // set PB3 as output
-    GPIO_PORTB_DIR_R |= 0x08;
-
-    // Remove the input capture function
-    GPIO_PORTB_AFSEL_R &= 0xF7;
-
-    // set PB3 to high
-    GPIO_PORTB_DATA_R |= 0x08;
-
-    // wait at least 5 microseconds based on data sheet
-    timer_waitMicros(20);
-
-    // set PB3 to low
-    GPIO_PORTB_DATA_R &= 0xF7;
-
-    // set PB3 as input
-    GPIO_PORTB_DIR_R &= 0xF7;
-
-    // Set input capture alternate function
-    GPIO_PORTB_AFSEL_R |= 0x08;
-
-    // clear the status flag
-    TIMER3_ICR_R |= TIMER_ICR_CBECINT; // Remember this
-
-	// Enable interrupts
-	TIMER3_IMR_R |= TIMER_IMR_CBEIM;
-
-}
-
-/// Start and read the ping sensor once, return distance in cm
-/** This method reads the distance value from the ping sensor.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-int ping_read()
-{
-
-	// Send a pulse
-	send_pulse();
-
-	while (interrupt_occurred == 0) {
-
-	}
-
-    // Find the width of the pulse
-	event_time = (rising_time - falling_time);
-
-//	// Check for overflow
-	if (event_time < 0) {
-		event_time = pow(2, 24) + event_time;
-		overflows++;
-	}
-
-	// reset interrupt state
-	interrupt_occurred = 0;
-
-	// return pulse-width time in seconds
-    return event_time;
-
-}
-
-/// convert clock_cycles in clock counts to single-trip distance in cm
-/** This method converts the clock cycles returned from the ping sensor into a distance value.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-double cycle2dist(int clock_cycles) 
-{
-
-    return ((clock_cycles/16000000.0)/2.0) * 34000;
-
-}
+/**
+ * @file ping.c
+ * @brief This file contains the source code for finding the distance from the ping sensor.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/12/2018
+ */
+
+#include "Timer.h"
+#include "lcd.h"
+#include <stdbool.h>
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include <math.h>
+#include "ping.h"
+
+// Stores the last event time
+volatile double last_event_time;
+// Stores the states of the wave
+volatile enum{LOW, HIGH, DONE} state;
+// start time of the return pulse
+volatile unsigned rising_time;
+// end time of the return pulse
+volatile unsigned falling_time;
+// Stores the event time
+volatile int event_time;
+// Stores the edge of the wave
+// 0 is positive edge, 1 is negative edge
+volatile int edge = 0;
+// Stores number of overflows
+volatile int overflows = 0;
+// Stores state of interrupt handle
+volatile int interrupt_occurred = 0;
+// Stores the state of the ping in flight
+static volatile ping_status_t status = PING_IDLE;
+// Stores the function to call when the ping in flight completes
+static ping_callback_t callback = 0;
+
+// Configures and initializes Timer3B
+void timer3_init();
+// Configures and initializes the PING))) sensor
+void ping_init();
+// Timer 3B ISR
+void TIMER3B_Handler(void);
+/* send out a pulse on PB3 */
+void send_pulse();
+/* start and read the ping sensor once, return distance in cm */
+int ping_read();
+/* convert time in clock counts to single-trip distance in cm */
+double cycle2dist(int clock_cycles);
+/* send a pulse without waiting for the echo */
+void ping_start(ping_callback_t on_complete);
+/* state of the last ping */
+ping_status_t ping_status();
+/* width of the last captured echo in clock cycles */
+int ping_cycles();
+/* Timer 3A ISR, ends a ping that got no echo */
+void TIMER3A_Handler(void);
+/* finish the ping in flight and call its callback */
+static void ping_complete(ping_status_t result);
+/* convert time in clock counts to single-trip distance in mm using integer math */
+int ping_cycles_to_mm(int clock_cycles);
+
+/// Timer 3B ISR
+/** This method is the interrupt handler for timer3.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void TIMER3B_Handler(void)
+{
+
+    // clear the status flag
+    TIMER3_ICR_R |= TIMER_ICR_CBECINT;
+
+    // Ignore edges when no ping is waiting for its echo
+    if (status != PING_BUSY) {
+        return;
+    }
+
+    // Determine whether there is a rising or falling edge
+    if (edge == 0) { // && (TIMER3_MIS_R & 0x400) == 1
+        rising_time = TIMER3_TBR_R;
+
+		// Update edge status
+        edge = 1;
+        interrupt_occurred = 0;
+    } else {
+        falling_time = TIMER3_TBR_R;
+
+		// Update edge and interrupt status
+        edge = 0;
+		interrupt_occurred = 1;
+
+        // Find the width of the pulse
+        event_time = (rising_time - falling_time);
+
+        // Check for overflow
+        if (event_time < 0) {
+            event_time = (1 << 24) + event_time;
+            overflows++;
+        }
+
+        ping_complete(PING_DONE);
+    }
+
+}
+
+/// Timer 3A ISR
+/** This method is the interrupt handler for the echo timeout. It ends a ping that got no echo.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/26/2018
+ */
+void TIMER3A_Handler(void)
+{
+
+    // clear the status flag
+    TIMER3_ICR_R = TIMER_ICR_TATOCINT;
+
+    if (status == PING_BUSY) {
+        // Report the farthest distance that could have been measured
+        event_time = PING_TIMEOUT_US * 16;
+        ping_complete(PING_NO_ECHO);
+    }
+
+}
+
+/// Finishes the ping in flight
+/** This method stops the echo timeout, stores the result, and calls the callback given to ping_start.
+ * @param result PING_DONE or PING_NO_ECHO
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/26/2018
+ */
+static void ping_complete(ping_status_t result)
+{
+
+    // Stop the echo timeout
+    TIMER3_CTL_R &= ~TIMER_CTL_TAEN;
+
+    status = result;
+
+    if (callback) {
+        callback(result, event_time);
+    }
+
+}
+
+/// Configures and initializes Timer3B
+/** This method initializes the registers for timer 3 for use by the ping sensor.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void timer3_init() 
+{
+
+    // Turn on clock for timer3
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R3;
+
+    // Disable Timer3B before changing settings
+    TIMER3_CTL_R &= ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN);
+
+    // clear the status flag
+    TIMER3_ICR_R |= TIMER_ICR_CBECINT;
+
+	// Split 32 bit timer into 2 16 bit timers
+	TIMER3_CFG_R = TIMER_CFG_16_BIT;
+
+	// Set to edge-time mode and set to capture mode
+	TIMER3_TBMR_R |= TIMER_TBMR_TBMR_CAP;
+	TIMER3_TBMR_R |= TIMER_TBMR_TBCMR;
+
+	// Set timer to trigger on both edges
+	TIMER3_CTL_R |= TIMER_CTL_TBEVENT_BOTH;
+
+	// Set Timer3A as a one-shot echo timeout with a 1us tick
+	TIMER3_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;
+	TIMER3_TAPR_R = 15;
+	TIMER3_TAILR_R = PING_TIMEOUT_US - 1;
+	TIMER3_ICR_R = TIMER_ICR_TATOCINT;
+	TIMER3_IMR_R |= TIMER_IMR_TATOIM;
+
+    // Load the timer start value
+	TIMER3_TBPR_R = 0xFF;
+	TIMER3_TBILR_R = 0xFFFF;
+
+	// Set interrupt priority
+	NVIC_PRI9_R |= 0x20;
+
+	// Set the echo timeout to the same priority
+	NVIC_PRI8_R = (NVIC_PRI8_R & 0x1FFFFFFF) | 0x20000000;
+
+	// Enable the NVIC for Timer3B (IRQ 36) and Timer3A (IRQ 35)
+	NVIC_EN1_R |= 0x18;
+
+	// Enable Timer3B
+	TIMER3_CTL_R |= TIMER_CTL_TBEN;
+
+    // Enable interrupts
+    TIMER3_IMR_R |= TIMER_IMR_CBEIM;
+
+	// Register the interrupts
+    IntRegister(INT_TIMER3B, TIMER3B_Handler);
+    IntRegister(INT_TIMER3A, TIMER3A_Handler);
+
+    // Enable master interrupts
+    IntMasterEnable();
+
+}
+
+/// Configures and initializes the PING))) sensor
+/** This method configures the ping sensor.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void ping_init() 
+{
+
+    //enable ADC0 module on port B
+	SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
+
+	// Digital enable port B pin 4
+	GPIO_PORTB_DEN_R |= 0b00001000;
+
+    // set PB3 as input
+    GPIO_PORTB_DIR_R &= 0xF7;
+
+    // Set input capture alternate function
+    GPIO_PORTB_AFSEL_R |= 0x08;
+    GPIO_PORTB_PCTL_R |= 0x00007000;
+
+}
+
+/// Sends out a pulse on PB3
+/** This method sends out a pulse from the ping sensor. It can run from the system tick interrupt through
+ * ping_start, so it times the pulse with SysCtlDelay instead of Timer5, which timer_waitMicros uses.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void send_pulse()
+{
+
+    // Disable interrupts
+    TIMER3_IMR_R &= ~TIMER_IMR_CBEIM;
+
+    // clear the status flag
+    TIMER3_ICR_R |= TIMER_ICR_CBECINT;
+
+    // set PB3 as output
+    GPIO_PORTB_DIR_R |= 0x08;
+
+    // Remove the input capture function
+    GPIO_PORTB_AFSEL_R &= 0xF7;
+
+    // set PB3 to high
+    GPIO_PORTB_DATA_R |= 0x08;
+
+    // hold it for PING_TRIGGER_US, SysCtlDelay takes 3 clock cycles per count at 16MHz
+    SysCtlDelay((16 * PING_TRIGGER_US + 2) / 3);
+
+    // set PB3 to low
+    GPIO_PORTB_DATA_R &= 0xF7;
+
+    // set PB3 as input
+    GPIO_PORTB_DIR_R &= 0xF7;
+
+    // Set input capture alternate function
+    GPIO_PORTB_AFSEL_R |= 0x08;
+
+    // clear the status flag
+    TIMER3_ICR_R |= TIMER_ICR_CBECINT; // Remember this
+
+	// Enable interrupts
+	TIMER3_IMR_R |= TIMER_IMR_CBEIM;
+
+}
+
+/// Start and read the ping sensor once, return distance in cm
+/** This method reads the distance value from the ping sensor.
+ * It waits at most PING_TIMEOUT_US for the echo.
+ * @return The width of the echo in clock cycles, or the width of the timeout if there was no echo
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+int ping_read()
+{
+
+	// Send a pulse
+	ping_start(0);
+
+	while (ping_status() == PING_BUSY) {
+
+	}
+
+	// return pulse-width time in seconds
+    return ping_cycles();
+
+}
+
+/// Sends a pulse without waiting for the echo
+/** This method resets the capture state, sends out a pulse, and starts the echo timeout.
+ * The ping completes with PING_DONE when the echo is captured or PING_NO_ECHO after PING_TIMEOUT_US.
+ * @param on_complete Function called from the interrupt when the ping completes, or 0 to poll ping_status instead.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+void ping_start(ping_callback_t on_complete)
+{
+
+	// Start from a rising edge even if the last echo was missed
+	edge = 0;
+	interrupt_occurred = 0;
+	callback = on_complete;
+	status = PING_BUSY;
+
+	// Send a pulse
+	send_pulse();
+
+	// Start the echo timeout
+	TIMER3_ICR_R = TIMER_ICR_TATOCINT;
+	TIMER3_TAILR_R = PING_TIMEOUT_US - 1;
+	TIMER3_CTL_R |= TIMER_CTL_TAEN;
+
+}
+
+/// Returns the state of the last ping
+/** This method lets the caller poll a ping started without a callback.
+ * @return PING_BUSY while waiting for the echo, PING_DONE or PING_NO_ECHO once complete, PING_IDLE before the first ping
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/26/2018
+ */
+ping_status_t ping_status()
+{
+
+	return status;
+
+}
+
+/// Returns the width of the last captured echo
+/** This method returns the echo pulse width once ping_status is no longer PING_BUSY.
+ * @return The width of the echo pulse in clock cycles, or the width of the timeout for PING_NO_ECHO
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+int ping_cycles()
+{
+
+	return event_time;
+
+}
+
+/// convert clock_cycles in clock counts to single-trip distance in cm
+/** This method converts the clock cycles returned from the ping sensor into a distance value.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+double cycle2dist(int clock_cycles) 
+{
+
+    return ((clock_cycles/16000000.0)/2.0) * 34000;
+
+}
+
+/// convert clock_cycles in clock counts to single-trip distance in mm using integer math
+/** This method converts the clock cycles returned from the ping sensor into a distance value without double division.
+ * At 16MHz and 340m/s, one way distance in mm = cycles * 17 / 1600. Echoes are under 2^24 cycles, so the product fits.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/23/2018
+ */
+int ping_cycles_to_mm(int clock_cycles)
+{
+
+    return ((unsigned) clock_cycles * 17 + 800) / 1600;
+
+}
@@ -1,29 +1,61 @@
-/*
- * ping.h
- *
- *  Created on: Mar 3, 2018
- *      Author: mmorth
- */
-
-#ifndef PING_H_
-#define PING_H_
-
-// Configures and initializes Timer3B
-void timer3_init();
-
-// Configures and initializes the PING))) sensor
-void ping_init();
-
-// Timer 3B ISR
-void TIMER3B_Handler(void);
-
-/* send out a pulse on PB3 */
-void send_pulse();
-
-/* start and read the ping sensor once, return distance in cm */
-int ping_read();
-
-/* convert time in clock counts to single-trip distance in cm */
-double cycle2dist(int clock_cycles);
-
-#endif /* PING_H_ */
+/*
+ * ping.h
+ *
+ *  Created on: Mar 3, 2018
+ *      Author: mmorth
+ */
+
+#ifndef PING_H_
+#define PING_H_
+
+// Longest time to wait for an echo. 20ms covers the sensor's 3m range.
+#define PING_TIMEOUT_US 20000
+
+// Width of the trigger pulse send_pulse sends. The sensor needs at least 2us, 5us typical.
+#define PING_TRIGGER_US 20
+
+/// State of a ping
+typedef enum {
+    PING_IDLE,      // No ping has been sent
+    PING_BUSY,      // Waiting for the echo
+    PING_DONE,      // The echo was captured
+    PING_NO_ECHO    // No echo came back before PING_TIMEOUT_US
+} ping_status_t;
+
+/// Function called from the interrupt when a ping completes, with PING_DONE or PING_NO_ECHO and the echo width in clock cycles
+typedef void (*ping_callback_t)(ping_status_t result, int cycles);
+
+// Configures and initializes Timer3B
+void timer3_init();
+
+// Configures and initializes the PING))) sensor
+void ping_init();
+
+// Timer 3B ISR
+void TIMER3B_Handler(void);
+
+/* send out a pulse on PB3 */
+void send_pulse();
+
+/* start and read the ping sensor once, return distance in cm */
+int ping_read();
+
+/* convert time in clock counts to single-trip distance in cm */
+double cycle2dist(int clock_cycles);
+
+/* send a pulse without waiting for the echo; on_complete may be 0 */
+void ping_start(ping_callback_t on_complete);
+
+/* state of the last ping */
+ping_status_t ping_status();
+
+/* Timer 3A ISR, ends a ping that got no echo */
+void TIMER3A_Handler(void);
+
+/* width of the last captured echo in clock cycles */
+int ping_cycles();
+
+/* convert time in clock counts to single-trip distance in mm using integer math */
+int ping_cycles_to_mm(int clock_cycles);
+
+#endif /* PING_H_ */
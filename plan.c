@@ -0,0 +1,615 @@
+/**
+ * @file plan.c
+ * @brief This file contains the source code for planning a path to a goal over the occupancy grid.
+ *
+ * The planner works on cells of PLAN_CELL_MM, coarser than the map. A planning cell is blocked when its middle
+ * is within the Roomba's radius of an occupied map cell, so the path only has to keep the middle of the robot
+ * out of blocked cells. Unknown cells are taken to be clear until a sweep shows otherwise.
+ *
+ * The search is D* Lite: it runs from the goal back toward the robot, and keeps its costs between replans.
+ * When a sweep blocks or clears a few cells, only the costs those cells affect are worked out again,
+ * instead of searching from scratch. Cells waiting to be expanded are kept in a fixed size heap. A cell whose
+ * key changes is added again instead of being moved, and the old entry is skipped when it comes out.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/6/2018
+ */
+
+#include "plan.h"
+
+// Cost of a cell that has no path to the goal
+#define PLAN_INFINITY 0xFFFF
+
+/// A cell waiting to be expanded
+typedef struct {
+    uint32_t key1;  // Cost through the cell to the robot, plus the distance the robot has moved
+    uint16_t key2;  // Cost from the cell to the goal, to break ties
+    uint16_t cell;  // Cell index
+} heap_entry_t;
+
+// Statistics of the last replan
+plan_stats_t plan_stats;
+
+// Waypoints of the last path found, ending at the goal
+plan_waypoint_t plan_waypoints[PLAN_MAX_WAYPOINTS];
+
+static uint16_t cost_to_goal[PLAN_CELLS]; // g: cost to the goal as of the last expansion of each cell
+static uint16_t lookahead[PLAN_CELLS];    // rhs: best cost to the goal through the neighbours
+static uint8_t blocked[(PLAN_CELLS + 7) / 8]; // One bit for each blocked cell, as of the last replan
+
+static heap_entry_t heap[PLAN_HEAP_SIZE];
+static int heap_count = 0;
+static int heap_overflow = 0;
+
+static int goal_cell = -1;      // Cell of the goal, or -1 without a goal
+static int start_cell = -1;     // Cell of the robot at the last replan, or -1 before the first replan
+static uint32_t moved = 0;      // km: sum of the heuristic distances the robot moved between replans
+
+// The 8 neighbours of a cell
+static const int8_t step_x[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int8_t step_y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+/// Returns 1 if a cell is blocked
+/** @param x The column.
+ * @param y The row.
+ * @return 1 if the cell is blocked or off the map
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+int plan_blocked(int x, int y)
+{
+
+    if (x < 0 || y < 0 || x >= PLAN_WIDTH || y >= PLAN_HEIGHT) {
+        return 1;
+    }
+    int cell = y * PLAN_WIDTH + x;
+    return (blocked[cell >> 3] >> (cell & 7)) & 1;
+
+}
+
+/// Returns the distance between two cells if nothing were in the way
+/** @param a The first cell.
+ * @param b The second cell.
+ * @return The cost of the shortest path of straight and diagonal moves
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static int heuristic(int a, int b)
+{
+
+    int dx = a % PLAN_WIDTH - b % PLAN_WIDTH;
+    int dy = a / PLAN_WIDTH - b / PLAN_WIDTH;
+
+    if (dx < 0) {
+        dx = -dx;
+    }
+    if (dy < 0) {
+        dy = -dy;
+    }
+    return (dx < dy) ? PLAN_COST_DIAGONAL * dx + PLAN_COST_STRAIGHT * (dy - dx)
+                     : PLAN_COST_DIAGONAL * dy + PLAN_COST_STRAIGHT * (dx - dy);
+
+}
+
+/// Returns the cost of moving from a cell to one of its neighbours
+/** A move into a blocked cell cannot be made. Neither can a diagonal move past the corner of a blocked cell.
+ * Moves out of a blocked cell can, so the robot can still leave a cell it is too close to.
+ * @param cell The cell to move from.
+ * @param direction The index of the neighbour in step_x and step_y.
+ * @return The cost, or PLAN_INFINITY if the move cannot be made
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static int move_cost(int cell, int direction)
+{
+
+    int x = cell % PLAN_WIDTH;
+    int y = cell / PLAN_WIDTH;
+    int dx = step_x[direction];
+    int dy = step_y[direction];
+
+    if (plan_blocked(x + dx, y + dy)) {
+        return PLAN_INFINITY;
+    }
+    if (dx != 0 && dy != 0) {
+        if (plan_blocked(x + dx, y) || plan_blocked(x, y + dy)) {
+            return PLAN_INFINITY;
+        }
+        return PLAN_COST_DIAGONAL;
+    }
+    return PLAN_COST_STRAIGHT;
+
+}
+
+/// Works out the key a cell should be expanded in
+/** @param cell The cell.
+ * @return The key, ordered by key1 and then key2
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static heap_entry_t make_key(int cell)
+{
+
+    heap_entry_t entry;
+    uint16_t best = cost_to_goal[cell] < lookahead[cell] ? cost_to_goal[cell] : lookahead[cell];
+
+    entry.key1 = (uint32_t) best + heuristic(start_cell, cell) + moved;
+    entry.key2 = best;
+    entry.cell = cell;
+    return entry;
+
+}
+
+/// Returns 1 if key a comes before key b
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static int key_less(const heap_entry_t *a, const heap_entry_t *b)
+{
+
+    return a->key1 < b->key1 || (a->key1 == b->key1 && a->key2 < b->key2);
+
+}
+
+/// Moves the entry at index up the heap to where it belongs
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void sift_up(int index)
+{
+
+    heap_entry_t entry = heap[index];
+
+    while (index > 0 && key_less(&entry, &heap[(index - 1) / 2])) {
+        heap[index] = heap[(index - 1) / 2];
+        index = (index - 1) / 2;
+    }
+    heap[index] = entry;
+
+}
+
+/// Moves the entry at index down the heap to where it belongs
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void sift_down(int index)
+{
+
+    heap_entry_t entry = heap[index];
+
+    while (2 * index + 1 < heap_count) {
+        int child = 2 * index + 1;
+        if (child + 1 < heap_count && key_less(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!key_less(&heap[child], &entry)) {
+            break;
+        }
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = entry;
+
+}
+
+/// Makes room in a full heap
+/** This method drops the entries of cells that no longer need expanding and all but one entry of each other cell,
+ * with its key worked out again, then puts the heap back in order.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void heap_compact(void)
+{
+
+    uint8_t kept[(PLAN_CELLS + 7) / 8] = { 0 };
+    int count = 0;
+    int i;
+
+    for (i = 0; i < heap_count; i++) {
+        int cell = heap[i].cell;
+        if (cost_to_goal[cell] == lookahead[cell] || (kept[cell >> 3] & (1 << (cell & 7)))) {
+            continue;
+        }
+        kept[cell >> 3] |= 1 << (cell & 7);
+        heap[count++] = make_key(cell);
+    }
+
+    heap_count = count;
+    for (i = heap_count / 2 - 1; i >= 0; i--) {
+        sift_down(i);
+    }
+
+}
+
+/// Adds a cell to the heap
+/** If the heap is full, it is compacted first. If it is still full, the cell is dropped and the search fails.
+ * @param entry The cell and its key.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void heap_push(heap_entry_t entry)
+{
+
+    if (heap_count == PLAN_HEAP_SIZE) {
+        heap_compact();
+        if (heap_count == PLAN_HEAP_SIZE) {
+            heap_overflow = 1;
+            return;
+        }
+    }
+
+    heap[heap_count++] = entry;
+    sift_up(heap_count - 1);
+    if (heap_count > plan_stats.heap_high) {
+        plan_stats.heap_high = heap_count;
+    }
+
+}
+
+/// Removes the first cell from the heap
+/** @return The entry of the cell with the lowest key
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static heap_entry_t heap_pop(void)
+{
+
+    heap_entry_t top = heap[0];
+
+    heap[0] = heap[--heap_count];
+    if (heap_count > 0) {
+        sift_down(0);
+    }
+    return top;
+
+}
+
+/// Works out the best cost of a cell through its neighbours
+/** This method sets the lookahead cost of the cell from its neighbours, and queues the cell to be expanded
+ * if it no longer matches its cost.
+ * @param cell The cell.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void update_cell(int cell)
+{
+
+    int direction;
+
+    if (cell != goal_cell) {
+        int best = PLAN_INFINITY;
+        int x = cell % PLAN_WIDTH;
+        int y = cell / PLAN_WIDTH;
+
+        for (direction = 0; direction < 8; direction++) {
+            int cost = move_cost(cell, direction);
+            if (cost == PLAN_INFINITY) {
+                continue;
+            }
+            int next = (y + step_y[direction]) * PLAN_WIDTH + x + step_x[direction];
+            if (cost_to_goal[next] != PLAN_INFINITY && cost_to_goal[next] + cost < best) {
+                best = cost_to_goal[next] + cost;
+            }
+        }
+        lookahead[cell] = best;
+    }
+
+    if (cost_to_goal[cell] != lookahead[cell]) {
+        heap_push(make_key(cell));
+    }
+
+}
+
+/// Updates every neighbour of a cell
+/** @param cell The cell.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void update_neighbours(int cell)
+{
+
+    int x = cell % PLAN_WIDTH;
+    int y = cell / PLAN_WIDTH;
+    int direction;
+
+    for (direction = 0; direction < 8; direction++) {
+        int nx = x + step_x[direction];
+        int ny = y + step_y[direction];
+        if (nx >= 0 && ny >= 0 && nx < PLAN_WIDTH && ny < PLAN_HEIGHT) {
+            update_cell(ny * PLAN_WIDTH + nx);
+        }
+    }
+
+}
+
+/// Expands cells until the cost of the robot's cell is known
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void compute_path(void)
+{
+
+    while (heap_count > 0 && !heap_overflow) {
+        heap_entry_t start_key = make_key(start_cell);
+        if (!key_less(&heap[0], &start_key) && lookahead[start_cell] == cost_to_goal[start_cell]) {
+            break;
+        }
+
+        heap_entry_t top = heap_pop();
+        int cell = top.cell;
+
+        // Skip entries of cells that were expanded since, or that were added again with a new key
+        if (cost_to_goal[cell] == lookahead[cell]) {
+            continue;
+        }
+        heap_entry_t key = make_key(cell);
+        if (key_less(&top, &key)) {
+            heap_push(key);
+            continue;
+        }
+        if (key_less(&key, &top)) {
+            continue;
+        }
+
+        plan_stats.expanded++;
+        if (cost_to_goal[cell] > lookahead[cell]) {
+            cost_to_goal[cell] = lookahead[cell];
+        } else {
+            cost_to_goal[cell] = PLAN_INFINITY;
+            update_cell(cell);
+        }
+        update_neighbours(cell);
+    }
+
+}
+
+/// Reads the map for planning cells that became blocked or clear
+/** This method blocks every planning cell whose middle is within PLAN_ROBOT_RADIUS_MM of the middle of an
+ * occupied map cell, and updates the neighbours of each cell that changed.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static void read_map(void)
+{
+
+    uint8_t now_blocked[(PLAN_CELLS + 7) / 8] = { 0 };
+    const int reach = PLAN_ROBOT_RADIUS_MM + GRID_CELL_MM / 2;
+    int map_x, map_y, x, y, cell;
+
+    for (map_y = 0; map_y < GRID_HEIGHT; map_y++) {
+        for (map_x = 0; map_x < GRID_WIDTH; map_x++) {
+            if (grid_state(map_x, map_y) != GRID_OCCUPIED) {
+                continue;
+            }
+
+            // Middle of the map cell in mm from the lower left corner
+            int mx = map_x * GRID_CELL_MM + GRID_CELL_MM / 2;
+            int my = map_y * GRID_CELL_MM + GRID_CELL_MM / 2;
+
+            for (y = (my - reach) / PLAN_CELL_MM; y <= (my + reach) / PLAN_CELL_MM; y++) {
+                for (x = (mx - reach) / PLAN_CELL_MM; x <= (mx + reach) / PLAN_CELL_MM; x++) {
+                    if (x < 0 || y < 0 || x >= PLAN_WIDTH || y >= PLAN_HEIGHT) {
+                        continue;
+                    }
+                    int dx = x * PLAN_CELL_MM + PLAN_CELL_MM / 2 - mx;
+                    int dy = y * PLAN_CELL_MM + PLAN_CELL_MM / 2 - my;
+                    if (dx * dx + dy * dy <= reach * reach) {
+                        cell = y * PLAN_WIDTH + x;
+                        now_blocked[cell >> 3] |= 1 << (cell & 7);
+                    }
+                }
+            }
+        }
+    }
+
+    for (cell = 0; cell < PLAN_CELLS; cell++) {
+        if (((now_blocked[cell >> 3] ^ blocked[cell >> 3]) >> (cell & 7)) & 1) {
+            blocked[cell >> 3] ^= 1 << (cell & 7);
+            plan_stats.changed++;
+            update_neighbours(cell);
+        }
+    }
+
+}
+
+/// Returns the planning cell of a point
+/** @param x_mm The distance forward of the starting pose in mm.
+ * @param y_mm The distance left of the starting pose in mm.
+ * @return The cell index, or -1 if the point is off the map
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static int plan_index(int x_mm, int y_mm)
+{
+
+    int x = x_mm + GRID_ORIGIN_X_MM;
+    int y = y_mm + GRID_ORIGIN_Y_MM;
+
+    if (x < 0 || y < 0 || x >= PLAN_WIDTH * PLAN_CELL_MM || y >= PLAN_HEIGHT * PLAN_CELL_MM) {
+        return -1;
+    }
+    return (y / PLAN_CELL_MM) * PLAN_WIDTH + x / PLAN_CELL_MM;
+
+}
+
+/// Adds the middle of a cell to the waypoints
+/** @param cell The cell.
+ * @return 1 if it fit, 0 if the waypoints are full
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static int add_waypoint(int cell)
+{
+
+    if (plan_stats.waypoints == PLAN_MAX_WAYPOINTS) {
+        return 0;
+    }
+    plan_waypoints[plan_stats.waypoints].x_mm = (cell % PLAN_WIDTH) * PLAN_CELL_MM + PLAN_CELL_MM / 2 - GRID_ORIGIN_X_MM;
+    plan_waypoints[plan_stats.waypoints].y_mm = (cell / PLAN_WIDTH) * PLAN_CELL_MM + PLAN_CELL_MM / 2 - GRID_ORIGIN_Y_MM;
+    plan_stats.waypoints++;
+    return 1;
+
+}
+
+/// Follows the costs from the robot to the goal
+/** This method steps to the neighbour with the lowest cost to the goal, keeping the same direction on a tie,
+ * and adds a waypoint wherever the direction changes.
+ * @return PLAN_OK, or PLAN_FULL if the path turns more often than the waypoints can hold
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+static int follow_path(void)
+{
+
+    int cell = start_cell;
+    int heading = -1;
+    int steps;
+
+    for (steps = 0; cell != goal_cell && steps < PLAN_CELLS; steps++) {
+        int best = PLAN_INFINITY;
+        int best_direction = -1;
+        int direction;
+
+        for (direction = 0; direction < 8; direction++) {
+            int cost = move_cost(cell, direction);
+            int next = cell + step_y[direction] * PLAN_WIDTH + step_x[direction];
+            if (cost == PLAN_INFINITY || cost_to_goal[next] == PLAN_INFINITY) {
+                continue;
+            }
+            cost += cost_to_goal[next];
+            if (cost < best || (cost == best && direction == heading)) {
+                best = cost;
+                best_direction = direction;
+            }
+        }
+
+        if (best_direction < 0) {
+            return PLAN_NO_PATH;
+        }
+        if (heading >= 0 && best_direction != heading && !add_waypoint(cell)) {
+            return PLAN_FULL;
+        }
+        heading = best_direction;
+        cell += step_y[heading] * PLAN_WIDTH + step_x[heading];
+    }
+
+    if (cell != goal_cell || !add_waypoint(goal_cell)) {
+        return (cell != goal_cell) ? PLAN_NO_PATH : PLAN_FULL;
+    }
+    return PLAN_OK;
+
+}
+
+/// Starts planning toward a new goal
+/** This method forgets the last search. The first replan after it searches from scratch.
+ * @param x_mm The goal in mm forward of the starting pose.
+ * @param y_mm The goal in mm left of the starting pose.
+ * @return PLAN_OK, or PLAN_OFF_GRID if the goal is off the map
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+int plan_set_goal(int x_mm, int y_mm)
+{
+
+    int cell;
+
+    goal_cell = plan_index(x_mm, y_mm);
+    if (goal_cell < 0) {
+        return PLAN_OFF_GRID;
+    }
+
+    for (cell = 0; cell < PLAN_CELLS; cell++) {
+        cost_to_goal[cell] = PLAN_INFINITY;
+        lookahead[cell] = PLAN_INFINITY;
+    }
+    for (cell = 0; cell < (PLAN_CELLS + 7) / 8; cell++) {
+        blocked[cell] = 0;
+    }
+    lookahead[goal_cell] = 0;
+    heap_count = 0;
+    heap_overflow = 0;
+    start_cell = -1;
+    moved = 0;
+    return PLAN_OK;
+
+}
+
+/// Returns 1 if a goal is set
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+int plan_has_goal(void)
+{
+
+    return goal_cell >= 0;
+
+}
+
+/// Forgets the goal
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+void plan_clear(void)
+{
+
+    goal_cell = -1;
+
+}
+
+/// Finds the path from the robot to the goal
+/** This method reads the map for cells that changed since the last replan and expands only the cells whose
+ * costs they affect, then follows the costs from the robot's cell to make the waypoints.
+ * If the heap overflows, the goal is set again so the next replan starts from scratch.
+ * @param x_mm The robot in mm forward of the starting pose.
+ * @param y_mm The robot in mm left of the starting pose.
+ * @return PLAN_OK with the path in plan_waypoints, or one of the errors
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/6/2018
+ */
+int plan_replan(int x_mm, int y_mm)
+{
+
+    int cell = plan_index(x_mm, y_mm);
+
+    plan_stats.expanded = 0;
+    plan_stats.changed = 0;
+    plan_stats.heap_high = heap_count;
+    plan_stats.waypoints = 0;
+
+    if (goal_cell < 0) {
+        plan_stats.result = PLAN_NO_GOAL;
+        return PLAN_NO_GOAL;
+    }
+    if (cell < 0) {
+        plan_stats.result = PLAN_OFF_GRID;
+        return PLAN_OFF_GRID;
+    }
+
+    if (start_cell < 0) {
+        // First replan toward this goal: the search starts at the goal
+        start_cell = cell;
+        heap_push(make_key(goal_cell));
+    } else {
+        // The keys already queued are low by how far the robot moved, so the ones added from now on are raised to match
+        moved += heuristic(start_cell, cell);
+        start_cell = cell;
+    }
+
+    read_map();
+    compute_path();
+
+    if (heap_overflow) {
+        int goal_x = (goal_cell % PLAN_WIDTH) * PLAN_CELL_MM + PLAN_CELL_MM / 2 - GRID_ORIGIN_X_MM;
+        int goal_y = (goal_cell / PLAN_WIDTH) * PLAN_CELL_MM + PLAN_CELL_MM / 2 - GRID_ORIGIN_Y_MM;
+        plan_set_goal(goal_x, goal_y);
+        plan_stats.result = PLAN_FULL;
+    } else if (cost_to_goal[start_cell] == PLAN_INFINITY) {
+        plan_stats.result = PLAN_NO_PATH;
+    } else {
+        plan_stats.result = follow_path();
+    }
+
+    return plan_stats.result;
+
+}
@@ -0,0 +1,77 @@
+/*
+ * plan.h
+ *
+ *  Created on: May 6, 2018
+ *      Author: mmorth
+ */
+
+#ifndef PLAN_H_
+#define PLAN_H_
+
+#include <stdint.h>
+#include "grid.h"
+
+// Size of each planning cell in mm. Planning cells cover several map cells, over the same area as the map.
+#define PLAN_CELL_MM 100
+#define PLAN_WIDTH (GRID_WIDTH_MM / PLAN_CELL_MM)
+#define PLAN_HEIGHT (GRID_HEIGHT_MM / PLAN_CELL_MM)
+#define PLAN_CELLS (PLAN_WIDTH * PLAN_HEIGHT)
+
+// Radius of the Roomba in mm. Planning cells whose middle is this close to an occupied map cell are blocked.
+#define PLAN_ROBOT_RADIUS_MM 170
+
+// Cost of moving to a side and to a corner planning cell
+#define PLAN_COST_STRAIGHT 10
+#define PLAN_COST_DIAGONAL 14
+
+// Most cells waiting to be expanded. Each takes 8 bytes.
+#define PLAN_HEAP_SIZE 512
+
+// Most waypoints in a path, including the goal
+#define PLAN_MAX_WAYPOINTS 32
+
+// Results of plan_replan
+#define PLAN_OK 0
+#define PLAN_NO_PATH -1     // The goal cannot be reached
+#define PLAN_FULL -2        // More cells were waiting to be expanded than fit in the heap, or more waypoints than fit
+#define PLAN_OFF_GRID -3    // The robot or the goal is off the map
+#define PLAN_NO_GOAL -4     // plan_set_goal has not been called
+
+/// A point on the path in mm from the starting pose
+typedef struct {
+    int x_mm;
+    int y_mm;
+} plan_waypoint_t;
+
+/// Work done by the last replan
+typedef struct {
+    int expanded;   // Cells expanded
+    int changed;    // Planning cells that became blocked or clear since the last replan
+    int heap_high;  // Most cells waiting to be expanded at once
+    int waypoints;  // Waypoints in the path
+    int result;     // PLAN_OK or the reason there is no path
+} plan_stats_t;
+
+// Statistics of the last replan
+extern plan_stats_t plan_stats;
+
+// Waypoints of the last path found, ending at the goal
+extern plan_waypoint_t plan_waypoints[PLAN_MAX_WAYPOINTS];
+
+// Starts planning toward a new goal in mm from the starting pose, forgetting the last search
+int plan_set_goal(int x_mm, int y_mm);
+
+// Returns 1 if a goal is set
+int plan_has_goal(void);
+
+// Forgets the goal
+void plan_clear(void);
+
+// Reads the map for changes and finds the path from the robot's position to the goal, reusing the last search.
+// Returns PLAN_OK and fills in plan_waypoints, or one of the errors.
+int plan_replan(int x_mm, int y_mm);
+
+// Returns 1 if the planning cell at column x and row y is blocked
+int plan_blocked(int x, int y);
+
+#endif /* PLAN_H_ */
@@ -0,0 +1,130 @@
+/**
+ * @file profile.c
+ * @brief This file contains the source code for the trapezoidal velocity profiles of straight moves.
+ *
+ * A profile speeds the wheels up from a minimum speed at a fixed acceleration, cruises, and slows down
+ * so the speed reaches the minimum just as the robot reaches the target. The speed is worked out again
+ * from the distance left on every odometry frame, so slip or a late frame is made up on the way.
+ * Everything is integer math so it can run from the system tick, and it has no hardware dependencies
+ * so the host simulation in tools can use it too.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/4/2018
+ */
+
+#include "profile.h"
+
+/// Returns the integer square root
+/** This method finds the square root one bit at a time.
+ * @param value The number to take the square root of.
+ * @return The square root, rounded down.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/4/2018
+ */
+uint32_t profile_isqrt(uint32_t value)
+{
+
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+
+}
+
+/// Plans a straight move
+/** This method fills in the profile. A cruise speed below the minimum speed is raised to it.
+ * @param profile The profile to fill in.
+ * @param distance The millimeters to go. The sign is ignored.
+ * @param cruise The top speed in mm/s.
+ * @param accel The acceleration and deceleration in mm/s^2.
+ * @param min_speed The speed to start from and finish at in mm/s.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/4/2018
+ */
+void profile_plan(profile_t *profile, int distance, int cruise, int accel, int min_speed)
+{
+
+    profile->distance = (distance < 0) ? -distance : distance;
+    profile->cruise = (cruise < min_speed) ? min_speed : cruise;
+    profile->accel = accel;
+    profile->min_speed = min_speed;
+
+}
+
+/// Returns the speed to drive at
+/** This method takes the slowest of the cruise speed, the speed reached by accelerating since the start,
+ * and the speed that can still slow to the minimum over the distance left (v^2 = min^2 + 2ad).
+ * @param profile The planned move.
+ * @param travelled The millimeters travelled so far. The sign is ignored.
+ * @param elapsed_ms The milliseconds since the move started.
+ * @return The speed in mm/s, or 0 once the target is reached.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/4/2018
+ */
+int profile_speed(const profile_t *profile, int travelled, uint32_t elapsed_ms)
+{
+
+    int remaining = profile->distance - ((travelled < 0) ? -travelled : travelled);
+    if (remaining <= 0) {
+        return 0;
+    }
+
+    uint32_t speed = profile->cruise;
+
+    // Speeding up
+    uint32_t up = profile->min_speed + (uint32_t) profile->accel * elapsed_ms / 1000;
+    if (up < speed) {
+        speed = up;
+    }
+
+    // Slowing down
+    uint32_t min = profile->min_speed;
+    uint32_t down = profile_isqrt(min * min + 2 * (uint32_t) profile->accel * remaining);
+    if (down < speed) {
+        speed = down;
+    }
+
+    return speed;
+
+}
+
+/// Returns the planned time of the move
+/** This method adds the time to speed up, cruise, and slow down. A move too short to reach the cruise speed
+ * turns around at the speed where the two ramps meet.
+ * @param profile The planned move.
+ * @return The time in milliseconds.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/4/2018
+ */
+uint32_t profile_time_ms(const profile_t *profile)
+{
+
+    uint32_t min = profile->min_speed;
+    uint32_t cruise = profile->cruise;
+    uint32_t accel = profile->accel;
+
+    // Distance covered by each ramp
+    uint32_t ramp = (cruise * cruise - min * min) / (2 * accel);
+
+    if (2 * ramp <= (uint32_t) profile->distance) {
+        return 2000 * (cruise - min) / accel + 1000 * (profile->distance - 2 * ramp) / cruise;
+    }
+
+    uint32_t peak = profile_isqrt(min * min + accel * profile->distance);
+    return 2000 * (peak - min) / accel;
+
+}
@@ -0,0 +1,39 @@
+/*
+ * profile.h
+ *
+ *  Created on: May 4, 2018
+ *      Author: mmorth
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+
+// Acceleration and deceleration in mm/s^2 the wheels can take without slipping
+#define PROFILE_ACCEL 400
+
+// Speed in mm/s a profile starts from and finishes at. Slower than this the wheels may not turn.
+#define PROFILE_MIN_SPEED 40
+
+/// Plan of a straight move that speeds up, cruises, and slows down to stop on the target
+typedef struct {
+    int distance;  // Millimeters to go, never negative
+    int cruise;    // Top speed in mm/s
+    int accel;     // Acceleration and deceleration in mm/s^2
+    int min_speed; // Speed to start from and finish at in mm/s
+} profile_t;
+
+// Plans a move of distance millimeters with a top speed of cruise mm/s
+void profile_plan(profile_t *profile, int distance, int cruise, int accel, int min_speed);
+
+// Returns the speed in mm/s to drive at after travelling travelled millimeters in elapsed_ms, or 0 once there
+int profile_speed(const profile_t *profile, int travelled, uint32_t elapsed_ms);
+
+// Returns the time in milliseconds the planned move should take
+uint32_t profile_time_ms(const profile_t *profile);
+
+// Returns the integer square root of value, rounded down
+uint32_t profile_isqrt(uint32_t value);
+
+#endif /* PROFILE_H_ */
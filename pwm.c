@@ -1,114 +1,254 @@
-/**
- * @file pwm.c
- * @brief This file contains the source code for using pwm with the servo.
- *
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- *
- * @date 4/12/2018
- */
-
-#include "Timer.h"
-#include "lcd.h"
-// #include "button.h"
-#include <stdbool.h>
-#include "driverlib/interrupt.h"
-#include <math.h>
-// CYBOT 7
-
-unsigned pulse_period = 320000; //  pulse period in cycles
-unsigned mid_width = 304000; // Mid width compare in cycles
-int angle = 90; // Stores the initial degree value for the servo motor
-unsigned pulse_width = 0; // Stores the value of the pulse length
-int direction = 1; // Stores the direction of the servo. 0 is left. 1 is right.
-
-/// Initializes timer1
-/** This method initializes timer 1 for pwm.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void timer1_init()
-{
-
-    //turn on clk for timer1
-    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
-
-    // TIMER CONFIGURATION
-    //disable timer to config
-    TIMER1_CTL_R &= ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN);
-
-    //set size of timer to 16
-    TIMER1_CFG_R = TIMER_CFG_16_BIT;
-
-    //periodic and PWM enable
-    TIMER1_TBMR_R |= (TIMER_TBMR_TBAMS | TIMER_TBMR_TBMR_PERIOD);
-    TIMER1_TBMR_R &= ~TIMER_TBMR_TBCMR;
-
-    // Need to set TBPWML field of GTPMCTL to inverted? Don't think so.
-
-    // Set the maximum value of the counter
-    TIMER1_TBILR_R = pulse_period & 0xFFFF;
-
-    //lower 16 bits of the interval
-    TIMER1_TBPR_R =  pulse_period >> 16;
-
-    // Set the match values
-    TIMER1_TBMATCHR_R = (pulse_period - 16000) & 0xFFFF;
-    TIMER1_TBPMR_R = (pulse_period - 16000) >> 16;
-
-    //enable timer
-    TIMER1_CTL_R |= TIMER_CTL_TBEN;
-
-}
-
-/// Initializes the GPIO
-/** This method initializes the gpio pins for pwm use.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void gpio_init() 
-{
-
-    //***set GPIO PB5, turn on clk, alt. function, output, enable***
-    // GPIO CONFIGURATION
-    //enable clock for port B
-    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
-
-    // Digital enable port B pin 5
-    GPIO_PORTB_DEN_R |= 0b00100000;
-
-    // set PB5 as output
-    GPIO_PORTB_DIR_R |= 0x20;
-
-    // Set output capture alternate function
-    GPIO_PORTB_AFSEL_R |= 0x20;
-    GPIO_PORTB_PCTL_R |= 0x00700000;
-
-}
-
-/// Move the servo to a certain degree measurement
-/** This method moves the servo to a given dgree value.
- * @param degree The degree location to move the servo to.
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- * @date 4/12/2018
- */
-void move_servo(int degree)
-{
-
-    // Calibrated width
-    int calibrated_width = ((35866-8488)*(degree/180.0)) + 8488;
-
-    pulse_width = calibrated_width;
-
-    mid_width = pulse_period - calibrated_width;
-
-    // Set the match values
-    TIMER1_TBMATCHR_R = mid_width & 0xFFFF;
-    TIMER1_TBPMR_R = mid_width >> 16;
-
-    // Store the current angle value
-    angle = degree;
-
-    // Enorce delay for servo to move to position
-    timer_waitMillis(50);
-
-}
+/**
+ * @file pwm.c
+ * @brief This file contains the source code for using pwm with the servo.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/12/2018
+ */
+
+#include "Timer.h"
+#include "lcd.h"
+// #include "button.h"
+#include <stdbool.h>
+#include "driverlib/interrupt.h"
+#include <math.h>
+#include <stdlib.h>
+#include "distance.h"
+#include "pwm.h"
+#include "sched.h"
+// CYBOT 7
+
+unsigned pulse_period = 320000; //  pulse period in cycles
+unsigned mid_width = 304000; // Mid width compare in cycles
+int angle = 90; // Stores the initial degree value for the servo motor
+unsigned pulse_width = 0; // Stores the value of the pulse length
+int direction = 1; // Stores the direction of the next sweep. 1 sweeps 0 to 180. 0 sweeps 180 to 0.
+int servo_us_per_degree = SERVO_DEFAULT_US_PER_DEGREE; // Stores the time the servo takes to turn one degree
+int servo_position_known = 0; // Stores whether the servo has been moved since power up
+static uint32_t servo_arrive_ms = 0; // Stores the tick count when the servo reaches angle
+
+/// Initializes timer1
+/** This method initializes timer 1 for pwm.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void timer1_init()
+{
+
+    //turn on clk for timer1
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+
+    // TIMER CONFIGURATION
+    //disable timer to config
+    TIMER1_CTL_R &= ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN);
+
+    //set size of timer to 16
+    TIMER1_CFG_R = TIMER_CFG_16_BIT;
+
+    //periodic and PWM enable
+    TIMER1_TBMR_R |= (TIMER_TBMR_TBAMS | TIMER_TBMR_TBMR_PERIOD);
+    TIMER1_TBMR_R &= ~TIMER_TBMR_TBCMR;
+
+    // Need to set TBPWML field of GTPMCTL to inverted? Don't think so.
+
+    // Set the maximum value of the counter
+    TIMER1_TBILR_R = pulse_period & 0xFFFF;
+
+    //lower 16 bits of the interval
+    TIMER1_TBPR_R =  pulse_period >> 16;
+
+    // Set the match values
+    TIMER1_TBMATCHR_R = (pulse_period - 16000) & 0xFFFF;
+    TIMER1_TBPMR_R = (pulse_period - 16000) >> 16;
+
+    //enable timer
+    TIMER1_CTL_R |= TIMER_CTL_TBEN;
+
+}
+
+/// Initializes the GPIO
+/** This method initializes the gpio pins for pwm use.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void gpio_init() 
+{
+
+    //***set GPIO PB5, turn on clk, alt. function, output, enable***
+    // GPIO CONFIGURATION
+    //enable clock for port B
+    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
+
+    // Digital enable port B pin 5
+    GPIO_PORTB_DEN_R |= 0b00100000;
+
+    // set PB5 as output
+    GPIO_PORTB_DIR_R |= 0x20;
+
+    // Set output capture alternate function
+    GPIO_PORTB_AFSEL_R |= 0x20;
+    GPIO_PORTB_PCTL_R |= 0x00700000;
+
+}
+
+/// Move the servo to a certain degree measurement
+/** This method moves the servo to a given dgree value.
+ * @param degree The degree location to move the servo to.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/12/2018
+ */
+void move_servo(int degree)
+{
+
+    // Enorce delay for servo to move to position, running the other tasks meanwhile
+    sched_sleep(servo_start(degree));
+
+}
+
+/// Starts the servo toward a degree measurement
+/** This method commands the new position without waiting and returns how long the servo needs to get there.
+ * @param degree The degree location to move the servo to.
+ * @return The number of milliseconds until the servo is in position
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+int servo_start(int degree)
+{
+
+    // Find how long the servo needs to get there. Until the first move the servo could be anywhere.
+    int wait = servo_settle_ms(angle, degree);
+    if (!servo_position_known) {
+        wait = servo_settle_ms(0, 180);
+        servo_position_known = 1;
+    }
+
+    // A servo still on its way to the last position has that far to go as well
+    wait += servo_left_ms();
+
+    // Command the new position
+    servo_set(degree);
+    servo_arrive_ms = timer_getMillis() + wait;
+
+    return wait;
+
+}
+
+/// Returns the time until the servo reaches the last position started by servo_start
+/** @return The number of milliseconds until the servo is in position, or 0 if it is there
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+int servo_left_ms(void)
+{
+
+    int32_t left = (int32_t) (servo_arrive_ms - timer_getMillis());
+    return (left > 0) ? left : 0;
+
+}
+
+/// Returns the time the servo needs to move between two degree measurements
+/** This method computes the travel time from the calibrated slew rate and adds a settle margin.
+ * @param from The degree location the servo is at.
+ * @param to The degree location the servo is moving to.
+ * @return The number of milliseconds to wait before the servo is in position
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/22/2018
+ */
+int servo_settle_ms(int from, int to)
+{
+
+    int travel_us = abs(to - from) * servo_us_per_degree;
+
+    // Round the travel time up to the next millisecond
+    return (travel_us + 999) / 1000 + SERVO_SETTLE_MARGIN_MS;
+
+}
+
+/// Measures the slew rate of the servo
+/** This method times a full 0 to 180 degree move by watching the IR sensor reach the reading it has at 180 degrees.
+ * Place an object about 20cm from the sensor at 180 degrees and keep the rest of the sweep clear before calling it.
+ * The measured rate is used by move_servo and the sweep from then on.
+ * @return The measured time to turn one degree in microseconds, or 0 if the calibration failed and the old rate was kept
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/22/2018
+ */
+int servo_calibrate()
+{
+
+    // Take a reading at each end with plenty of time to settle
+    servo_set(0);
+    sched_sleep(SERVO_CALIBRATE_WAIT_MS);
+    int at_start = adc_latest();
+
+    servo_set(180);
+    sched_sleep(SERVO_CALIBRATE_WAIT_MS);
+    int at_end = adc_latest();
+
+    servo_set(0);
+    sched_sleep(SERVO_CALIBRATE_WAIT_MS);
+
+    // The object at 180 degrees must stand out from the reading at 0 degrees
+    int tolerance = abs(at_end - at_start) / 4;
+    if (tolerance < SERVO_CALIBRATE_MIN_CONTRAST / 4) {
+        return 0;
+    }
+
+    // Time the move until the reading stays at the 180 degree reading
+    uint32_t start_ms = timer_getMillis();
+    uint32_t now = start_ms;
+    uint32_t arrived_ms = 0;
+    int stable = 0;
+    servo_set(180);
+    while (stable < SERVO_CALIBRATE_STABLE_MS && now - start_ms < SERVO_CALIBRATE_WAIT_MS) {
+        // Sample once per millisecond
+        while (timer_getMillis() == now) {
+
+        }
+        now = timer_getMillis();
+
+        if (abs((int) adc_latest() - at_end) <= tolerance) {
+            if (stable == 0) {
+                arrived_ms = now;
+            }
+            stable++;
+        } else {
+            stable = 0;
+        }
+    }
+
+    if (stable < SERVO_CALIBRATE_STABLE_MS) {
+        return 0;
+    }
+
+    servo_us_per_degree = ((arrived_ms - start_ms) * 1000) / 180;
+
+    return servo_us_per_degree;
+
+}
+
+/// Command the servo to a certain degree measurement without waiting
+/** This method updates the pwm match value for the given degree and returns immediately.
+ * The caller is responsible for giving the servo time to reach the position.
+ * @param degree The degree location to move the servo to.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+void servo_set(int degree)
+{
+
+    // Calibrated width
+    int calibrated_width = ((35866-8488)*(degree/180.0)) + 8488;
+
+    pulse_width = calibrated_width;
+
+    mid_width = pulse_period - calibrated_width;
+
+    // Set the match values
+    TIMER1_TBMATCHR_R = mid_width & 0xFFFF;
+    TIMER1_TBPMR_R = mid_width >> 16;
+
+    // Store the current angle value
+    angle = degree;
+
+}
@@ -1,23 +1,62 @@
-/*
- * pwm.h
- *
- *  Created on: Mar 13, 2018
- *      Author: mmorth
- */
-
-#ifndef PWM_H_
-#define PWM_H_
-
-// Initialize the timer
-void timer1_init();
-
-// Initializes the GPIO
-void gpio_init();
-
-// Move the servo to a certain degree measurement
-void move_servo(unsigned degree);
-
-// Complete a certain servo task based on which button was pressed
-void button_execution(uint8_t button_value);
-
-#endif /* PWM_H_ */
+/*
+ * pwm.h
+ *
+ *  Created on: Mar 13, 2018
+ *      Author: mmorth
+ */
+
+#ifndef PWM_H_
+#define PWM_H_
+
+// Time the servo takes to turn one degree until it is calibrated
+#define SERVO_DEFAULT_US_PER_DEGREE 3400
+
+// Time added to every servo move for the servo to stop oscillating
+#define SERVO_SETTLE_MARGIN_MS 5
+
+// Time given to the servo to reach each end during the calibration
+#define SERVO_CALIBRATE_WAIT_MS 1000
+
+// Smallest difference in IR readings between 0 and 180 degrees the calibration can time
+#define SERVO_CALIBRATE_MIN_CONTRAST 200
+
+// Time the IR reading has to stay at the 180 degree reading for the servo to count as arrived
+#define SERVO_CALIBRATE_STABLE_MS 20
+
+// Last degree the servo was commanded to
+extern int angle;
+
+// Time the servo takes to turn one degree in microseconds
+extern int servo_us_per_degree;
+
+// Direction of the next sweep. 1 sweeps 0 to 180. 0 sweeps 180 to 0.
+extern int direction;
+
+// Initialize the timer
+void timer1_init();
+
+// Initializes the GPIO
+void gpio_init();
+
+// Move the servo to a certain degree measurement
+void move_servo(int degree);
+
+// Start the servo toward a certain degree measurement. Returns the milliseconds until it is in position.
+int servo_start(int degree);
+
+// Returns the milliseconds until the servo reaches the position given to servo_start
+int servo_left_ms(void);
+
+// Command the servo to a certain degree measurement without waiting for it to settle
+void servo_set(int degree);
+
+// Returns the time in milliseconds the servo needs to move between two degree measurements
+int servo_settle_ms(int from, int to);
+
+// Measures the slew rate of the servo using an object at 180 degrees
+int servo_calibrate();
+
+// Complete a certain servo task based on which button was pressed
+void button_execution(uint8_t button_value);
+
+#endif /* PWM_H_ */
@@ -0,0 +1,544 @@
+/**
+ * @file sched.c
+ * @brief This file contains the source code for the cooperative task scheduler.
+ *
+ * Modules register periodic tasks with sched_every and deferred callbacks with sched_after instead of
+ * blocking in timer_waitMillis. The millisecond system tick turns a timer wheel of SCHED_WHEEL_SLOTS slots.
+ * Each slot lists the tasks due on a tick with that remainder, and a task due more than one turn away counts
+ * down the turns it has left. The tick only marks tasks ready. They run to completion from sched_run or
+ * sched_run_pending in the main program, lowest task number first.
+ * A task that has to wait in the middle of its work calls sched_sleep, which runs the other tasks that come due,
+ * or loops on sched_idle until an interrupt has done what it is waiting for. Both sleep the processor when nothing is due.
+ *
+ * Each run is timed in microseconds from the Timer2A count, so the report shows where the processor's time goes
+ * and which tasks run late or take longer than they are allowed.
+ * Interrupt handlers are counted in whatever they interrupted.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/8/2018
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "Timer.h"
+#include "sched.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+
+#define SCHED_WHEEL_MASK (SCHED_WHEEL_SLOTS - 1)
+
+/// State of a task table entry
+typedef enum {
+    SCHED_FREE,     // Nothing registered
+    SCHED_IDLE,     // Registered but not going to run
+    SCHED_WAITING,  // In the timer wheel
+    SCHED_READY     // Due and waiting for sched_run_pending
+} sched_state_t;
+
+/// A periodic task or deferred callback
+typedef struct {
+    void (*run)(void);
+    uint32_t due_ms;        // Tick the task is due on
+    uint32_t rounds;        // Turns of the wheel left before the due tick
+    int8_t next;            // Next task in the same wheel slot, -1 at the end
+    uint8_t state;          // sched_state_t
+    sched_stats_t stats;
+} sched_task_t;
+
+static sched_task_t tasks[SCHED_MAX_TASKS];
+static volatile int8_t wheel[SCHED_WHEEL_SLOTS]; // First task in each slot, -1 if empty
+static volatile uint32_t ready = 0; // Bit for each task that is due
+static uint32_t running = 0; // Bit for each task that has started and not returned
+static int started = 0; // 1 once the tick turns the wheel
+
+static uint32_t nested_us = 0; // Microseconds the running task spent in other tasks or asleep
+static uint32_t load_start_ms = 0;
+static uint32_t idle_us = 0;
+static uint32_t sleep_us = 0;
+
+/// Returns the microseconds since the system tick started
+/** This method adds the Timer2A count within the current millisecond to the tick count.
+ * The count wraps around every 71 minutes, which is fine for timing runs.
+ * @return The microseconds since timer_tickInit.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+static uint32_t sched_micros()
+{
+
+    uint32_t ticks;
+    uint32_t count;
+    uint32_t rolled;
+
+    // Read again if the tick counted in between
+    do {
+        ticks = _timer_ticks;
+        count = TIMER2_TAR_R & 0xFFFF;
+        rolled = TIMER2_RIS_R & TIMER_RIS_TATORIS;
+    } while (ticks != _timer_ticks);
+
+    // The timer reloaded but the interrupt has not counted the tick yet
+    if (rolled && count > 500) {
+        ticks++;
+    }
+
+    return ticks * 1000 + (999 - count);
+
+}
+
+/// Puts a task in the timer wheel
+/** This method files the task under the slot of its due tick, or marks it ready if the tick has already passed.
+ * Call with interrupts disabled.
+ * @param index The task number.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+static void wheel_insert(int index)
+{
+
+    sched_task_t *task = &tasks[index];
+    int32_t delay = (int32_t) (task->due_ms - _timer_ticks);
+
+    if (delay <= 0) {
+        task->state = SCHED_READY;
+        ready |= 1u << index;
+        return;
+    }
+
+    // The slot for the current tick has already been checked, so the first visit is 1 to SCHED_WHEEL_SLOTS ticks away
+    task->rounds = (delay - 1) / SCHED_WHEEL_SLOTS;
+    task->next = wheel[task->due_ms & SCHED_WHEEL_MASK];
+    wheel[task->due_ms & SCHED_WHEEL_MASK] = index;
+    task->state = SCHED_WAITING;
+
+}
+
+/// Takes a task out of the timer wheel or the ready mask
+/** This method leaves the task registered but not going to run. Call with interrupts disabled.
+ * @param index The task number.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+static void wheel_remove(int index)
+{
+
+    sched_task_t *task = &tasks[index];
+
+    if (task->state == SCHED_WAITING) {
+        volatile int8_t *link = &wheel[task->due_ms & SCHED_WHEEL_MASK];
+        while (*link >= 0 && *link != index) {
+            link = &tasks[*link].next;
+        }
+        if (*link == index) {
+            *link = task->next;
+        }
+    }
+
+    ready &= ~(1u << index);
+    task->state = SCHED_IDLE;
+
+}
+
+/// Turns the timer wheel
+/** This method is called from the system tick. It marks the tasks in the slot for this tick ready,
+ * and counts down the turns left for the rest.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+static void sched_tick()
+{
+
+    volatile int8_t *link = &wheel[_timer_ticks & SCHED_WHEEL_MASK];
+
+    while (*link >= 0) {
+        int index = *link;
+        sched_task_t *task = &tasks[index];
+
+        if (task->rounds == 0) {
+            *link = task->next;
+            task->state = SCHED_READY;
+            ready |= 1u << index;
+        } else {
+            task->rounds--;
+            link = &task->next;
+        }
+    }
+
+}
+
+/// Starts counting down the timer wheel
+/** This method empties the wheel and registers sched_tick with the system tick. Call after timer_tickInit.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+void sched_init(void)
+{
+
+    int i;
+
+    for (i = 0; i < SCHED_WHEEL_SLOTS; i++) {
+        wheel[i] = -1;
+    }
+
+    sched_reset_stats();
+
+    started = timer_addTickHook(sched_tick);
+
+}
+
+/// Finds or makes the table entry for a function
+/** This method returns the entry the function was registered in before, so its statistics carry on,
+ * or the first free entry.
+ * @param name The name to report the task by.
+ * @param run The function the task calls.
+ * @return The task number, or -1 if all SCHED_MAX_TASKS entries are taken
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+static int sched_find(const char *name, void (*run)(void))
+{
+
+    int i;
+    int unused = -1;
+
+    for (i = 0; i < SCHED_MAX_TASKS; i++) {
+        if (tasks[i].state != SCHED_FREE && tasks[i].run == run) {
+            return i;
+        }
+        if (unused < 0 && tasks[i].state == SCHED_FREE) {
+            unused = i;
+        }
+    }
+
+    if (unused >= 0) {
+        tasks[unused].run = run;
+        tasks[unused].state = SCHED_IDLE;
+        memset(&tasks[unused].stats, 0, sizeof(sched_stats_t));
+        tasks[unused].stats.name = name;
+    }
+
+    return unused;
+
+}
+
+/// Schedules a function
+/** This method takes the function out of the wheel if it was waiting and files it again under its new due tick.
+ * @param name The name to report the task by.
+ * @param run The function the task calls.
+ * @param delay_ms The milliseconds until it runs.
+ * @param period_ms The milliseconds between runs, or 0 to run once.
+ * @return The task number, or -1 before sched_init or if all SCHED_MAX_TASKS entries are taken
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+static int sched_add(const char *name, void (*run)(void), uint32_t delay_ms, uint32_t period_ms)
+{
+
+    // The wheel is not set up until sched_init
+    if (!started) {
+        return -1;
+    }
+
+    int index = sched_find(name, run);
+    if (index < 0) {
+        return -1;
+    }
+
+    bool masked = IntMasterDisable();
+    wheel_remove(index);
+    tasks[index].stats.name = name;
+    tasks[index].stats.period_ms = period_ms;
+    tasks[index].due_ms = _timer_ticks + delay_ms;
+    wheel_insert(index);
+    if (!masked) {
+        IntMasterEnable();
+    }
+
+    return index;
+
+}
+
+/// Runs a task periodically
+/** This method runs the function every period_ms milliseconds, starting one period from now.
+ * A run that starts a whole period late skips the missed runs instead of running them back to back.
+ * @param name The name to report the task by.
+ * @param run The function the task calls. It should return within the period.
+ * @param period_ms The milliseconds between runs.
+ * @return The task number, or -1 before sched_init or if all SCHED_MAX_TASKS entries are taken
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+int sched_every(const char *name, void (*run)(void), uint32_t period_ms)
+{
+
+    if (period_ms == 0) {
+        period_ms = 1;
+    }
+
+    return sched_add(name, run, period_ms, period_ms);
+
+}
+
+/// Runs a callback once after a delay
+/** This method runs the function once after delay_ms milliseconds, or on the next sched_run_pending if the delay is 0.
+ * Calling it again before the callback runs moves the callback to the new time. A callback can call this to run again.
+ * @param name The name to report the callback by.
+ * @param run The function to call.
+ * @param delay_ms The milliseconds to wait.
+ * @return The task number, or -1 before sched_init or if all SCHED_MAX_TASKS entries are taken
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+int sched_after(const char *name, void (*run)(void), uint32_t delay_ms)
+{
+
+    return sched_add(name, run, delay_ms, 0);
+
+}
+
+/// Stops a task or deferred callback
+/** This method takes the function out of the wheel. Its statistics are kept until they are reset.
+ * @param run The function the task calls.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+void sched_cancel(void (*run)(void))
+{
+
+    int i;
+
+    for (i = 0; i < SCHED_MAX_TASKS; i++) {
+        if (tasks[i].state != SCHED_FREE && tasks[i].run == run) {
+            bool masked = IntMasterDisable();
+            wheel_remove(i);
+            if (!masked) {
+                IntMasterEnable();
+            }
+        }
+    }
+
+}
+
+/// Runs one ready task
+/** This method files a periodic task under its next due tick before running it, so the period does not drift
+ * by the time the task takes. It then runs the task and adds the run to its statistics.
+ * @param index The task number.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+static void sched_run_task(int index)
+{
+
+    sched_task_t *task = &tasks[index];
+    sched_stats_t *stats = &task->stats;
+    uint32_t now = _timer_ticks;
+    uint32_t due = task->due_ms;
+
+    bool masked = IntMasterDisable();
+    ready &= ~(1u << index);
+    task->state = SCHED_IDLE;
+    if (stats->period_ms > 0) {
+        task->due_ms = due + stats->period_ms;
+
+        // Skip the runs that were missed
+        if ((int32_t) (task->due_ms - now) <= 0) {
+            task->due_ms = now + stats->period_ms;
+            stats->late++;
+        }
+        wheel_insert(index);
+    }
+    if (!masked) {
+        IntMasterEnable();
+    }
+
+    if (now - due > stats->max_late_ms) {
+        stats->max_late_ms = now - due;
+    }
+
+    // Time spent in other tasks while this one sleeps is counted in those tasks
+    uint32_t outer_nested = nested_us;
+    nested_us = 0;
+    running |= 1u << index;
+
+    uint32_t start = sched_micros();
+    task->run();
+    uint32_t elapsed = sched_micros() - start;
+
+    running &= ~(1u << index);
+    uint32_t busy = elapsed - nested_us;
+    nested_us = outer_nested + elapsed;
+
+    stats->runs++;
+    stats->total_us += busy;
+    if (busy > stats->max_us) {
+        stats->max_us = busy;
+    }
+    if (busy > (stats->period_ms > 0 ? stats->period_ms * 1000 : SCHED_DEFERRED_BUDGET_US)) {
+        stats->overruns++;
+    }
+
+}
+
+/// Runs every task that is due
+/** This method runs the ready tasks, lowest task number first, until none are left.
+ * Tasks that are already running further up, because they are in sched_sleep, wait until they return.
+ * @return The number of tasks run
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+int sched_run_pending(void)
+{
+
+    int count = 0;
+    uint32_t pending;
+
+    while ((pending = ready & ~running) != 0) {
+        int index = 0;
+        while (!(pending & (1u << index))) {
+            index++;
+        }
+
+        sched_run_task(index);
+        count++;
+    }
+
+    return count;
+
+}
+
+/// Runs the tasks forever
+/** This method is the main loop of the program. When no task is ready the processor sleeps until the next interrupt,
+ * which is at most a millisecond away.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+void sched_run(void)
+{
+
+    while (1) {
+        if (sched_run_pending() == 0) {
+            uint32_t start = sched_micros();
+            SysCtlSleep();
+            idle_us += sched_micros() - start;
+        }
+    }
+
+}
+
+/// Runs the other tasks or sleeps
+/** This method is the body of a loop waiting for an interrupt to change something. It runs the tasks that are due,
+ * or sleeps the processor until the next interrupt if none are, which is at most a millisecond away.
+ * Call it with interrupts enabled. Before sched_init it returns straight away, so the loop spins.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+void sched_idle(void)
+{
+
+    if (!started) {
+        return;
+    }
+
+    uint32_t start = sched_micros();
+
+    if (sched_run_pending() == 0) {
+        SysCtlSleep();
+
+        // Time asleep is not counted in the task that is waiting
+        uint32_t slept = sched_micros() - start;
+        sleep_us += slept;
+        nested_us += slept;
+    }
+
+}
+
+/// Waits while running the other tasks
+/** This method takes the place of timer_waitMillis in tasks. It runs the other tasks that come due while it waits
+ * and sleeps the processor between them, so it can return late if one of them runs long.
+ * Before sched_init it falls back to timer_waitMillis.
+ * @param millis The number of milliseconds to wait.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+void sched_sleep(uint32_t millis)
+{
+
+    if (!started) {
+        timer_waitMillis(millis);
+        return;
+    }
+
+    uint32_t start_ms = timer_getMillis();
+    uint32_t outer_nested = nested_us;
+    uint32_t start = sched_micros();
+
+    // The first tick may be almost over, so wait for one more than asked
+    while (timer_getMillis() - start_ms <= millis) {
+        sched_idle();
+    }
+
+    uint32_t elapsed = sched_micros() - start;
+    sleep_us += elapsed - (nested_us - outer_nested);
+    nested_us = outer_nested + elapsed;
+
+}
+
+/// Copies the statistics of a task
+/** This method copies the runtime of a registered task.
+ * @param task The task number, from 0.
+ * @param stats Set to the statistics.
+ * @return 1, or 0 if task is past the last registered task
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+int sched_get_stats(int task, sched_stats_t *stats)
+{
+
+    if (task < 0 || task >= SCHED_MAX_TASKS || tasks[task].state == SCHED_FREE) {
+        return 0;
+    }
+
+    *stats = tasks[task].stats;
+    return 1;
+
+}
+
+/// Copies where the time went
+/** This method copies the time since the statistics were reset and how much of it was idle.
+ * @param load Set to the totals.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+void sched_get_load(sched_load_t *load)
+{
+
+    load->elapsed_ms = timer_getMillis() - load_start_ms;
+    load->idle_us = idle_us;
+    load->sleep_us = sleep_us;
+
+}
+
+/// Starts the statistics over
+/** This method zeroes the runtime of every task and the idle totals. The tasks stay registered.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/8/2018
+ */
+void sched_reset_stats(void)
+{
+
+    int i;
+
+    for (i = 0; i < SCHED_MAX_TASKS; i++) {
+        const char *name = tasks[i].stats.name;
+        uint32_t period_ms = tasks[i].stats.period_ms;
+        memset(&tasks[i].stats, 0, sizeof(sched_stats_t));
+        tasks[i].stats.name = name;
+        tasks[i].stats.period_ms = period_ms;
+    }
+
+    load_start_ms = timer_getMillis();
+    idle_us = 0;
+    sleep_us = 0;
+
+}
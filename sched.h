@@ -0,0 +1,74 @@
+/*
+ * sched.h
+ *
+ *  Created on: May 8, 2018
+ *      Author: mmorth
+ */
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+
+// Most tasks and deferred callbacks that can be registered. Each one is a bit in the ready mask.
+#define SCHED_MAX_TASKS 16
+
+// Slots in the timer wheel, one per millisecond tick. Must be a power of 2.
+#define SCHED_WHEEL_SLOTS 32
+
+// Longest a deferred callback should run before it counts as an overrun, in microseconds
+#define SCHED_DEFERRED_BUDGET_US 1000
+
+/// Runtime of a task since the statistics were last reset
+typedef struct {
+    const char *name;       // Name the task was registered with
+    uint32_t period_ms;     // Milliseconds between runs, 0 for a deferred callback
+    uint32_t runs;          // Times the task ran
+    uint32_t total_us;      // Microseconds spent in the task, not counting other tasks run while it slept
+    uint32_t max_us;        // Longest single run in microseconds
+    uint32_t max_late_ms;   // Longest the task waited past its due tick to start
+    uint32_t late;          // Periodic runs that started a whole period late and were skipped to catch up
+    uint32_t overruns;      // Runs longer than the period, or SCHED_DEFERRED_BUDGET_US for a deferred callback
+} sched_stats_t;
+
+/// Where the time went since the statistics were last reset
+typedef struct {
+    uint32_t elapsed_ms;    // Milliseconds since the reset
+    uint32_t idle_us;       // Microseconds with no task ready
+    uint32_t sleep_us;      // Microseconds tasks spent in sched_sleep with nothing else to run
+} sched_load_t;
+
+// Starts counting down the timer wheel from the system tick. Call after timer_tickInit.
+void sched_init(void);
+
+// Runs a task every period_ms milliseconds, starting one period from now. Returns the task number, or -1 if full or before sched_init.
+int sched_every(const char *name, void (*run)(void), uint32_t period_ms);
+
+// Runs a callback once after delay_ms milliseconds. Moves it if it is already waiting. Returns the task number, or -1 if full or before sched_init.
+int sched_after(const char *name, void (*run)(void), uint32_t delay_ms);
+
+// Stops a task or deferred callback from running again
+void sched_cancel(void (*run)(void));
+
+// Runs every task that is due. Returns the number of tasks run.
+int sched_run_pending(void);
+
+// Runs due tasks forever, sleeping the processor when none are ready
+void sched_run(void);
+
+// Runs the tasks that are due, or sleeps the processor until the next interrupt if none are. Call in a loop waiting for an interrupt.
+void sched_idle(void);
+
+// Waits at least millis milliseconds while running the other tasks that come due
+void sched_sleep(uint32_t millis);
+
+// Copies the statistics of a task. Returns 0 if there is no such task.
+int sched_get_stats(int task, sched_stats_t *stats);
+
+// Copies where the time went since the statistics were reset
+void sched_get_load(sched_load_t *load);
+
+// Starts the statistics over
+void sched_reset_stats(void);
+
+#endif /* SCHED_H_ */
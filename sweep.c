@@ -0,0 +1,292 @@
+/**
+ * @file sweep.c
+ * @brief This file contains the source code for the interrupt driven sweep engine.
+ *
+ * The servo, IR, and PING))) sensors are stepped from the millisecond system tick. As soon as the
+ * servo has settled on a degree, the latest background IR reading is stored, the ping for that degree
+ * is started, and the servo is commanded to the next degree. The echo then completes while the servo
+ * is moving, so each degree costs the settle time instead of the settle time plus the echo time.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/19/2018
+ */
+
+#include "Timer.h"
+#include "distance.h"
+#include "ping.h"
+#include "pwm.h"
+#include "sched.h"
+#include "sweep.h"
+
+sweep_sample_t sweep_samples[SWEEP_DEGREES]; // Readings of the last sweep, indexed by degree
+
+static int sweep_hooked = 0; // 1 once sweep_tick is registered with the system tick
+static volatile int sweep_running = 0; // 1 while the tick is stepping the sweep
+static volatile int sweep_degree = 0; // Degree the servo is moving to
+static volatile int sweep_end = 0; // Last degree of the sweep
+static volatile int sweep_step = 1; // Degrees between samples, negative when sweeping down
+static volatile int settle_left = 0; // Milliseconds until the servo reaches sweep_degree
+static int step_settle_ms = 0; // Milliseconds the servo needs to move one step
+static volatile int pending_degree = -1; // Degree whose readings are still in flight
+static volatile int ping_done = 0; // 1 once the echo of pending_degree is stored
+
+static volatile int completed[SWEEP_DEGREES]; // Degrees in the order they completed
+static volatile int completed_count = 0; // Number of degrees completed
+static int consumed_count = 0; // Number of degrees returned by sweep_poll
+
+static volatile uint32_t start_ms = 0; // Tick count when the sweep started
+static volatile uint32_t end_ms = 0; // Tick count when the last degree completed
+
+/// Returns whether a degree is within the current sweep
+/** This method checks the degree against the sweep end in the sweep direction.
+ * @param degree The degree to check.
+ * @return 1 if the degree is part of the sweep, 0 otherwise
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+static int in_sweep(int degree)
+{
+
+    if (sweep_step > 0) {
+        return degree <= sweep_end;
+    }
+    return degree >= sweep_end;
+
+}
+
+/// Lets the system tick step sweeps
+/** This method registers sweep_tick with the system tick once, so starting a sweep cannot run out of tick hooks.
+ * Call after timer_tickInit.
+ * @return 1, or 0 if all TIMER_TICK_HOOKS are taken and sweeps cannot run
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+int sweep_init(void)
+{
+
+    sweep_hooked = timer_addTickHook(sweep_tick);
+    return sweep_hooked;
+
+}
+
+/// Moves the servo to the start degree and starts an interrupt driven sweep
+/** This method positions the servo and hands the rest of the sweep to the system tick.
+ * Use sweep_poll to collect the readings as they complete.
+ * @param start The first degree to sample.
+ * @param end The last degree to sample.
+ * @return 1, or 0 if sweep_init has not registered the tick hook. sweep_is_done then returns 1 straight away.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+int sweep_start(int start, int end)
+{
+
+    return sweep_start_step(start, end, 1);
+
+}
+
+/// Moves the servo to the start degree and starts an interrupt driven sweep that samples every step degrees
+/** This method positions the servo and hands the rest of the sweep to the system tick.
+ * Use sweep_poll to collect the readings as they complete. This returns without waiting for the servo.
+ * @param start The first degree to sample.
+ * @param end The last degree to sample.
+ * @param step The number of degrees between samples.
+ * @return 1, or 0 if sweep_init has not registered the tick hook. sweep_is_done then returns 1 straight away.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/21/2018
+ */
+int sweep_start_step(int start, int end, int step)
+{
+
+    completed_count = 0;
+    consumed_count = 0;
+
+    // Nothing would step the sweep, so it would never be done
+    if (!sweep_hooked) {
+        sweep_running = 0;
+        return 0;
+    }
+
+    start_ms = timer_getMillis();
+
+    sweep_degree = start;
+    sweep_end = end;
+    sweep_step = (end >= start) ? step : -step;
+    step_settle_ms = servo_settle_ms(0, step);
+    pending_degree = -1;
+
+    // Move the servo to the start degree and have the tick wait until it gets there.
+    // A sweep that starts where the last one ended only waits for a servo still on its way.
+    if (angle != start) {
+        settle_left = servo_start(start);
+    } else {
+        settle_left = servo_left_ms();
+    }
+
+    // Let the system tick step the sweep
+    sweep_running = 1;
+    return 1;
+
+}
+
+/// Stores the echo of the degree in flight
+/** This method is called from the PING))) interrupt when the ping of pending_degree completes.
+ * @param result PING_DONE or PING_NO_ECHO.
+ * @param cycles The width of the echo, or of the timeout if there was no echo.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/26/2018
+ */
+static void sweep_echo(ping_status_t result, int cycles)
+{
+
+    sweep_samples[pending_degree].cycles = cycles;
+    sweep_samples[pending_degree].echo = (result == PING_DONE);
+    ping_done = 1;
+
+}
+
+/// Advances the sweep
+/** This method is called from the system tick every millisecond. It collects the readings of the
+ * previous degree, and once the servo has settled, samples the current degree and moves on.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+void sweep_tick(void)
+{
+
+    if (!sweep_running) {
+        return;
+    }
+
+    // Wait for the servo to reach the next degree
+    if (settle_left > 0) {
+        settle_left--;
+        return;
+    }
+
+    // Only one ping can be in flight, so finish the previous degree first.
+    // The ping times out on its own if no echo comes back.
+    if (pending_degree >= 0) {
+        if (!ping_done) {
+            return;
+        }
+
+        completed[completed_count] = pending_degree;
+        completed_count++;
+        pending_degree = -1;
+    }
+
+    if (!in_sweep(sweep_degree)) {
+        end_ms = timer_getMillis();
+        sweep_running = 0;
+        return;
+    }
+
+    // Sample the current degree
+    pending_degree = sweep_degree;
+    sweep_samples[pending_degree].degree = pending_degree;
+    sweep_samples[pending_degree].valid = 1;
+    sweep_samples[pending_degree].echo = 0;
+    ping_done = 0;
+    sweep_samples[pending_degree].quantization = adc_latest();
+    ping_start(sweep_echo);
+
+    // Start moving toward the next degree while the readings complete
+    sweep_degree += sweep_step;
+    if (in_sweep(sweep_degree)) {
+        servo_set(sweep_degree);
+        settle_left = step_settle_ms;
+    }
+
+}
+
+/// Marks every degree as not sampled
+/** This method clears the valid flag of every sample so that a sweep made of several passes
+ * can tell which degrees it has sampled.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/21/2018
+ */
+void sweep_clear()
+{
+
+    int degree;
+    for (degree = 0; degree < SWEEP_DEGREES; degree++) {
+        sweep_samples[degree].valid = 0;
+    }
+
+}
+
+/// Returns the next completed sample
+/** This method returns the readings of the next degree to complete, converted to distances, without waiting for one.
+ * @return The next sample, or 0 if no degree has completed since the last call
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+sweep_sample_t *sweep_poll(void)
+{
+
+    if (consumed_count >= completed_count) {
+        return 0;
+    }
+
+    sweep_sample_t *sample = &sweep_samples[completed[consumed_count]];
+    consumed_count++;
+
+    // Convert the raw readings
+    sample->ir_mm = ir_to_mm(sample->quantization);
+    sample->ping_mm = ping_cycles_to_mm(sample->cycles);
+
+    return sample;
+
+}
+
+/// Returns whether the sweep is over
+/** This method checks that the tick has finished the sweep and that sweep_poll has returned every sample.
+ * @return 1 once the sweep is finished and every sample has been returned, 0 otherwise
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/9/2018
+ */
+int sweep_is_done(void)
+{
+
+    return !sweep_running && consumed_count >= completed_count;
+
+}
+
+/// Waits for the next completed sample
+/** This method returns the readings of the next degree to complete, running the other tasks while it waits.
+ * The commands send their sweeps from a task with sweep_poll instead, so only the old measuring loops wait here.
+ * @return The next sample, or 0 once the sweep is finished and every sample has been returned
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+sweep_sample_t *sweep_next()
+{
+
+    sweep_sample_t *sample;
+
+    // Wait for the tick to complete another degree
+    while ((sample = sweep_poll()) == 0) {
+        if (sweep_is_done()) {
+            return 0;
+        }
+        sched_idle();
+    }
+
+    return sample;
+
+}
+
+/// Returns the time taken by the last sweep
+/** This method returns the time from sweep_start to the last completed degree.
+ * @return The sweep time in milliseconds
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/19/2018
+ */
+uint32_t sweep_time()
+{
+
+    return end_ms - start_ms;
+
+}
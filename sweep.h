@@ -0,0 +1,67 @@
+/*
+ * sweep.h
+ *
+ *  Created on: Apr 19, 2018
+ *      Author: mmorth
+ */
+
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include <stdint.h>
+
+// Number of servo degrees covered by a full sweep (0-180)
+#define SWEEP_DEGREES 181
+
+// Degrees between samples in the coarse pass of an adaptive sweep.
+// Objects narrower than this can be missed, so keep it at or below the 5 degree minimum object width.
+#define SWEEP_COARSE_STEP 5
+
+// Distance of the sensors in front of the middle of the robot in mm
+#define SWEEP_SENSOR_OFFSET_MM 120
+
+/// Sensor readings taken at one servo degree
+typedef struct {
+    int degree;             // Servo degree the readings were taken at
+    int valid;              // 1 if this degree has been sampled since sweep_clear
+    unsigned quantization;  // Raw IR ADC reading
+    int cycles;             // Width of the PING))) echo in clock cycles
+    int echo;               // 1 if an echo was captured, 0 if the ping timed out
+    int ir_mm;              // IR distance in mm, filled in by sweep_poll
+    int ping_mm;            // PING))) distance in mm, filled in by sweep_poll
+    int fused_mm;           // Fused distance in mm, filled in by fusion_run
+    int confidence;         // Confidence in fused_mm from 0 to 255, filled in by fusion_run
+} sweep_sample_t;
+
+// Readings of the last sweep, indexed by degree
+extern sweep_sample_t sweep_samples[SWEEP_DEGREES];
+
+// Lets the system tick step sweeps. Call after timer_tickInit. Returns 0 if no tick hook is free.
+int sweep_init(void);
+
+// Moves the servo to the start degree and starts an interrupt driven sweep to the end degree.
+// The end degree may be below the start degree to sweep from 180 toward 0. Returns 0 if sweep_init failed.
+int sweep_start(int start, int end);
+
+// Same as sweep_start, but only samples every step degrees
+int sweep_start_step(int start, int end, int step);
+
+// Marks every degree as not sampled
+void sweep_clear();
+
+// Returns the next completed sample, or 0 if none has completed since the last call
+sweep_sample_t *sweep_poll(void);
+
+// Returns 1 once the sweep is finished and sweep_poll has returned every sample
+int sweep_is_done(void);
+
+// Waits for the next completed sample. Returns 0 once the sweep is finished.
+sweep_sample_t *sweep_next();
+
+// Returns the time taken by the last sweep in milliseconds
+uint32_t sweep_time();
+
+// Advances the sweep, called from the system tick every millisecond
+void sweep_tick(void);
+
+#endif /* SWEEP_H_ */
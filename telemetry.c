@@ -0,0 +1,392 @@
+/**
+ * @file telemetry.c
+ * @brief This file contains the source code for sending sweep data to Putty as text or binary frames.
+ *
+ * Text mode sends the same tables as before. Binary mode sends one fixed size frame per sample and object,
+ * which is fewer bytes per degree and needs no sprintf. tools/telemetry_decode turns the frames back into the text tables.
+ * Both modes count the bytes sent and the cycles spent formatting so they can be compared.
+ * The occupancy grid sends its changed cells through here too.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/28/2018
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "Timer.h"
+#include "uart.h"
+#include "telemetry.h"
+
+// 1 to send sweeps as binary frames, 0 to send them as text
+int telemetry_binary = 0;
+
+// Statistics of the last sweep sent
+telemetry_stats_t telemetry_stats;
+
+// Sequence number of the next frame
+static uint16_t sequence = 0;
+
+// Time the record being formatted started, from timer_getCycles
+static uint32_t format_start;
+
+// Stores the summary until the objects have been sent
+static uint32_t summary_ms = 0;
+static int summary_samples = 0;
+
+/// Starts timing the formatting of one record
+/** This method reads the clock cycle counter.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+static void format_begin()
+{
+
+    format_start = timer_getCycles();
+
+}
+
+/// Stops timing the formatting of one record
+/** This method adds the cycles since format_begin to the statistics.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+static void format_end()
+{
+
+    telemetry_stats.cycles += timer_cyclesSince(format_start);
+    telemetry_stats.records++;
+
+}
+
+/// Returns the CRC-16/CCITT of length bytes
+/** This method uses polynomial 0x1021 with an initial value of 0xFFFF.
+ * @param data The bytes to check.
+ * @param length The number of bytes.
+ * @return The CRC
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+uint16_t telemetry_crc(const uint8_t *data, int length)
+{
+
+    uint16_t crc = 0xFFFF;
+    int i, bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+
+}
+
+/// Stores a 16 bit value little-endian
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+static void put16(uint8_t *data, uint16_t value)
+{
+
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+
+}
+
+/// Fills in the header and CRC of a frame
+/** This method sets the sync byte, type, and sequence number and appends the CRC.
+ * The payload must already be in frame.
+ * @param frame The frame to finish.
+ * @param type The frame type.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+static void frame_finish(uint8_t *frame, int type)
+{
+
+    frame[0] = TELEMETRY_SYNC;
+    frame[1] = type;
+    put16(&frame[2], sequence++);
+    put16(&frame[4 + TELEMETRY_PAYLOAD_SIZE], telemetry_crc(frame, 4 + TELEMETRY_PAYLOAD_SIZE));
+
+}
+
+/// Sends a frame
+/** This method sends every byte of the frame over uart 1, including zero bytes.
+ * @param frame The frame to send.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+static void frame_send(const uint8_t *frame)
+{
+
+    int i;
+
+    for (i = 0; i < TELEMETRY_FRAME_SIZE; i++) {
+        uart_sendChar(frame[i]);
+    }
+    telemetry_stats.bytes += TELEMETRY_FRAME_SIZE;
+
+}
+
+/// Sends a line of text
+/** This method sends the string over uart 1 and counts its bytes.
+ * @param message The string to send.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+static void text_send(const char *message)
+{
+
+    uart_sendStr(message);
+    telemetry_stats.bytes += strlen(message);
+
+}
+
+/// Resets the statistics before sending a sweep
+/** This method clears the byte and cycle counts.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+void telemetry_begin()
+{
+
+    telemetry_stats.bytes = 0;
+    telemetry_stats.records = 0;
+    telemetry_stats.cycles = 0;
+
+}
+
+/// Sends the readings of one degree
+/** This method sends the degree, IR distance, and PING))) distance as a line of text or a TELEMETRY_SAMPLE frame.
+ * @param sample The readings to send.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+void telemetry_sample(const sweep_sample_t *sample)
+{
+
+    if (telemetry_binary) {
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+
+        format_begin();
+        frame[4] = sample->degree;
+        frame[5] = sample->echo ? 1 : 0;
+        put16(&frame[6], sample->ir_mm);
+        put16(&frame[8], sample->ping_mm);
+        put16(&frame[10], sample->cycles / 16);
+        frame_finish(frame, TELEMETRY_SAMPLE);
+        format_end();
+
+        frame_send(frame);
+    } else {
+        char message[100];
+
+        format_begin();
+        sprintf(message, "%d\t%d.%d\t\t%d.%d\n\r", sample->degree,
+                sample->ir_mm / 10, sample->ir_mm % 10, sample->ping_mm / 10,
+                sample->ping_mm % 10);
+        format_end();
+
+        text_send(message);
+    }
+
+}
+
+/// Sends the sweep time and number of degrees sampled
+/** In text mode this is sent right away. In binary mode it is sent in the TELEMETRY_SWEEP_END frame.
+ * @param sweep_ms The time the sweep took in milliseconds.
+ * @param samples The number of degrees sampled.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+void telemetry_summary(uint32_t sweep_ms, int samples)
+{
+
+    summary_ms = sweep_ms;
+    summary_samples = samples;
+
+    if (!telemetry_binary) {
+        char message[100];
+
+        format_begin();
+        sprintf(message, "Sweep time: %lu ms\n\rSamples: %d of %d\n\r",
+                (unsigned long) sweep_ms, samples, SWEEP_DEGREES);
+        format_end();
+
+        text_send(message);
+    }
+
+}
+
+/// Sends one object found in the sweep
+/** This method sends the object as a NEW OBJECT block of text or a TELEMETRY_OBJECT frame.
+ * Binary frames leave out the object number and samples, which the decoder works out from the frame order and degrees.
+ * @param object The object to send.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+void telemetry_object(const object_t *object)
+{
+
+    if (telemetry_binary) {
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+
+        format_begin();
+        frame[4] = object->start_degree;
+        frame[5] = object->end_degree;
+        put16(&frame[6], object->mean_mm);
+        put16(&frame[8], object->min_mm);
+        put16(&frame[10], object->width_mm);
+        frame_finish(frame, TELEMETRY_OBJECT);
+        format_end();
+
+        frame_send(frame);
+    } else {
+        char message[150];
+
+        format_begin();
+        sprintf(message,
+                "\nNEW OBJECT:\n\rObject: %d\n\rAvg_Ping: %d.%d\n\rMin_Ping: %d.%d\n\rWidth: %d.%d\n\rStart: %d\n\rEnd: %d\n\rSamples: %d\n\r",
+                object->id, object->mean_mm / 10, object->mean_mm % 10,
+                object->min_mm / 10, object->min_mm % 10,
+                object->width_mm / 10, object->width_mm % 10,
+                object->start_degree, object->end_degree, object->samples);
+        format_end();
+
+        text_send(message);
+    }
+
+}
+
+/// Sends the number of objects dropped and the statistics of the sweep
+/** In binary mode this sends the TELEMETRY_SWEEP_END frame, which carries the summary, the dropped objects,
+ * and the bytes and formatting cycles of the sweep including itself.
+ * In text mode the statistics line is not counted in the statistics.
+ * @param dropped The number of objects found after objects was full.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/28/2018
+ */
+void telemetry_end(int dropped)
+{
+
+    if (telemetry_binary) {
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+
+        // Count this frame in the bytes it reports
+        uint32_t bytes = telemetry_stats.bytes + TELEMETRY_FRAME_SIZE;
+
+        format_begin();
+        frame[4] = summary_samples;
+        frame[5] = dropped > 255 ? 255 : dropped;
+        put16(&frame[6], summary_ms > 0xFFFF ? 0xFFFF : summary_ms);
+        put16(&frame[8], bytes > 0xFFFF ? 0xFFFF : bytes);
+        put16(&frame[10], telemetry_stats.records ? telemetry_stats.cycles / telemetry_stats.records : 0);
+        frame_finish(frame, TELEMETRY_SWEEP_END);
+        format_end();
+
+        frame_send(frame);
+    } else {
+        char message[100];
+
+        if (dropped > 0) {
+            format_begin();
+            sprintf(message, "\n%d more objects were not recorded.\n\r", dropped);
+            format_end();
+
+            text_send(message);
+        }
+
+        sprintf(message, "Telemetry: %lu bytes, %lu cycles formatting per record\n\r",
+                (unsigned long) telemetry_stats.bytes,
+                (unsigned long) (telemetry_stats.records ? telemetry_stats.cycles / telemetry_stats.records : 0));
+        uart_sendStr(message);
+    }
+
+}
+
+/// Sends the states of a run of grid cells
+/** This method sends a TELEMETRY_GRID frame, or a line with the first cell and a digit for each state.
+ * @param first The index of the first cell.
+ * @param count The number of cells, at most 20.
+ * @param states The state of each cell, 0 to 3.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void telemetry_grid(int first, int count, const uint8_t *states)
+{
+
+    int i;
+
+    if (telemetry_binary) {
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+
+        format_begin();
+        memset(&frame[4], 0, TELEMETRY_PAYLOAD_SIZE);
+        put16(&frame[4], first);
+        frame[6] = count;
+        for (i = 0; i < count; i++) {
+            frame[7 + i / 4] |= (states[i] & 3) << ((i % 4) * 2);
+        }
+        frame_finish(frame, TELEMETRY_GRID);
+        format_end();
+
+        frame_send(frame);
+    } else {
+        char message[40];
+
+        format_begin();
+        int length = sprintf(message, "Grid: %d ", first);
+        for (i = 0; i < count; i++) {
+            message[length++] = '0' + (states[i] & 3);
+        }
+        strcpy(&message[length], "\n\r");
+        format_end();
+
+        text_send(message);
+    }
+
+}
+
+/// Sends the size of the grid after its changed cells
+/** This method sends a TELEMETRY_GRID_END frame or a line of text, so the ground station can size its map
+ * and draw the robot.
+ * @param width The cells across the grid.
+ * @param height The cells up the grid.
+ * @param cell_mm The size of each cell in mm.
+ * @param cells The cells sent since the last end.
+ * @param robot_cell The cell the robot is in, or -1 if it is off the grid.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/5/2018
+ */
+void telemetry_grid_end(int width, int height, int cell_mm, int cells, int robot_cell)
+{
+
+    if (telemetry_binary) {
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+
+        format_begin();
+        frame[4] = width;
+        frame[5] = height;
+        put16(&frame[6], cell_mm);
+        put16(&frame[8], cells);
+        put16(&frame[10], robot_cell < 0 ? 0xFFFF : robot_cell);
+        frame_finish(frame, TELEMETRY_GRID_END);
+        format_end();
+
+        frame_send(frame);
+    } else {
+        char message[80];
+
+        format_begin();
+        sprintf(message, "Grid end: %d x %d cells of %d mm, %d sent, robot at %d\n\r",
+                width, height, cell_mm, cells, robot_cell);
+        format_end();
+
+        text_send(message);
+    }
+
+}
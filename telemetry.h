@@ -0,0 +1,68 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Apr 28, 2018
+ *      Author: mmorth
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include "sweep.h"
+#include "detect.h"
+
+// Every binary frame is this many bytes:
+// sync, type, sequence (uint16), 8 payload bytes, CRC-16/CCITT of the first 12 bytes (uint16).
+// All multi-byte fields are little-endian. tools/telemetry_decode.h must match this layout.
+#define TELEMETRY_FRAME_SIZE 14
+#define TELEMETRY_PAYLOAD_SIZE 8
+
+// First byte of every frame
+#define TELEMETRY_SYNC 0xA5
+
+// Frame types
+#define TELEMETRY_SAMPLE 1      // degree, flags (bit 0 = echo), IR mm, PING))) mm, echo width in us
+#define TELEMETRY_OBJECT 2      // start degree, end degree, mean mm, min mm, width mm
+#define TELEMETRY_SWEEP_END 3   // samples, objects dropped, sweep ms, bytes sent, average formatting cycles
+#define TELEMETRY_GRID 4        // first cell (uint16), cells, up to 20 cell states packed 2 bits each from the low bits
+#define TELEMETRY_GRID_END 5    // width, height, cell mm, cells sent, robot cell (0xFFFF off the grid)
+
+// 1 to send sweeps as binary frames, 0 to send them as text
+extern int telemetry_binary;
+
+/// Bytes and formatting time of the sweep being sent
+typedef struct {
+    uint32_t bytes;     // Bytes sent since telemetry_begin
+    uint32_t records;   // Samples, objects, and summaries formatted since telemetry_begin
+    uint32_t cycles;    // Clock cycles spent formatting since telemetry_begin, not counting sending
+} telemetry_stats_t;
+
+// Statistics of the last sweep sent
+extern telemetry_stats_t telemetry_stats;
+
+// Resets the statistics before sending a sweep
+void telemetry_begin();
+
+// Sends the readings of one degree
+void telemetry_sample(const sweep_sample_t *sample);
+
+// Sends the sweep time and number of degrees sampled
+void telemetry_summary(uint32_t sweep_ms, int samples);
+
+// Sends one object found in the sweep
+void telemetry_object(const object_t *object);
+
+// Sends the number of objects dropped and the statistics of the sweep
+void telemetry_end(int dropped);
+
+// Sends the states of count grid cells starting at first
+void telemetry_grid(int first, int count, const uint8_t *states);
+
+// Sends the size of the grid, the cells sent since the last end, and the cell the robot is in (-1 off the grid)
+void telemetry_grid_end(int width, int height, int cell_mm, int cells, int robot_cell);
+
+// Returns the CRC-16/CCITT of length bytes
+uint16_t telemetry_crc(const uint8_t *data, int length);
+
+#endif /* TELEMETRY_H_ */
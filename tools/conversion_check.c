@@ -0,0 +1,93 @@
+/**
+ * @file conversion_check.c
+ * @brief Host side check of the integer distance conversions against the double precision formulas.
+ *
+ * Builds distance.c and ping.c with the simulated peripherals in host/ and compares ir_to_mm with convert_distance
+ * at every ADC code, and ping_cycles_to_mm with cycle2dist at every echo width up to the echo timeout. It reports
+ * the largest error of each and fails if it is over the limit. Both return whole mm, so each limit allows the half mm
+ * of rounding on top. The IR limit applies from IR_CHECK_MIN_QUANTIZATION up. Below it, far past the sensor's range,
+ * the curve is too steep for the table and the readings only mean "far away".
+ *
+ * Build: cc -std=c99 -Ihost -o conversion_check conversion_check.c ../distance.c ../ir_buffer.c ../ping.c host/host.c -lm
+ * Usage: conversion_check
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/9/2018
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "../distance.h"
+#include "../ping.h"
+
+// Lowest quantization number the IR limit applies to, about 6m
+#define IR_CHECK_MIN_QUANTIZATION 100
+
+// Largest error ir_to_mm may have in range past the rounding, as a fraction of the distance
+#define IR_CHECK_MAX_RELATIVE 0.01
+
+// Error of rounding to whole mm, with room for the double precision formulas landing on a half
+#define CHECK_ROUNDING_MM 0.500001
+
+// Largest error ping_cycles_to_mm may have past the rounding, in mm
+#define PING_CHECK_MAX_MM 0.0
+
+int main(void)
+{
+
+    int failed = 0;
+    unsigned quantization;
+    int cycles;
+    double ir_max_relative = 0, ir_max_mm = 0, ir_far_max_mm = 0;
+    unsigned ir_worst = 0, ir_far_worst = 0;
+    double ping_max_mm = 0;
+    int ping_worst = 0;
+
+    // Quantization number 0 is an infinite distance, which the table clamps
+    for (quantization = 1; quantization <= 4095; quantization++) {
+        double exact = convert_distance(quantization) * 10;
+        double error = fabs(ir_to_mm(quantization) - exact);
+
+        if (quantization < IR_CHECK_MIN_QUANTIZATION) {
+            if (error > ir_far_max_mm && exact < 65535) {
+                ir_far_max_mm = error;
+                ir_far_worst = quantization;
+            }
+        } else if ((error - CHECK_ROUNDING_MM) / exact > ir_max_relative) {
+            ir_max_relative = (error - CHECK_ROUNDING_MM) / exact;
+            ir_max_mm = error;
+            ir_worst = quantization;
+        }
+    }
+
+    for (cycles = 0; cycles <= PING_TIMEOUT_US * 16; cycles++) {
+        double error = fabs(ping_cycles_to_mm(cycles) - cycle2dist(cycles) * 10);
+
+        if (error - CHECK_ROUNDING_MM > ping_max_mm) {
+            ping_max_mm = error - CHECK_ROUNDING_MM;
+            ping_worst = cycles;
+        }
+    }
+
+    printf("ir_to_mm, quantization %d to 4095: largest error past rounding %.3f%% (%.1f mm at %u, %.0f mm away), limit %.1f%%\n",
+            IR_CHECK_MIN_QUANTIZATION, ir_max_relative * 100, ir_max_mm, ir_worst,
+            convert_distance(ir_worst) * 10, IR_CHECK_MAX_RELATIVE * 100);
+    printf("ir_to_mm, quantization 1 to %d: largest error %.0f mm at %u, %.0f mm away, not checked\n",
+            IR_CHECK_MIN_QUANTIZATION - 1, ir_far_max_mm, ir_far_worst, convert_distance(ir_far_worst) * 10);
+    printf("ping_cycles_to_mm, 0 to %d cycles: largest error past rounding %.3f mm at %d cycles, limit %.1f mm\n",
+            PING_TIMEOUT_US * 16, ping_max_mm, ping_worst, PING_CHECK_MAX_MM);
+
+    if (ir_max_relative > IR_CHECK_MAX_RELATIVE) {
+        printf("FAIL: ir_to_mm is off by more than the limit\n");
+        failed = 1;
+    }
+    if (ping_max_mm > PING_CHECK_MAX_MM) {
+        printf("FAIL: ping_cycles_to_mm is off by more than the limit\n");
+        failed = 1;
+    }
+
+    printf(failed ? "FAIL\n" : "All checks passed\n");
+    return failed;
+
+}
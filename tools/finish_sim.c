@@ -0,0 +1,376 @@
+/**
+ * @file finish_sim.c
+ * @brief Host side test of the finish zone detector in finish.c on synthetic and recorded sweeps.
+ *
+ * Synthetic sweeps are made from a scene of round posts and wide boxes placed relative to the robot.
+ * Each one becomes an object record the way detect.c would make it: the beams make it look SIM_BEAM_DEGREES
+ * wider on each side, it is only seen between OBJECT_MIN_MM and object_range_mm and for at least
+ * OBJECT_MIN_DEGREES, and a closer object hides anything behind it. Each scene says how many posts should be
+ * matched and where the middle of the zone is. A last test jitters the distances and degrees of the zone
+ * and counts how often it is still found.
+ *
+ * Recorded sweeps are captures of the robot's text output (or telemetry_decode's) with NEW OBJECT blocks.
+ * A line "# expect posts x y" in a capture gives the answer to check, otherwise the zone found is only printed.
+ * The captures in captures/ are made from the scene model with noise until sweeps of the course are recorded.
+ *
+ * Build: cc -std=c99 -o finish_sim finish_sim.c ../finish.c -lm
+ * Usage: finish_sim [capture.txt ...], for example finish_sim captures/zone_turned_15.txt
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/7/2018
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../sweep.h"
+#include "../finish.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Degrees the beams add to each side of an object
+#define SIM_BEAM_DEGREES 3
+
+// Largest error allowed in the middle of the zone in mm and in the heading into it in degrees
+#define SIM_MAX_ERROR_MM 40
+#define SIM_MAX_HEADING_ERROR 5
+
+// Jittered sweeps of the zone, and how far distances and degrees are jittered
+#define SIM_TRIALS 500
+#define SIM_JITTER_MM 20
+#define SIM_JITTER_DEGREES 1
+
+// Most things in a scene
+#define SIM_MAX_THINGS 12
+
+// Farthest distance objects are counted at, as finish.c reads it from detect.c
+int object_range_mm = FINISH_RANGE_MM;
+
+/// A post or box in a scene, relative to the middle of the robot
+typedef struct {
+    int x, y;       // Middle in mm forward and left
+    int radius;     // Radius of a post, or half the width of a box facing the robot
+} sim_thing_t;
+
+/// A synthetic sweep
+typedef struct {
+    const char *name;
+    int zone_x, zone_y;     // Middle of the zone, 0 0 for no zone
+    int zone_angle;         // Degrees the zone is turned from facing the robot square on
+    int zone_size;          // Spacing of the zone posts, 0 for the default layout
+    int layout;             // Spacing searched for, 0 for the default layout
+    sim_thing_t others[SIM_MAX_THINGS]; // Everything else in the scene
+    int other_count;
+    int expect_posts;       // Posts finish_find should match
+} sim_scene_t;
+
+static const sim_scene_t scenes[] = {
+    { "square on",             480, 0, 0, 0, 0, { { 0 } }, 0, 4 },
+    { "turned 15",             500, 0, 15, 0, 0, { { 0 } }, 0, 4 },
+    { "with clutter",          480, 0, 0, 0, 0, { { 400, 0, 80 }, { 250, -150, 20 }, { 250, 180, 20 } }, 3, 4 },
+    { "corner behind, 30 left", 450, 120, 30, 0, 0, { { 0 } }, 0, 3 },
+    { "corner behind, 45 right", 420, -100, 45, 0, 0, { { 0 } }, 0, 3 },
+    { "corner out of range",   540, 150, 0, 0, 0, { { 0 } }, 0, 3 },
+    { "post hidden behind",    500, 200, 0, 400, 400, { { 0 } }, 0, 3 },
+    { "far posts out of range", 700, 0, 0, 0, 0, { { 0 } }, 0, 0 },
+    { "posts too close",       400, 0, 0, 400, 0, { { 0 } }, 0, 0 },
+    { "two posts only",        0, 0, 0, 0, 0, { { 400, 305, 20 }, { 400, -305, 20 } }, 2, 0 },
+    { "boxes, no posts",       0, 0, 0, 0, 0, { { 300, 0, 150 }, { 500, 300, 120 }, { 450, -300, 200 } }, 3, 0 },
+};
+
+/// Returns a random number from -1 to 1
+static double jitter(void)
+{
+
+    return rand() * 2.0 / RAND_MAX - 1;
+
+}
+
+/// Makes the object records a sweep of some things would give
+/** @param things The posts and boxes.
+ * @param count The number of things.
+ * @param noise 1 to jitter the distances and degrees.
+ * @param list Filled in with the objects, in order of degree like detect_objects.
+ * @return The number of objects
+ */
+static int make_sweep(const sim_thing_t *things, int count, int noise, object_t *list)
+{
+
+    double start[SIM_MAX_THINGS + 4], end[SIM_MAX_THINGS + 4], face[SIM_MAX_THINGS + 4];
+    int seen[SIM_MAX_THINGS + 4];
+    int n = 0;
+    int i, j;
+
+    for (i = 0; i < count; i++) {
+        double dx = things[i].x - SWEEP_SENSOR_OFFSET_MM, dy = things[i].y;
+        double range = hypot(dx, dy);
+        double degree = atan2(dy, dx) * 180 / M_PI + 90;
+        double half = asin(things[i].radius / range) * 180 / M_PI + SIM_BEAM_DEGREES;
+
+        if (noise) {
+            degree += jitter() * SIM_JITTER_DEGREES;
+            range += jitter() * SIM_JITTER_MM;
+        }
+        start[i] = degree - half;
+        end[i] = degree + half;
+        face[i] = range - things[i].radius;
+        seen[i] = face[i] >= OBJECT_MIN_MM && face[i] <= object_range_mm;
+    }
+
+    // A closer object hides whatever is behind it
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < count; j++) {
+            if (j != i && seen[j] && face[j] < face[i] && start[i] < end[j] && end[i] > start[j]) {
+                seen[i] = 0;
+            }
+        }
+    }
+
+    // List them in order of degree
+    for (;;) {
+        int next = -1;
+        for (i = 0; i < count; i++) {
+            if (seen[i] && (next < 0 || start[i] < start[next])) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        seen[next] = 0;
+
+        int first = (int) ceil(start[next] < 0 ? 0 : start[next]);
+        int last = (int) floor(end[next] > 180 ? 180 : end[next]);
+        int degrees = last - first + 1;
+        if (degrees < OBJECT_MIN_DEGREES || n == OBJECT_MAX) {
+            continue;
+        }
+
+        object_t *object = &list[n++];
+        object->id = n;
+        object->start_degree = first;
+        object->end_degree = last;
+        object->mean_mm = (int) face[next];
+        object->min_mm = (int) face[next];
+        object->samples = degrees;
+        object->width_mm = (int) (object->mean_mm * 2 * tan(degrees / 2.0 * M_PI / 180));
+    }
+
+    return n;
+
+}
+
+/// Builds the things of a scene, with the zone posts first
+/** @return The number of things */
+static int build_scene(const sim_scene_t *scene, sim_thing_t *things)
+{
+
+    int n = 0;
+    int i;
+
+    if (scene->zone_x != 0 || scene->zone_y != 0) {
+        double size = scene->zone_size ? scene->zone_size : FINISH_LENGTH_MM;
+        double angle = scene->zone_angle * M_PI / 180;
+        for (i = 0; i < 4; i++) {
+            double cx = (i == 0 || i == 3) ? -size / 2 : size / 2;
+            double cy = (i < 2) ? -size / 2 : size / 2;
+            things[n].x = (int) lround(scene->zone_x + cx * cos(angle) - cy * sin(angle));
+            things[n].y = (int) lround(scene->zone_y + cx * sin(angle) + cy * cos(angle));
+            things[n].radius = FINISH_POST_RADIUS_MM;
+            n++;
+        }
+    }
+    for (i = 0; i < scene->other_count; i++) {
+        things[n++] = scene->others[i];
+    }
+    return n;
+
+}
+
+/// Returns the difference between two angles in degrees, from 0 to 180
+static int angle_difference(int a, int b)
+{
+
+    int difference = abs(a - b) % 360;
+    return difference > 180 ? 360 - difference : difference;
+
+}
+
+/// Returns 1 if a heading runs along one of the zone's sides, into the zone
+static int heading_ok(const sim_scene_t *scene, const finish_zone_t *zone)
+{
+
+    int side;
+
+    for (side = 0; side < 360; side += 90) {
+        if (angle_difference(zone->heading, scene->zone_angle + side) <= SIM_MAX_HEADING_ERROR) {
+            double rad = zone->heading * M_PI / 180;
+            return cos(rad) * zone->x_mm + sin(rad) * zone->y_mm > 0;
+        }
+    }
+    return 0;
+
+}
+
+/// Runs one synthetic scene
+/** @return 1 if the right number of posts were matched in the right place */
+static int run_scene(const sim_scene_t *scene)
+{
+
+    sim_thing_t things[SIM_MAX_THINGS + 4];
+    object_t list[OBJECT_MAX];
+    finish_zone_t zone;
+
+    finish_geometry.length_mm = scene->layout ? scene->layout : FINISH_LENGTH_MM;
+    finish_geometry.width_mm = scene->layout ? scene->layout : FINISH_WIDTH_MM;
+
+    int count = make_sweep(things, build_scene(scene, things), 0, list);
+    int posts = finish_find(list, count, &zone);
+    int pass = posts == scene->expect_posts;
+
+    if (posts > 0) {
+        double error = hypot(zone.x_mm - scene->zone_x, zone.y_mm - scene->zone_y);
+        pass = pass && error <= SIM_MAX_ERROR_MM && heading_ok(scene, &zone);
+        printf("%-24s %7d %10d %5d %5d %6d %7d %7d %8.0f   %s\n", scene->name, count, zone.candidates, posts,
+               zone.x_mm, zone.y_mm, zone.bearing, zone.heading, error, pass ? "ok" : "FAIL");
+    } else {
+        printf("%-24s %7d %10d %5d %5s %6s %7s %7s %8s   %s\n", scene->name, count, zone.candidates, posts,
+               "-", "-", "-", "-", "-", pass ? "ok" : "FAIL");
+    }
+    return pass;
+
+}
+
+/// Sweeps the first scene many times with jitter
+/** @return 1 if the zone was found in the right place nearly every time */
+static int run_jitter(void)
+{
+
+    sim_thing_t things[SIM_MAX_THINGS + 4];
+    object_t list[OBJECT_MAX];
+    finish_zone_t zone;
+    const sim_scene_t *scene = &scenes[1];
+    int found = 0, wrong = 0;
+
+    finish_geometry.length_mm = FINISH_LENGTH_MM;
+    finish_geometry.width_mm = FINISH_WIDTH_MM;
+    double total_error = 0;
+    int trial;
+
+    srand(288);
+    for (trial = 0; trial < SIM_TRIALS; trial++) {
+        int count = make_sweep(things, build_scene(scene, things), 1, list);
+        if (finish_find(list, count, &zone) > 0) {
+            double error = hypot(zone.x_mm - scene->zone_x, zone.y_mm - scene->zone_y);
+            if (error > SIM_MAX_ERROR_MM) {
+                wrong++;
+            } else {
+                found++;
+                total_error += error;
+            }
+        }
+    }
+
+    int pass = found >= SIM_TRIALS * 95 / 100 && wrong == 0;
+    printf("\n%s, jittered %d mm and %d degree: found %d of %d, %d in the wrong place, %.1f mm off on average   %s\n",
+           scene->name, SIM_JITTER_MM, SIM_JITTER_DEGREES, found, SIM_TRIALS, wrong,
+           found ? total_error / found : 0, pass ? "ok" : "FAIL");
+    return pass;
+
+}
+
+/// Reads a number after a label such as "Avg_Ping: 45.3", in tenths if it has a decimal point
+static int read_value(const char *line, const char *label, int *value)
+{
+
+    const char *text = strstr(line, label);
+    if (text == NULL) {
+        return 0;
+    }
+    *value = (int) lround(atof(text + strlen(label)) * (strchr(text, '.') ? 10 : 1));
+    return 1;
+
+}
+
+/// Finds the zone in a recorded sweep
+/** @return 1 if there was no expected answer or the answer matched */
+static int run_capture(const char *name)
+{
+
+    FILE *file = fopen(name, "r");
+    char line[200];
+    object_t list[OBJECT_MAX];
+    finish_zone_t zone;
+    int count = -1;
+    int expect_posts = -1, expect_x = 0, expect_y = 0;
+
+    if (file == NULL) {
+        perror(name);
+        return 0;
+    }
+
+    // The text tables give distances in cm with one decimal, turned back into mm here
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "# expect %d %d %d", &expect_posts, &expect_x, &expect_y) >= 1) {
+            continue;
+        }
+        if (strstr(line, "NEW OBJECT") != NULL && count < OBJECT_MAX - 1) {
+            count++;
+            memset(&list[count], 0, sizeof(list[count]));
+            list[count].id = count + 1;
+        }
+        if (count < 0) {
+            continue;
+        }
+        read_value(line, "Avg_Ping:", &list[count].mean_mm);
+        read_value(line, "Min_Ping:", &list[count].min_mm);
+        read_value(line, "Width:", &list[count].width_mm);
+        read_value(line, "Start:", &list[count].start_degree);
+        read_value(line, "End:", &list[count].end_degree);
+        read_value(line, "Samples:", &list[count].samples);
+    }
+    fclose(file);
+
+    int posts = finish_find(list, count + 1, &zone);
+    int pass = expect_posts < 0 || (posts == expect_posts
+            && (posts == 0 || hypot(zone.x_mm - expect_x, zone.y_mm - expect_y) <= SIM_MAX_ERROR_MM));
+
+    printf("%s: %d objects, %d posts matched", name, count + 1, posts);
+    if (posts > 0) {
+        printf(", zone at %d, %d mm, bearing %d, heading %d, spacing off by %d mm", zone.x_mm, zone.y_mm,
+               zone.bearing, zone.heading, zone.error_mm);
+    }
+    printf("   %s\n", expect_posts < 0 ? "" : (pass ? "ok" : "FAIL"));
+    return pass;
+
+}
+
+int main(int argc, char *argv[])
+{
+
+    unsigned i;
+    int failed = 0;
+
+    if (argc > 1) {
+        for (i = 1; i < (unsigned) argc; i++) {
+            failed += !run_capture(argv[i]);
+        }
+        return failed ? 1 : 0;
+    }
+
+    printf("Zone %d x %d mm, tolerance %d mm, objects counted out to %d mm\n\n",
+           FINISH_LENGTH_MM, FINISH_WIDTH_MM, FINISH_TOLERANCE_MM, object_range_mm);
+    printf("scene                    objects candidates posts     x      y bearing heading  off mm\n");
+
+    for (i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+        failed += !run_scene(&scenes[i]);
+    }
+    failed += !run_jitter();
+
+    return failed ? 1 : 0;
+
+}
@@ -0,0 +1,22 @@
+/*
+ * interrupt.h
+ *
+ *  Created on: May 9, 2018
+ *      Author: mmorth
+ */
+
+// Host stand-in for the TivaWare interrupt functions. Nothing interrupts on the host, so these only keep track of the mask.
+
+#ifndef INTERRUPT_H_
+#define INTERRUPT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+bool IntMasterDisable(void);
+
+bool IntMasterEnable(void);
+
+void IntRegister(uint32_t interrupt, void (*handler)(void));
+
+#endif /* INTERRUPT_H_ */
@@ -0,0 +1,21 @@
+/*
+ * sysctl.h
+ *
+ *  Created on: May 9, 2018
+ *      Author: mmorth
+ */
+
+// Host stand-in for the TivaWare system control functions, running at the robot's 16 MHz
+
+#ifndef SYSCTL_H_
+#define SYSCTL_H_
+
+#include <stdint.h>
+
+uint32_t SysCtlClockGet(void);
+
+void SysCtlDelay(uint32_t count);
+
+void SysCtlSleep(void);
+
+#endif /* SYSCTL_H_ */
@@ -0,0 +1,188 @@
+/**
+ * @file host.c
+ * @brief Simulated peripherals for building firmware files into the host tools.
+ *
+ * The registers are plain variables, the system tick is a count of simulated milliseconds, the cycle counter follows
+ * the simulated time, and the busy waits move the simulated time forward instead of spinning, calling the tick hooks
+ * on the way like the Timer2A interrupt.
+ * A tool moves the time forward with host_advance_us or host_tick and stands in for any other peripheral it needs.
+ *
+ * Build a tool with: cc -std=c99 -Ihost -o tool tool.c ../firmware.c host/host.c
+ * Strict C99 keeps the host headers from declaring their own clock_t, which Timer.h declares too.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/9/2018
+ */
+
+#include "host.h"
+#include "../../Timer.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+
+#define HOST_REGISTER(name) volatile uint32_t name;
+#include "registers.h"
+#undef HOST_REGISTER
+
+volatile uint32_t _timer_ticks = 0;
+uint64_t host_us = 0;
+
+static void (*tick_hooks[TIMER_TICK_HOOKS])(void);
+static bool interrupts_masked = false;
+
+/// Moves the simulated time forward to the next system tick
+/** This method counts a tick and calls the tick hooks, like the Timer2A interrupt.
+ */
+void host_tick(void)
+{
+
+    int i;
+
+    host_us = (uint64_t) (_timer_ticks + 1) * 1000;
+    _timer_ticks++;
+
+    for (i = 0; i < TIMER_TICK_HOOKS; i++) {
+        if (tick_hooks[i]) {
+            tick_hooks[i]();
+        }
+    }
+
+}
+
+/// Moves the simulated time forward
+/** @param us The microseconds to move forward. Every millisecond boundary passed is a system tick.
+ */
+void host_advance_us(uint32_t us)
+{
+
+    uint64_t end = host_us + us;
+
+    while ((uint64_t) (_timer_ticks + 1) * 1000 <= end) {
+        host_tick();
+    }
+    host_us = end;
+
+}
+
+/// Starts the simulated time over and forgets the tick hooks
+void host_reset(void)
+{
+
+    int i;
+
+    for (i = 0; i < TIMER_TICK_HOOKS; i++) {
+        tick_hooks[i] = 0;
+    }
+    _timer_ticks = 0;
+    host_us = 0;
+
+}
+
+void timer_waitMillis(uint32_t millis)
+{
+
+    host_advance_us(millis * 1000);
+
+}
+
+void timer_waitMicros(uint16_t micros)
+{
+
+    host_advance_us(micros);
+
+}
+
+void timer_tickInit(void)
+{
+
+}
+
+int timer_addTickHook(void (*hook)(void))
+{
+
+    int i;
+
+    for (i = 0; i < TIMER_TICK_HOOKS; i++) {
+        if (tick_hooks[i] == hook) {
+            return 1;
+        }
+    }
+    for (i = 0; i < TIMER_TICK_HOOKS; i++) {
+        if (tick_hooks[i] == 0) {
+            tick_hooks[i] = hook;
+            return 1;
+        }
+    }
+    return 0;
+
+}
+
+uint32_t timer_getMillis(void)
+{
+
+    return _timer_ticks;
+
+}
+
+// SysTick counts down once per cycle of the 16 MHz clock over 24 bits
+uint32_t timer_getCycles(void)
+{
+
+    return (uint32_t) (0 - host_us * 16) & 0x00FFFFFF;
+
+}
+
+uint32_t timer_cyclesSince(uint32_t start)
+{
+
+    return (start - timer_getCycles()) & 0x00FFFFFF;
+
+}
+
+bool IntMasterDisable(void)
+{
+
+    bool was = interrupts_masked;
+    interrupts_masked = true;
+    return was;
+
+}
+
+bool IntMasterEnable(void)
+{
+
+    bool was = interrupts_masked;
+    interrupts_masked = false;
+    return was;
+
+}
+
+void IntRegister(uint32_t interrupt, void (*handler)(void))
+{
+
+    (void) interrupt;
+    (void) handler;
+
+}
+
+uint32_t SysCtlClockGet(void)
+{
+
+    return 16000000;
+
+}
+
+void SysCtlDelay(uint32_t count)
+{
+
+    // Each count is 3 clock cycles
+    host_advance_us(count * 3 / 16);
+
+}
+
+void SysCtlSleep(void)
+{
+
+    host_tick();
+
+}
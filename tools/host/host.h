@@ -0,0 +1,25 @@
+/*
+ * host.h
+ *
+ *  Created on: May 9, 2018
+ *      Author: mmorth
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <stdint.h>
+
+// Microseconds of simulated time since the start
+extern uint64_t host_us;
+
+// Moves the simulated time forward, counting a system tick and calling the tick hooks at every millisecond
+void host_advance_us(uint32_t us);
+
+// Moves the simulated time forward to the next system tick
+void host_tick(void);
+
+// Starts the simulated time over and forgets the tick hooks
+void host_reset(void);
+
+#endif /* HOST_H_ */
@@ -0,0 +1,57 @@
+/*
+ * tm4c123gh6pm.h
+ *
+ *  Created on: May 9, 2018
+ *      Author: mmorth
+ */
+
+// Host stand-in for the TivaWare register header. The registers are plain variables defined in host.c,
+// so firmware files can be built into the host tools and their register writes read back.
+
+#ifndef TM4C123GH6PM_H_
+#define TM4C123GH6PM_H_
+
+#include <stdint.h>
+
+#define HOST_REGISTER(name) extern volatile uint32_t name;
+#include "../registers.h"
+#undef HOST_REGISTER
+
+// Register bits, with the values of the real header
+#define ADC_ACTSS_ASEN1         0x00000002
+#define ADC_EMUX_EM1_M          0x000000F0
+#define ADC_EMUX_EM1_PROCESSOR  0x00000000
+#define ADC_EMUX_EM1_TIMER      0x00000050
+#define ADC_ISC_IN1             0x00000002
+#define ADC_SAC_AVG_64X         0x00000006
+#define ADC_SSCTL1_END0         0x00000002
+#define ADC_SSCTL1_IE0          0x00000004
+#define SYSCTL_RCGCDMA_R0       0x00000001
+#define SYSCTL_RCGCGPIO_R1      0x00000002
+#define SYSCTL_RCGCTIMER_R0     0x00000001
+#define SYSCTL_RCGCTIMER_R1     0x00000002
+#define SYSCTL_RCGCTIMER_R3     0x00000008
+#define TIMER_CFG_16_BIT        0x00000004
+#define TIMER_CFG_32_BIT_TIMER  0x00000000
+#define TIMER_CTL_TAEN          0x00000001
+#define TIMER_CTL_TAOTE         0x00000020
+#define TIMER_CTL_TBEN          0x00000100
+#define TIMER_CTL_TBEVENT_BOTH  0x00000C00
+#define TIMER_ICR_CBECINT       0x00000400
+#define TIMER_ICR_TATOCINT      0x00000001
+#define TIMER_IMR_CBEIM         0x00000400
+#define TIMER_IMR_TATOIM        0x00000001
+#define TIMER_TAMR_TAMR_1_SHOT  0x00000001
+#define TIMER_TAMR_TAMR_PERIOD  0x00000002
+#define TIMER_TBMR_TBAMS        0x00000008
+#define TIMER_TBMR_TBCMR        0x00000004
+#define TIMER_TBMR_TBMR_CAP     0x00000003
+#define TIMER_TBMR_TBMR_PERIOD  0x00000002
+#define UDMA_CFG_MASTEN         0x00000001
+
+// Interrupt numbers
+#define INT_ADC0SS1             31
+#define INT_TIMER3A             51
+#define INT_TIMER3B             52
+
+#endif /* TM4C123GH6PM_H_ */
@@ -0,0 +1,67 @@
+/*
+ * registers.h
+ *
+ *  Created on: May 9, 2018
+ *      Author: mmorth
+ */
+
+// Peripheral registers used by the firmware files the host tools build. Each one is a plain variable on the host.
+// Included twice: by inc/tm4c123gh6pm.h to declare them and by host.c to define them.
+
+// distance.c
+HOST_REGISTER(ADC0_ACTSS_R)
+HOST_REGISTER(ADC0_EMUX_R)
+HOST_REGISTER(ADC0_ISC_R)
+HOST_REGISTER(ADC0_SAC_R)
+HOST_REGISTER(ADC0_SSCTL1_R)
+HOST_REGISTER(ADC0_SSFIFO1_R)
+HOST_REGISTER(ADC0_SSMUX1_R)
+HOST_REGISTER(GPIO_PORTB_ADCCTL_R)
+HOST_REGISTER(GPIO_PORTB_AMSEL_R)
+HOST_REGISTER(NVIC_EN0_R)
+HOST_REGISTER(SYSCTL_RCGCADC_R)
+HOST_REGISTER(SYSCTL_RCGCDMA_R)
+HOST_REGISTER(TIMER0_CFG_R)
+HOST_REGISTER(TIMER0_CTL_R)
+HOST_REGISTER(TIMER0_TAILR_R)
+HOST_REGISTER(TIMER0_TAMR_R)
+HOST_REGISTER(UDMA_ALTCLR_R)
+HOST_REGISTER(UDMA_CFG_R)
+HOST_REGISTER(UDMA_CHMAP1_R)
+HOST_REGISTER(UDMA_CTLBASE_R)
+HOST_REGISTER(UDMA_ENASET_R)
+HOST_REGISTER(UDMA_PRIOCLR_R)
+HOST_REGISTER(UDMA_REQMASKCLR_R)
+HOST_REGISTER(UDMA_USEBURSTCLR_R)
+
+// ping.c
+HOST_REGISTER(GPIO_PORTB_DATA_R)
+HOST_REGISTER(NVIC_EN1_R)
+HOST_REGISTER(NVIC_PRI8_R)
+HOST_REGISTER(NVIC_PRI9_R)
+HOST_REGISTER(TIMER3_CFG_R)
+HOST_REGISTER(TIMER3_CTL_R)
+HOST_REGISTER(TIMER3_ICR_R)
+HOST_REGISTER(TIMER3_IMR_R)
+HOST_REGISTER(TIMER3_TAILR_R)
+HOST_REGISTER(TIMER3_TAMR_R)
+HOST_REGISTER(TIMER3_TAPR_R)
+HOST_REGISTER(TIMER3_TBILR_R)
+HOST_REGISTER(TIMER3_TBMR_R)
+HOST_REGISTER(TIMER3_TBPR_R)
+HOST_REGISTER(TIMER3_TBR_R)
+
+// pwm.c, and the ports and clocks distance.c and ping.c share with it
+HOST_REGISTER(GPIO_PORTB_AFSEL_R)
+HOST_REGISTER(GPIO_PORTB_DEN_R)
+HOST_REGISTER(GPIO_PORTB_DIR_R)
+HOST_REGISTER(GPIO_PORTB_PCTL_R)
+HOST_REGISTER(SYSCTL_RCGCGPIO_R)
+HOST_REGISTER(SYSCTL_RCGCTIMER_R)
+HOST_REGISTER(TIMER1_CFG_R)
+HOST_REGISTER(TIMER1_CTL_R)
+HOST_REGISTER(TIMER1_TBILR_R)
+HOST_REGISTER(TIMER1_TBMATCHR_R)
+HOST_REGISTER(TIMER1_TBMR_R)
+HOST_REGISTER(TIMER1_TBPMR_R)
+HOST_REGISTER(TIMER1_TBPR_R)
@@ -0,0 +1,220 @@
+/**
+ * @file ir_buffer_sim.c
+ * @brief Host side simulation of the uDMA ping-pong transfer of IR samples in ir_buffer.c.
+ *
+ * Stands in for the uDMA controller: each simulated ADC conversion copies one sample through the control structure
+ * in use, a structure that is done is left in stop mode and the controller swaps to the other one, and swapping to a
+ * structure that is still in stop mode stops the channel. The completion interrupt runs a number of samples after the
+ * completion, and the handler does what ADC0SS1_Handler does.
+ *
+ * Each run feeds a ramp of samples with the interrupt on time, late by less than a half, and late by up to two
+ * halves. After every interrupt the average has to be that of the half filled last, the count has to match the
+ * completions, and a stopped channel has to be running again. The old handler, which checked the primary structure
+ * before the alternate and never restarted the channel, runs the same completions for comparison.
+ *
+ * Build: cc -std=c99 -o ir_buffer_sim ir_buffer_sim.c ../ir_buffer.c
+ * Usage: ir_buffer_sim
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/9/2018
+ */
+
+#include <stdio.h>
+#include "../ir_buffer.h"
+
+// Samples fed in each run
+#define SIM_SAMPLES 40000
+
+static volatile uint32_t table[2][4]; // Simulated primary and alternate control structures
+static volatile uint32_t fifo; // Simulated ADC0 SS1 FIFO
+
+// Simulated controller
+static int active; // Structure in use
+static int enabled; // 0 once the channel is stopped
+static int pending; // 1 while a completion interrupt is waiting
+static int last_filled; // Half that was filled last
+static unsigned filled_average[2]; // Average of the samples that went into each half
+static uint32_t completions; // Halves filled
+static int stops; // Times the channel was stopped
+static int dropped; // Samples lost while it was stopped
+
+static int old_handler; // 1 to run the old handler instead of ir_buffer_complete
+static int old_latest; // Latest half of the old handler
+
+/// Starts the simulated controller over
+static void dma_reset(void)
+{
+
+    active = 0;
+    enabled = 1;
+    pending = 0;
+    last_filled = 0;
+    completions = 0;
+    stops = 0;
+    dropped = 0;
+    old_latest = 0;
+    ir_buffer_init(table[0], table[1], &fifo);
+
+}
+
+/// Copies one sample through the structure in use, like a uDMA request from the ADC
+/** @param sample The ADC reading.
+ */
+static void dma_request(uint32_t sample)
+{
+
+    static uint32_t sum[2];
+
+    if (!enabled) {
+        dropped++;
+        return;
+    }
+
+    uint32_t control = table[active][DMA_CTL];
+    int left = ((control & DMA_CTL_XFERSIZE_M) >> 4) + 1;
+    int index = IR_DMA_HALF - left;
+
+    fifo = sample;
+    ir_buffer_half(active)[index] = fifo;
+    sum[active] = (index == 0 ? 0 : sum[active]) + (sample & 0xFFF);
+
+    if (left > 1) {
+        table[active][DMA_CTL] = (control & ~DMA_CTL_XFERSIZE_M) | ((uint32_t) (left - 2) << 4);
+        return;
+    }
+
+    // Done: leave the structure in stop mode, signal the interrupt, and swap
+    table[active][DMA_CTL] = control & ~(DMA_CTL_XFERSIZE_M | DMA_CTL_MODE_M);
+    filled_average[active] = sum[active] / IR_DMA_HALF;
+    last_filled = active;
+    completions++;
+    pending = 1;
+    active = 1 - active;
+    if ((table[active][DMA_CTL] & DMA_CTL_MODE_M) == 0) {
+        enabled = 0;
+        stops++;
+    }
+
+}
+
+/// Runs the completion interrupt
+/** This method does what ADC0SS1_Handler does, or what it did before ir_buffer.c.
+ */
+static void dma_interrupt(void)
+{
+
+    pending = 0;
+
+    if (old_handler) {
+        int half;
+        for (half = 0; half < 2; half++) {
+            if ((table[half][DMA_CTL] & DMA_CTL_MODE_M) == 0) {
+                old_latest = half;
+                table[half][DMA_CTL] = DMA_CTL_PINGPONG;
+            }
+        }
+    } else if (ir_buffer_complete()) {
+        // UDMA_ALTCLR_R and UDMA_ENASET_R
+        active = 0;
+        enabled = 1;
+    }
+
+}
+
+/// Returns the average the handler under test reports
+static unsigned handler_average(void)
+{
+
+    const volatile uint32_t *half = ir_buffer_half(old_latest);
+    uint32_t sum = 0;
+    int i;
+
+    if (!old_handler) {
+        return ir_buffer_average();
+    }
+    for (i = 0; i < IR_DMA_HALF; i++) {
+        sum += half[i] & 0xFFF;
+    }
+    return sum / IR_DMA_HALF;
+
+}
+
+/// Feeds a run of samples
+/** @param max_late The most samples the interrupt runs after a completion. The lateness of each interrupt
+ * cycles through 0 to max_late.
+ * @param name Name of the run to print.
+ * @return 1 if the handler under test got everything right, 0 otherwise
+ */
+static int run(int max_late, const char *name)
+{
+
+    int i;
+    int late = 0;
+    int due = -1;
+    int stale = 0;
+    int miscounted = 0;
+    uint32_t interrupts = 0;
+
+    dma_reset();
+
+    for (i = 0; i < SIM_SAMPLES; i++) {
+        // A ramp with bits above the 12 bit result, which the average has to ignore
+        dma_request(0xF000 | ((i * 7) & 0xFFF));
+
+        if (pending && due < 0) {
+            due = i + late;
+            late = (late + 1) % (max_late + 1);
+        }
+        if (due >= 0 && i >= due) {
+            dma_interrupt();
+            interrupts++;
+            due = -1;
+            if (handler_average() != filled_average[last_filled]) {
+                stale++;
+            }
+            if (!old_handler && ir_buffer_count() != completions) {
+                miscounted++;
+            }
+        }
+    }
+
+    int ok = stale == 0 && miscounted == 0 && enabled;
+    printf("  %-8s %-28s %5u halves, %5u interrupts, %4d stale averages, %3d stops, %5d samples lost, %s%s\n",
+            old_handler ? "old" : "new", name, (unsigned) completions, (unsigned) interrupts, stale, stops, dropped,
+            enabled ? "running" : "stopped", (!old_handler && !ok) ? " FAIL" : "");
+    return ok;
+
+}
+
+int main(void)
+{
+
+    int failed = 0;
+    int half;
+
+    dma_reset();
+    for (half = 0; half < 2; half++) {
+        if (table[half][DMA_SRC] != (uint32_t) (uintptr_t) &fifo
+                || table[half][DMA_DST] != (uint32_t) (uintptr_t) (ir_buffer_half(half) + IR_DMA_HALF - 1)
+                || table[half][DMA_CTL] != DMA_CTL_PINGPONG) {
+            printf("FAIL: control structure %d does not point at its half\n", half);
+            failed = 1;
+        }
+    }
+
+    printf("%d samples in each run, %d per half:\n", SIM_SAMPLES, IR_DMA_HALF);
+    for (old_handler = 1; old_handler >= 0; old_handler--) {
+        int ok = 1;
+        ok &= run(0, "interrupt on time");
+        ok &= run(IR_DMA_HALF - 1, "late by less than a half");
+        ok &= run(2 * IR_DMA_HALF, "late by up to two halves");
+        if (!old_handler && !ok) {
+            failed = 1;
+        }
+    }
+
+    printf(failed ? "FAIL\n" : "All checks passed\n");
+    return failed;
+
+}
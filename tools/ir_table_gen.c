@@ -0,0 +1,60 @@
+/**
+ * @file ir_table_gen.c
+ * @brief Generates ir_table.h, the IR distance table ir_to_mm interpolates.
+ *
+ * Builds distance.c with the simulated peripherals in host/ and evaluates convert_distance at every 16th
+ * quantization number, so the table always follows the curve the robot was calibrated with. Run it again
+ * after changing convert_distance, then run conversion_check.
+ *
+ * Build: cc -std=c99 -Ihost -o ir_table_gen ir_table_gen.c ../distance.c ../ir_buffer.c ../ping.c host/host.c -lm
+ * Usage: ir_table_gen > ../ir_table.h
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/9/2018
+ */
+
+#include <stdio.h>
+#include "../distance.h"
+
+// Entries written on each line of the table
+#define GEN_PER_LINE 12
+
+// Largest distance a table entry holds
+#define GEN_MAX_MM 65535
+
+int main(void)
+{
+
+    int i;
+
+    printf("/*\n");
+    printf(" * ir_table.h\n");
+    printf(" *\n");
+    printf(" *  Generated by tools/ir_table_gen.c. Change convert_distance and run it again instead of editing this file.\n");
+    printf(" */\n");
+    printf("\n");
+    printf("#ifndef IR_TABLE_H_\n");
+    printf("#define IR_TABLE_H_\n");
+    printf("\n");
+    printf("/// IR distance in mm for every 16th quantization number, from convert_distance in mm\n");
+    printf("/** Entry i is the distance at quantization number 16 * i, rounded. Distances past %dmm are clamped.\n", GEN_MAX_MM);
+    printf(" * tools/conversion_check.c checks how far ir_to_mm strays from convert_distance.\n");
+    printf(" */\n");
+    printf("static const uint16_t ir_table_mm[IR_TABLE_SIZE] = {");
+
+    for (i = 0; i < IR_TABLE_SIZE; i++) {
+        // Quantization number 0 is an infinite distance
+        double mm = (i == 0) ? GEN_MAX_MM : convert_distance(16 * i) * 10;
+        int entry = (mm >= GEN_MAX_MM) ? GEN_MAX_MM : (int) (mm + 0.5);
+
+        printf("%s%d", (i % GEN_PER_LINE == 0) ? (i == 0 ? "\n    " : ",\n    ") : ", ", entry);
+    }
+
+    printf("\n};\n");
+    printf("\n");
+    printf("#endif /* IR_TABLE_H_ */\n");
+
+    return 0;
+
+}
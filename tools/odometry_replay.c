@@ -0,0 +1,242 @@
+/**
+ * @file odometry_replay.c
+ * @brief Host side replay of wheel encoder counts through the odometry in odometry.c.
+ *
+ * With no arguments, drives a few simulated paths (a straight line, ten turns in place, a square and an arc)
+ * and feeds the raw 16 bit encoder counts to the odometry every 15ms, like the motion stream does. The counts
+ * start near 65535 so they wrap around early. Each path compares the final pose against where the robot really is,
+ * and the heading against the old getDegrees math (truncated millimeters per wheel, integer degrees per frame),
+ * and fails if the odometry is off by more than the limits below.
+ *
+ * With a file argument, replays a capture of "ms left right" lines (raw counts, one frame per line) and prints
+ * the pose every second and at the end.
+ *
+ * Build: cc -std=c99 -o odometry_replay odometry_replay.c ../odometry.c -lm
+ * Usage: odometry_replay [capture.txt]
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/5/2018
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "../odometry.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Time between encoder frames
+#define REPLAY_FRAME_MS 15
+
+// Wheel size, encoder counts per wheel turn and millimeters between the wheels of the simulated robot.
+// These are the Roomba's, not the firmware's constants, so a wrong constant shows up as an error.
+#define REPLAY_WHEEL_MM 72.0
+#define REPLAY_COUNTS_PER_TURN 508.8
+#define REPLAY_MM_PER_COUNT (REPLAY_WHEEL_MM * M_PI / REPLAY_COUNTS_PER_TURN)
+#define REPLAY_WHEELBASE 235.0
+
+// Encoder count both wheels start at, close enough to 65535 to wrap in the first second
+#define REPLAY_START_COUNT 65000
+
+// Largest position error in mm and heading error in degrees allowed at the end of a path
+#define REPLAY_MAX_POSITION_MM 5.0
+#define REPLAY_MAX_HEADING_DEG 1.0
+
+/// One stretch of a path at steady wheel speeds
+typedef struct {
+    double left;  // Left wheel speed in mm/s
+    double right; // Right wheel speed in mm/s
+    int time_ms;  // How long to drive
+} replay_segment_t;
+
+/// A simulated path
+typedef struct {
+    const char *name;
+    replay_segment_t segments[8];
+    int count;
+} replay_path_t;
+
+// Time to turn 90 degrees in place with both wheels at 100 mm/s
+#define REPLAY_QUARTER_MS ((int) (REPLAY_WHEELBASE * M_PI / 4 / 100 * 1000 + 0.5))
+
+static const replay_path_t paths[] = {
+    { "straight 2m", { { 200, 200, 10000 } }, 1 },
+    { "10 turns in place", { { -200, 200, (int) (10 * REPLAY_WHEELBASE * M_PI / 200 * 1000 + 0.5) } }, 1 },
+    { "1m square", { { 200, 200, 5000 }, { -100, 100, REPLAY_QUARTER_MS },
+                     { 200, 200, 5000 }, { -100, 100, REPLAY_QUARTER_MS },
+                     { 200, 200, 5000 }, { -100, 100, REPLAY_QUARTER_MS },
+                     { 200, 200, 5000 }, { -100, 100, REPLAY_QUARTER_MS } }, 8 },
+    { "arc", { { 150, 250, 10000 } }, 1 },
+};
+
+/// Turns the old getDegrees math on one frame of counts
+/** @param left The left count of this frame.
+ * @param right The right count of this frame.
+ * @param last_left The left count of the last frame, updated.
+ * @param last_right The right count of the last frame, updated.
+ * @return The degrees turned, as the firmware used to add them to the angle
+ */
+static int legacy_degrees(uint16_t left, uint16_t right, int *last_left, int *last_right)
+{
+
+    int dist_left = (left - *last_left) * (0.445265);
+    int dist_right = (right - *last_right) * (0.445265);
+    *last_left = left;
+    *last_right = right;
+
+    double deg = (dist_right - dist_left) / 178.5;
+    return deg * 180 / M_PI;
+
+}
+
+/// Returns an angle in degrees moved into -180 to 180
+/** @param degrees The angle.
+ * @return The same angle within half a turn of 0
+ */
+static double wrap_degrees(double degrees)
+{
+
+    degrees = fmod(degrees, 360);
+    if (degrees >= 180) {
+        degrees -= 360;
+    } else if (degrees < -180) {
+        degrees += 360;
+    }
+    return degrees;
+
+}
+
+/// Drives one simulated path
+/** @param path The path.
+ * @return 1 if the odometry stayed within the limits, 0 if not
+ */
+static int simulate(const replay_path_t *path)
+{
+
+    double x = 0, y = 0, heading = 0;
+    double left_mm = 0, right_mm = 0;
+    int legacy_left = REPLAY_START_COUNT, legacy_right = REPLAY_START_COUNT;
+    long legacy_angle = 0;
+    int now = 0;
+    int i, t;
+
+    odometry_reset();
+    odometry_update(REPLAY_START_COUNT, REPLAY_START_COUNT, now);
+
+    for (i = 0; i < path->count; i++) {
+        const replay_segment_t *segment = &path->segments[i];
+        for (t = 0; t < segment->time_ms; t++) {
+            // The true pose moves along the arc of each millisecond
+            double left = segment->left / 1000, right = segment->right / 1000;
+            double turn = (right - left) / REPLAY_WHEELBASE;
+            double middle = heading + turn / 2;
+            x += (left + right) / 2 * cos(middle);
+            y += (left + right) / 2 * sin(middle);
+            heading += turn;
+            left_mm += left;
+            right_mm += right;
+            now++;
+
+            // The last frame comes after the robot has stopped
+            int last = (i == path->count - 1 && t == segment->time_ms - 1);
+            if (now % REPLAY_FRAME_MS == 0 || last) {
+                // The encoders only count whole ticks, and wrap around at 16 bits
+                uint16_t left_count = (uint16_t) (REPLAY_START_COUNT + (long) floor(left_mm / REPLAY_MM_PER_COUNT));
+                uint16_t right_count = (uint16_t) (REPLAY_START_COUNT + (long) floor(right_mm / REPLAY_MM_PER_COUNT));
+                odometry_update(left_count, right_count, now);
+                legacy_angle += legacy_degrees(left_count, right_count, &legacy_left, &legacy_right);
+            }
+        }
+    }
+
+    odometry_pose_t pose;
+    odometry_get(&pose);
+    double odometry_x = pose.x / 65536.0, odometry_y = pose.y / 65536.0;
+    double odometry_heading = odometry_heading_tenths(pose.heading) / 10.0;
+    double true_heading = heading * 180 / M_PI;
+
+    double position_error = hypot(odometry_x - x, odometry_y - y);
+    double heading_error = wrap_degrees(odometry_heading - true_heading);
+    double legacy_error = wrap_degrees(legacy_angle - true_heading);
+    int pass = position_error <= REPLAY_MAX_POSITION_MM && fabs(heading_error) <= REPLAY_MAX_HEADING_DEG;
+
+    printf("%-18s %7.1f %7.1f %7.1f | %7.1f %7.1f %7.1f | %6.2f %6.2f | %9.1f | %s\n",
+            path->name, x, y, wrap_degrees(true_heading),
+            odometry_x, odometry_y, odometry_heading, position_error, heading_error,
+            legacy_error, pass ? "ok" : "FAIL");
+
+    return pass;
+
+}
+
+/// Replays a capture of encoder counts
+/** @param file The capture, one "ms left right" line per frame.
+ * @return 0 if the capture was read, 1 if not
+ */
+static int replay(FILE *file)
+{
+
+    unsigned long ms, left, right;
+    unsigned long next_print = 0;
+    int frames = 0;
+    odometry_pose_t pose;
+    int speed, turn_rate;
+
+    odometry_reset();
+    printf("     ms        x mm     y mm   heading  mm/s  deg/s\n");
+
+    while (fscanf(file, "%lu %lu %lu", &ms, &left, &right) == 3) {
+        odometry_update((uint16_t) left, (uint16_t) right, (uint32_t) ms);
+        frames++;
+
+        if (ms >= next_print) {
+            odometry_get(&pose);
+            odometry_velocity(&speed, &turn_rate);
+            printf("%7lu  %9.1f %8.1f %8.1f %5d %6.1f\n", ms, pose.x / 65536.0, pose.y / 65536.0,
+                    odometry_heading_tenths(pose.heading) / 10.0, speed, turn_rate / 10.0);
+            next_print = ms + 1000;
+        }
+    }
+
+    if (frames == 0) {
+        fprintf(stderr, "no frames read\n");
+        return 1;
+    }
+
+    odometry_get(&pose);
+    printf("end after %d frames: x %.1f mm, y %.1f mm, heading %.1f degrees\n", frames,
+            pose.x / 65536.0, pose.y / 65536.0, odometry_heading_tenths(pose.heading) / 10.0);
+    return 0;
+
+}
+
+int main(int argc, char *argv[])
+{
+
+    unsigned i;
+    int failed = 0;
+
+    if (argc > 1) {
+        FILE *file = fopen(argv[1], "r");
+        if (file == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+        int result = replay(file);
+        fclose(file);
+        return result;
+    }
+
+    printf("Frames every %d ms, counts start at %d, limits %.0f mm and %.0f degree\n\n",
+            REPLAY_FRAME_MS, REPLAY_START_COUNT, REPLAY_MAX_POSITION_MM, REPLAY_MAX_HEADING_DEG);
+    printf("path               |    true x       y     deg | odometry x    y     deg |  pos err  deg err | old deg err |\n");
+
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        failed += !simulate(&paths[i]);
+    }
+
+    return failed ? 1 : 0;
+
+}
@@ -0,0 +1,376 @@
+/**
+ * @file plan_sim.c
+ * @brief Host side test of the path planner in plan.c on synthetic courses.
+ *
+ * Stands in for the occupancy grid with courses made of round posts and straight walls, and plans from the
+ * starting pose to a goal on each. A path passes if it reaches the goal, never enters a blocked planning cell,
+ * and keeps the middle of the robot at least PLAN_ROBOT_RADIUS_MM - PLAN_CELL_MM / 2 from every obstacle
+ * (the path runs through the middles of planning cells, so it may cut up to half a cell closer than the radius).
+ * Courses with no way through must report PLAN_NO_PATH.
+ *
+ * The last test drives along the slalom in steps of SIM_DRIVE_MM, seeing only the posts within SIM_SEE_MM like
+ * a sweep would, and replans after each step. The incremental replans must find paths as cheap as planning again
+ * from scratch at the same places, while expanding fewer cells in total.
+ *
+ * Build: cc -o plan_sim plan_sim.c ../plan.c -lm
+ * Usage: plan_sim
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/6/2018
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../plan.h"
+
+// Most obstacles in a course
+#define SIM_MAX_OBSTACLES 16
+
+// How far the robot drives between sweeps, and how far a sweep sees
+#define SIM_DRIVE_MM 300
+#define SIM_SEE_MM 1000
+
+// Most steps driven toward the goal
+#define SIM_MAX_STEPS 40
+
+/// A post (radius > 0) or a wall from (x1, y1) to (x2, y2) with a thickness of 2 * half_width (radius = 0)
+typedef struct {
+    int x1, y1, x2, y2;
+    int radius;
+    int half_width;
+} sim_obstacle_t;
+
+/// A course to plan across
+typedef struct {
+    const char *name;
+    int goal_x, goal_y;
+    int reachable;  // 1 if there is a way through
+    sim_obstacle_t obstacles[SIM_MAX_OBSTACLES];
+    int count;
+} sim_course_t;
+
+static const sim_course_t courses[] = {
+    { "open floor", 3000, 0, 1, { { 0 } }, 0 },
+    { "wall with a gap", 2500, 0, 1, {
+        { 1200, -2000, 1200, -150, 0, 25 },
+        { 1200, 550, 1200, 2000, 0, 25 } }, 2 },
+    { "slalom posts", 3000, 500, 1, {
+        { 700, 0, 0, 0, 150, 0 }, { 1300, 600, 0, 0, 150, 0 },
+        { 1300, -500, 0, 0, 150, 0 }, { 1900, 0, 0, 0, 150, 0 },
+        { 2500, 400, 0, 0, 150, 0 }, { 2500, 900, 0, 0, 150, 0 } }, 6 },
+    { "u-shaped trap", 2500, 0, 1, {
+        { 1500, -700, 1500, 700, 0, 25 }, { 800, 700, 1500, 700, 0, 25 },
+        { 800, -700, 1500, -700, 0, 25 } }, 3 },
+    { "gap too narrow", 2500, 0, 0, {
+        { 1200, -2000, 1200, 100, 0, 25 },
+        { 1200, 350, 1200, 2000, 0, 25 } }, 2 },
+};
+
+// Course the planner is reading
+static const sim_obstacle_t *sim_obstacles;
+static int sim_count;
+
+// 1 for each obstacle the robot has seen
+static char sim_seen[SIM_MAX_OBSTACLES];
+
+/// Returns the distance from a point to an obstacle's edge, negative inside it
+static double obstacle_distance(const sim_obstacle_t *obstacle, double x, double y)
+{
+
+    if (obstacle->radius > 0) {
+        return hypot(x - obstacle->x1, y - obstacle->y1) - obstacle->radius;
+    }
+
+    double dx = obstacle->x2 - obstacle->x1, dy = obstacle->y2 - obstacle->y1;
+    double t = ((x - obstacle->x1) * dx + (y - obstacle->y1) * dy) / (dx * dx + dy * dy);
+    if (t < 0) {
+        t = 0;
+    } else if (t > 1) {
+        t = 1;
+    }
+    return hypot(x - obstacle->x1 - t * dx, y - obstacle->y1 - t * dy) - obstacle->half_width;
+
+}
+
+/// Returns the distance from a point to the nearest obstacle the robot has seen
+static double clearance(double x, double y)
+{
+
+    double nearest = 1e9;
+    int i;
+
+    for (i = 0; i < sim_count; i++) {
+        double distance = obstacle_distance(&sim_obstacles[i], x, y);
+        if (sim_seen[i] && distance < nearest) {
+            nearest = distance;
+        }
+    }
+    return nearest;
+
+}
+
+/// Stands in for the occupancy grid: a map cell is occupied if an obstacle covers its middle
+int grid_state(int x, int y)
+{
+
+    double mx = x * GRID_CELL_MM + GRID_CELL_MM / 2.0 - GRID_ORIGIN_X_MM;
+    double my = y * GRID_CELL_MM + GRID_CELL_MM / 2.0 - GRID_ORIGIN_Y_MM;
+    return clearance(mx, my) <= GRID_CELL_MM / 2.0 ? GRID_OCCUPIED : GRID_FREE;
+
+}
+
+/// Returns the cost of the cheapest path between two planning cells, by brute force over every cell
+/** This follows the same rules as the planner: no moves into blocked cells or past their corners.
+ * @return The cost, or -1 if there is no path */
+static int cheapest_cost(int from, int to)
+{
+
+    static const int step_x[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+    static const int step_y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    static int cost[PLAN_CELLS];
+    static char done[PLAN_CELLS];
+    int i, direction;
+
+    for (i = 0; i < PLAN_CELLS; i++) {
+        cost[i] = -1;
+        done[i] = 0;
+    }
+    cost[from] = 0;
+
+    for (;;) {
+        int cell = -1;
+        for (i = 0; i < PLAN_CELLS; i++) {
+            if (!done[i] && cost[i] >= 0 && (cell < 0 || cost[i] < cost[cell])) {
+                cell = i;
+            }
+        }
+        if (cell < 0 || cell == to) {
+            return cell < 0 ? -1 : cost[to];
+        }
+        done[cell] = 1;
+
+        int x = cell % PLAN_WIDTH, y = cell / PLAN_WIDTH;
+        for (direction = 0; direction < 8; direction++) {
+            int dx = step_x[direction], dy = step_y[direction];
+            if (plan_blocked(x + dx, y + dy) || (dx && dy && (plan_blocked(x + dx, y) || plan_blocked(x, y + dy)))) {
+                continue;
+            }
+            int next = (y + dy) * PLAN_WIDTH + x + dx;
+            int step = (dx && dy) ? PLAN_COST_DIAGONAL : PLAN_COST_STRAIGHT;
+            if (cost[next] < 0 || cost[cell] + step < cost[next]) {
+                cost[next] = cost[cell] + step;
+            }
+        }
+    }
+
+}
+
+/// Returns the planning cell of a point in mm
+static int cell_of(double x, double y)
+{
+
+    return (int) floor((y + GRID_ORIGIN_Y_MM) / PLAN_CELL_MM) * PLAN_WIDTH
+            + (int) floor((x + GRID_ORIGIN_X_MM) / PLAN_CELL_MM);
+
+}
+
+/// Returns the cost of the last path from (x, y)
+/** Each leg between waypoints is straight or diagonal, so its cost is the distance if nothing were in the way */
+static int path_cost(int x, int y)
+{
+
+    int from = cell_of(x, y);
+    int total = 0;
+    int i;
+
+    for (i = 0; i < plan_stats.waypoints; i++) {
+        int to = cell_of(plan_waypoints[i].x_mm, plan_waypoints[i].y_mm);
+        int dx = abs(to % PLAN_WIDTH - from % PLAN_WIDTH), dy = abs(to / PLAN_WIDTH - from / PLAN_WIDTH);
+        total += (dx < dy) ? PLAN_COST_DIAGONAL * dx + PLAN_COST_STRAIGHT * (dy - dx)
+                           : PLAN_COST_DIAGONAL * dy + PLAN_COST_STRAIGHT * (dx - dy);
+        from = to;
+    }
+    return total;
+
+}
+
+/// Checks the last path from (x, y) and works out its length and closest approach
+/** @return 1 if the path stays out of blocked cells and clear of the obstacles */
+static int check_path(int x, int y, double *length, double *closest)
+{
+
+    double px = x, py = y;
+    int i, step;
+
+    *length = 0;
+    *closest = 1e9;
+
+    for (i = 0; i < plan_stats.waypoints; i++) {
+        double dx = plan_waypoints[i].x_mm - px, dy = plan_waypoints[i].y_mm - py;
+        double distance = hypot(dx, dy);
+        int steps = (int) (distance / 10) + 1;
+
+        for (step = 1; step <= steps; step++) {
+            double sx = px + dx * step / steps, sy = py + dy * step / steps;
+            double c = clearance(sx, sy);
+            if (c < *closest) {
+                *closest = c;
+            }
+            int cx = (int) floor((sx + GRID_ORIGIN_X_MM) / PLAN_CELL_MM);
+            int cy = (int) floor((sy + GRID_ORIGIN_Y_MM) / PLAN_CELL_MM);
+            if (i > 0 && plan_blocked(cx, cy)) {
+                return 0;
+            }
+        }
+        *length += distance;
+        px = plan_waypoints[i].x_mm;
+        py = plan_waypoints[i].y_mm;
+    }
+
+    // The path must be as cheap as the cheapest one there is
+    int goal = cell_of(plan_waypoints[plan_stats.waypoints - 1].x_mm, plan_waypoints[plan_stats.waypoints - 1].y_mm);
+    if (path_cost(x, y) != cheapest_cost(cell_of(x, y), goal)) {
+        return 0;
+    }
+
+    return *closest >= PLAN_ROBOT_RADIUS_MM - PLAN_CELL_MM / 2;
+
+}
+
+/// Plans from (x, y) and times it
+static int replan_timed(int x, int y, double *us)
+{
+
+    clock_t start = clock();
+    int result = plan_replan(x, y);
+    *us = (clock() - start) * 1e6 / CLOCKS_PER_SEC;
+    return result;
+
+}
+
+/// Plans across one course
+/** @return 1 if the result is right */
+static int run_course(const sim_course_t *course)
+{
+
+    double us, length = 0, closest = 0;
+    int pass;
+
+    sim_obstacles = course->obstacles;
+    sim_count = course->count;
+    memset(sim_seen, 1, sizeof(sim_seen));
+
+    plan_set_goal(course->goal_x, course->goal_y);
+    int result = replan_timed(0, 0, &us);
+
+    if (course->reachable) {
+        pass = result == PLAN_OK && check_path(0, 0, &length, &closest);
+    } else {
+        pass = result == PLAN_NO_PATH;
+    }
+
+    // An open floor has nothing to come close to
+    if (closest > 99999) {
+        closest = 99999;
+    }
+
+    printf("%-16s %6d %8d %9d %9.0f %9.0f %8.0f   %s\n", course->name, result, plan_stats.expanded,
+           plan_stats.heap_high, length, closest, us, pass ? "ok" : "FAIL");
+    return pass;
+
+}
+
+/// Drives along the slalom, replanning after each sweep, incrementally and from scratch
+/** @return 1 if every path is good and as cheap as from scratch, and the incremental replans expanded fewer cells */
+static int run_drive(void)
+{
+
+    const sim_course_t *course = &courses[2];
+    int drive_x[SIM_MAX_STEPS], drive_y[SIM_MAX_STEPS];
+    int steps = 0, expanded = 0, scratch_expanded = 0, changed = 0;
+    double us = 0, scratch_us = 0, step_us, length, closest;
+    int pass = 1;
+    int i, j;
+
+    sim_obstacles = course->obstacles;
+    sim_count = course->count;
+    plan_set_goal(course->goal_x, course->goal_y);
+
+    // Incremental: sweep, replan, and drive toward the first waypoint
+    int x = 0, y = 0;
+    while (steps < SIM_MAX_STEPS) {
+        for (i = 0; i < sim_count; i++) {
+            sim_seen[i] = obstacle_distance(&sim_obstacles[i], x, y) < SIM_SEE_MM;
+        }
+        drive_x[steps] = x;
+        drive_y[steps] = y;
+        steps++;
+
+        int result = replan_timed(x, y, &step_us);
+        us += step_us;
+        expanded += plan_stats.expanded;
+        changed += plan_stats.changed;
+        if (result != PLAN_OK || !check_path(x, y, &length, &closest)) {
+            pass = 0;
+            break;
+        }
+        if (plan_stats.waypoints == 1 && hypot(plan_waypoints[0].x_mm - x, plan_waypoints[0].y_mm - y) <= SIM_DRIVE_MM) {
+            break;
+        }
+
+        double dx = plan_waypoints[0].x_mm - x, dy = plan_waypoints[0].y_mm - y;
+        double distance = hypot(dx, dy);
+        if (distance > SIM_DRIVE_MM) {
+            dx *= SIM_DRIVE_MM / distance;
+            dy *= SIM_DRIVE_MM / distance;
+        }
+        x += (int) lround(dx);
+        y += (int) lround(dy);
+    }
+
+    // From scratch at the same places, with the same posts seen
+    for (j = 0; j < steps; j++) {
+        for (i = 0; i < sim_count; i++) {
+            sim_seen[i] = obstacle_distance(&sim_obstacles[i], drive_x[j], drive_y[j]) < SIM_SEE_MM;
+        }
+        plan_set_goal(course->goal_x, course->goal_y);
+        if (replan_timed(drive_x[j], drive_y[j], &step_us) != PLAN_OK
+                || !check_path(drive_x[j], drive_y[j], &length, &closest)) {
+            pass = 0;
+        }
+        scratch_us += step_us;
+        scratch_expanded += plan_stats.expanded;
+    }
+
+    pass = pass && expanded < scratch_expanded;
+
+    printf("\nDriving the slalom %d mm between sweeps, seeing %d mm: %d replans, %d cells changed\n",
+           SIM_DRIVE_MM, SIM_SEE_MM, steps, changed);
+    printf("  incremental: %5d expanded, %6.0f us\n", expanded, us);
+    printf("  scratch:     %5d expanded, %6.0f us   %s\n", scratch_expanded, scratch_us, pass ? "ok" : "FAIL");
+    return pass;
+
+}
+
+int main(void)
+{
+
+    unsigned i;
+    int failed = 0;
+
+    printf("%d x %d planning cells of %d mm, robot radius %d mm, heap of %d\n\n",
+           PLAN_WIDTH, PLAN_HEIGHT, PLAN_CELL_MM, PLAN_ROBOT_RADIUS_MM, PLAN_HEAP_SIZE);
+    printf("course           result expanded heap high    length   closest  host us\n");
+
+    for (i = 0; i < sizeof(courses) / sizeof(courses[0]); i++) {
+        failed += !run_course(&courses[i]);
+    }
+    failed += !run_drive();
+
+    return failed ? 1 : 0;
+
+}
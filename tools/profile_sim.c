@@ -0,0 +1,144 @@
+/**
+ * @file profile_sim.c
+ * @brief Host side simulation of straight moves with and without a velocity profile.
+ *
+ * Simulates the robot driving a straight line with a millisecond time step. The wheels follow the commanded
+ * speed quickly, but the body can only change speed as fast as the tires grip the floor, so any faster change
+ * is wheel slip. Odometry counts the wheels, not the body. The controller gets an odometry frame every 15ms
+ * and its wheel commands take effect one frame later, like the firmware stepping moves from the stream.
+ *
+ * Each move is run bang-bang (full speed, then 0 once the odometry reaches the target, as the firmware used to)
+ * and with the trapezoidal profile from profile.c. The table shows the time until the robot stops,
+ * where it stopped compared to the target, and how far the odometry is off from where the robot really is.
+ *
+ * Build: cc -o profile_sim profile_sim.c ../profile.c
+ * Usage: profile_sim
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/4/2018
+ */
+
+#include <stdio.h>
+#include "../profile.h"
+
+// Time between odometry frames, and before a wheel command takes effect
+#define SIM_FRAME_MS 15
+
+// Acceleration in mm/s^2 of the wheel motors
+#define SIM_MOTOR_ACCEL 4000.0
+
+// Acceleration in mm/s^2 the tires can give the body before they slip
+#define SIM_GRIP_ACCEL 600.0
+
+// Longest a simulated move may run
+#define SIM_LIMIT_MS 20000
+
+/// Result of one simulated move
+typedef struct {
+    int time_ms;       // Time until the body stopped
+    double position;   // Where the body stopped in mm
+    double odometry;   // What the odometry said in mm
+} sim_result_t;
+
+/// Moves value toward goal by at most step
+/** @param value The current value.
+ * @param goal The value to move toward.
+ * @param step The largest change allowed.
+ * @return The new value
+ */
+static double approach(double value, double goal, double step)
+{
+
+    if (goal > value + step) {
+        return value + step;
+    }
+    if (goal < value - step) {
+        return value - step;
+    }
+    return goal;
+
+}
+
+/// Simulates one move
+/** @param distance The millimeters to go.
+ * @param cruise The top speed in mm/s.
+ * @param profiled 1 to follow the velocity profile, 0 for bang-bang.
+ * @return How the move went
+ */
+static sim_result_t simulate(int distance, int cruise, int profiled)
+{
+
+    profile_t profile;
+    profile_plan(&profile, distance, cruise, PROFILE_ACCEL, PROFILE_MIN_SPEED);
+
+    double wheel = 0, body = 0, position = 0, odometry = 0;
+    double command = profiled ? profile.min_speed : cruise;
+    double pending = command;
+    int reported = 0;
+    int stopped = 0;
+    int t;
+
+    for (t = 1; t < SIM_LIMIT_MS; t++) {
+        // The motors chase the command, and the body follows as fast as the tires grip
+        wheel = approach(wheel, command, SIM_MOTOR_ACCEL / 1000);
+        body = approach(body, wheel, SIM_GRIP_ACCEL / 1000);
+        position += body / 1000;
+        odometry += wheel / 1000;
+
+        if (t % SIM_FRAME_MS != 0) {
+            continue;
+        }
+
+        // The command sent on the last frame takes effect now
+        command = pending;
+
+        // The controller sees the odometry of this frame, rounded to whole millimeters like the Roomba
+        reported = (int) odometry;
+        if (!stopped) {
+            if (reported >= distance) {
+                pending = 0;
+                stopped = 1;
+            } else if (profiled) {
+                pending = profile_speed(&profile, reported, t);
+            }
+        } else if (wheel == 0 && body == 0) {
+            break;
+        }
+    }
+
+    sim_result_t result = { t, position, odometry };
+    return result;
+
+}
+
+int main(void)
+{
+
+    static const int distances[] = { 100, 250, 500, 1000 };
+    static const int speeds[] = { 110, 250, 400 };
+    unsigned i, j;
+
+    printf("Grip %.0f mm/s^2, profile %d mm/s^2 from %d mm/s, frames every %d ms\n\n",
+            SIM_GRIP_ACCEL, PROFILE_ACCEL, PROFILE_MIN_SPEED, SIM_FRAME_MS);
+    printf("  mm  mm/s | bang-bang: ms  stop err  odo err | profile: ms  stop err  odo err  planned ms\n");
+
+    for (i = 0; i < sizeof(distances) / sizeof(distances[0]); i++) {
+        for (j = 0; j < sizeof(speeds) / sizeof(speeds[0]); j++) {
+            profile_t profile;
+            profile_plan(&profile, distances[i], speeds[j], PROFILE_ACCEL, PROFILE_MIN_SPEED);
+
+            sim_result_t bang = simulate(distances[i], speeds[j], 0);
+            sim_result_t ramp = simulate(distances[i], speeds[j], 1);
+
+            printf("%4d  %4d | %13d  %8.1f  %7.1f | %11d  %8.1f  %7.1f  %10u\n",
+                    distances[i], speeds[j],
+                    bang.time_ms, bang.position - distances[i], bang.odometry - bang.position,
+                    ramp.time_ms, ramp.position - distances[i], ramp.odometry - ramp.position,
+                    (unsigned) profile_time_ms(&profile));
+        }
+    }
+
+    return 0;
+
+}
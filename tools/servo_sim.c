@@ -0,0 +1,117 @@
+/**
+ * @file servo_sim.c
+ * @brief Host side check of the servo slew-rate model in pwm.c against the old fixed 50ms wait.
+ *
+ * Builds pwm.c with the simulated peripherals in host/ and moves the servo through a sweep: to 0, one degree at a time
+ * to 180, and back to 0. The old move_servo waited 50ms for every move. The new one waits servo_settle_ms, and the
+ * simulated clock shows how long the moves really wait. The sum of servo_settle_ms over the moves has to match it.
+ *
+ * Each wait is also checked against the time the servo needs at its slew rate: every move has to leave at least
+ * SERVO_SETTLE_MARGIN_MS after the servo gets there, and less than a millisecond more, for a 1 and a 180 degree move
+ * at the default rate and at a calibrated rate.
+ *
+ * Build: cc -std=c99 -Ihost -o servo_sim servo_sim.c ../pwm.c host/host.c
+ * Usage: servo_sim
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/9/2018
+ */
+
+#include <stdio.h>
+#include "host/host.h"
+#include "../Timer.h"
+#include "../pwm.h"
+
+// Servo wait of the old move_servo for every move
+#define SIM_OLD_WAIT_MS 50
+
+// Slew rate a calibration could measure on a faster servo
+#define SIM_CALIBRATED_US_PER_DEGREE 2300
+
+// IR reading while calibrating is not checked here
+unsigned adc_latest(void)
+{
+
+    return 0;
+
+}
+
+// The scheduler is not built in, so a sleep just moves the simulated time
+void sched_sleep(uint32_t millis)
+{
+
+    timer_waitMillis(millis);
+
+}
+
+/// Checks the settle margin of one move
+/** @param from The degree the servo is at.
+ * @param to The degree the servo moves to.
+ * @return 1 if the wait leaves the margin and less than a millisecond more, 0 otherwise
+ */
+static int check_margin(int from, int to)
+{
+
+    int travel_us = (to > from ? to - from : from - to) * servo_us_per_degree;
+    int wait_us = servo_settle_ms(from, to) * 1000;
+    int margin_us = wait_us - travel_us;
+    int ok = margin_us >= SERVO_SETTLE_MARGIN_MS * 1000 && margin_us < (SERVO_SETTLE_MARGIN_MS + 1) * 1000;
+
+    printf("  %3d to %3d at %d us/degree: travel %6d us, wait %6d us, margin %5d us %s\n",
+            from, to, servo_us_per_degree, travel_us, wait_us, margin_us, ok ? "" : "FAIL");
+    return ok;
+
+}
+
+int main(void)
+{
+
+    int failed = 0;
+    int degree;
+    int moves = 0;
+    uint32_t sum_ms = 0;
+
+    host_reset();
+
+    // Sweep: to the start, a degree at a time to 180, and back
+    sum_ms += servo_settle_ms(0, 180);
+    move_servo(0);
+    moves++;
+    for (degree = 1; degree <= 180; degree++) {
+        sum_ms += servo_settle_ms(degree - 1, degree);
+        move_servo(degree);
+        moves++;
+    }
+    uint32_t sweep_ms = timer_getMillis();
+    uint32_t return_sum_ms = servo_settle_ms(180, 0);
+    move_servo(0);
+    moves++;
+    uint32_t return_ms = timer_getMillis() - sweep_ms;
+    sum_ms += return_sum_ms;
+
+    uint32_t old_sweep_ms = (moves - 1) * SIM_OLD_WAIT_MS;
+    printf("Sweep of %d moves:  old %5u ms, slew model %5u ms, %.2f times faster\n",
+            moves - 1, (unsigned) old_sweep_ms, (unsigned) sweep_ms, (double) old_sweep_ms / sweep_ms);
+    printf("Return to 0:       old %5u ms, slew model %5u ms, the servo needs %d ms\n",
+            (unsigned) SIM_OLD_WAIT_MS, (unsigned) return_ms, 180 * servo_us_per_degree / 1000);
+    printf("Total:             old %5u ms, slew model %5u ms\n",
+            (unsigned) (old_sweep_ms + SIM_OLD_WAIT_MS), (unsigned) timer_getMillis());
+
+    if (sum_ms != timer_getMillis()) {
+        printf("FAIL: servo_settle_ms adds up to %u ms, but move_servo waited %u ms\n",
+                (unsigned) sum_ms, (unsigned) timer_getMillis());
+        failed = 1;
+    }
+
+    printf("Settle margin of %d ms:\n", SERVO_SETTLE_MARGIN_MS);
+    failed |= !check_margin(0, 1);
+    failed |= !check_margin(180, 0);
+    servo_us_per_degree = SIM_CALIBRATED_US_PER_DEGREE;
+    failed |= !check_margin(90, 91);
+    failed |= !check_margin(0, 180);
+
+    printf(failed ? "FAIL\n" : "All checks passed\n");
+    return failed;
+
+}
@@ -0,0 +1,327 @@
+/**
+ * @file sweep_sim.c
+ * @brief Host side simulation of the interrupt driven sweep in sweep.c against the old blocking sweep loop.
+ *
+ * Builds sweep.c with the simulated peripherals in host/ and stands in for the servo, the IR reading, and the PING))).
+ * The servo takes SERVO_DEFAULT_US_PER_DEGREE to turn each degree, and the IR reading and the echo are those of the
+ * degree the servo is pointing at, or garbage while it is still turning. A ping takes the trigger pulse, the sensor's
+ * holdoff, and the round trip of the sound, and completes from a simulated interrupt.
+ *
+ * The old loop moved the servo, waited a fixed 50ms, and then read the IR and waited for the echo at each of the
+ * 181 degrees. The simulation times the same scene with sweep_tick stepping the sweep from the simulated tick,
+ * once with the old 50ms settle for each step and once with the slew-rate model, and checks that each degree's
+ * record holds the readings taken at that degree.
+ *
+ * Build: cc -std=c99 -Ihost -o sweep_sim sweep_sim.c ../sweep.c host/host.c
+ * Usage: sweep_sim
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 5/9/2018
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "host/host.h"
+#include "../sweep.h"
+#include "../ping.h"
+#include "../pwm.h"
+#include "../distance.h"
+
+// Servo wait of the old sweep loop at every degree
+#define SIM_OLD_SETTLE_MS 50
+
+// Time the old loop took to start and read an IR conversion
+#define SIM_IR_READ_US 10
+
+// Time the PING))) waits after the trigger pulse before it sends the burst
+#define SIM_PING_HOLDOFF_US 750
+
+// Longest echo pulse the PING))) sends when nothing is in range
+#define SIM_PING_MAX_ECHO_US 18500
+
+// Longest a simulated sweep may run
+#define SIM_LIMIT_MS 30000
+
+// IR reading returned while the servo is still turning
+#define SIM_MOVING 0xFFFF
+
+int angle = 0;
+int servo_us_per_degree = SERVO_DEFAULT_US_PER_DEGREE;
+
+static int scene_mm[SWEEP_DEGREES]; // Distance to whatever is at each degree
+static int fixed_settle = 0; // 1 to wait SIM_OLD_SETTLE_MS for every servo move
+
+// Simulated servo
+static int servo_from = 0;
+static int servo_to = 0;
+static uint64_t servo_arrive_us = 0;
+
+// Simulated ping in flight
+static ping_callback_t ping_callback = 0;
+static uint64_t ping_due_us = 0;
+static int ping_cycles_result = 0;
+static int pings_overlapped = 0;
+
+/// Returns the IR reading of an object at a distance
+/** @param mm The distance in mm.
+ * @return The ADC reading
+ */
+static unsigned scene_ir(int mm)
+{
+
+    return 2000000 / (mm + 300);
+
+}
+
+/// Returns the width of the echo from an object at a distance
+/** @param mm The distance in mm.
+ * @return The echo width in microseconds
+ */
+static int scene_echo_us(int mm)
+{
+
+    // Sound travels 0.343 mm/us, there and back
+    int us = mm * 2000 / 343;
+    return (us > SIM_PING_MAX_ECHO_US) ? SIM_PING_MAX_ECHO_US : us;
+
+}
+
+/// Returns the degree the servo is pointing at
+/** @return The degree, or -1 while the servo is turning
+ */
+static int servo_at(void)
+{
+
+    return (host_us >= servo_arrive_us) ? servo_to : -1;
+
+}
+
+void servo_set(int degree)
+{
+
+    int at = servo_at();
+    servo_from = (at >= 0) ? at : servo_from;
+    servo_to = degree;
+    servo_arrive_us = host_us + (uint64_t) abs(degree - servo_from) * SERVO_DEFAULT_US_PER_DEGREE;
+    angle = degree;
+
+}
+
+int servo_settle_ms(int from, int to)
+{
+
+    if (fixed_settle) {
+        return SIM_OLD_SETTLE_MS;
+    }
+    return (abs(to - from) * servo_us_per_degree + 999) / 1000 + SERVO_SETTLE_MARGIN_MS;
+
+}
+
+int servo_left_ms(void)
+{
+
+    return (host_us >= servo_arrive_us) ? 0 : (int) ((servo_arrive_us - host_us + 999) / 1000);
+
+}
+
+int servo_start(int degree)
+{
+
+    int wait = servo_settle_ms(angle, degree) + servo_left_ms();
+    servo_set(degree);
+    return wait;
+
+}
+
+unsigned adc_latest(void)
+{
+
+    int at = servo_at();
+    return (at >= 0) ? scene_ir(scene_mm[at]) : SIM_MOVING;
+
+}
+
+void ping_start(ping_callback_t on_complete)
+{
+
+    int at = servo_at();
+    int echo_us = (at >= 0) ? scene_echo_us(scene_mm[at]) : 1;
+
+    if (ping_callback) {
+        pings_overlapped++;
+    }
+    ping_callback = on_complete;
+    ping_due_us = host_us + PING_TRIGGER_US + SIM_PING_HOLDOFF_US + echo_us;
+    ping_cycles_result = echo_us * 16;
+
+}
+
+int ir_to_mm(unsigned quantization)
+{
+
+    return quantization;
+
+}
+
+int ping_cycles_to_mm(int clock_cycles)
+{
+
+    return clock_cycles;
+
+}
+
+// The scheduler is not built in, so waiting for an interrupt moves the simulated time to the next tick
+void sched_idle(void)
+{
+
+    host_tick();
+
+}
+
+/// Fills the scene with a wall and a few objects
+static void make_scene(void)
+{
+
+    int degree;
+
+    for (degree = 0; degree < SWEEP_DEGREES; degree++) {
+        scene_mm[degree] = 2400 + (degree % 9) * 40;
+    }
+    for (degree = 25; degree <= 33; degree++) {
+        scene_mm[degree] = 350;
+    }
+    for (degree = 70; degree <= 95; degree++) {
+        scene_mm[degree] = 900;
+    }
+    for (degree = 120; degree <= 124; degree++) {
+        scene_mm[degree] = 600;
+    }
+    for (degree = 150; degree <= 170; degree++) {
+        scene_mm[degree] = 3600;
+    }
+
+}
+
+/// Times the old blocking loop over the scene
+/** @return The sweep time in microseconds
+ */
+static uint64_t old_sweep_us(void)
+{
+
+    uint64_t us = 0;
+    int degree;
+
+    for (degree = 0; degree < SWEEP_DEGREES; degree++) {
+        us += SIM_OLD_SETTLE_MS * 1000 + SIM_IR_READ_US;
+        us += PING_TRIGGER_US + SIM_PING_HOLDOFF_US + scene_echo_us(scene_mm[degree]);
+    }
+    return us;
+
+}
+
+/// Runs a sweep through sweep.c and checks its records
+/** @param start The first degree.
+ * @param end The last degree.
+ * @param time_ms Set to the sweep time.
+ * @return The number of records that do not match the scene, or -1 if degrees were missed
+ */
+static int run_sweep(int start, int end, uint32_t *time_ms)
+{
+
+    sweep_sample_t *sample;
+    int seen[SWEEP_DEGREES] = { 0 };
+    int bad = 0;
+    int count = 0;
+
+    host_reset();
+    servo_to = servo_from = start;
+    servo_arrive_us = 0;
+    angle = start;
+    ping_callback = 0;
+    pings_overlapped = 0;
+
+    sweep_clear();
+    if (!sweep_init() || !sweep_start(start, end)) {
+        return -1;
+    }
+
+    // Step the simulated time, completing the ping from its interrupt when its echo ends
+    while (host_us < (uint64_t) SIM_LIMIT_MS * 1000) {
+        uint64_t next_tick = (uint64_t) (timer_getMillis() + 1) * 1000;
+        if (ping_callback && ping_due_us <= next_tick) {
+            ping_callback_t callback = ping_callback;
+            host_advance_us((uint32_t) (ping_due_us - host_us));
+            ping_callback = 0;
+            callback(PING_DONE, ping_cycles_result);
+        } else {
+            host_tick();
+        }
+    }
+
+    while ((sample = sweep_poll()) != 0) {
+        int mm = scene_mm[sample->degree];
+        if (sample->quantization != scene_ir(mm) || !sample->echo
+                || sample->cycles != scene_echo_us(mm) * 16) {
+            bad++;
+        }
+        seen[sample->degree]++;
+        count++;
+    }
+
+    int low = (start < end) ? start : end;
+    int high = (start < end) ? end : start;
+    int degree;
+    for (degree = low; degree <= high; degree++) {
+        if (seen[degree] != 1) {
+            return -1;
+        }
+    }
+    if (count != high - low + 1 || pings_overlapped || !sweep_is_done()) {
+        return -1;
+    }
+
+    *time_ms = sweep_time();
+    return bad;
+
+}
+
+int main(void)
+{
+
+    uint32_t fixed_ms, slew_ms, back_ms;
+    int failed = 0;
+
+    make_scene();
+    uint32_t old_ms = (uint32_t) (old_sweep_us() / 1000);
+
+    fixed_settle = 1;
+    int fixed_bad = run_sweep(0, 180, &fixed_ms);
+    fixed_settle = 0;
+    int slew_bad = run_sweep(0, 180, &slew_ms);
+    int back_bad = run_sweep(180, 0, &back_ms);
+
+    printf("Old blocking loop, %d ms settle:       %6u ms\n", SIM_OLD_SETTLE_MS, (unsigned) old_ms);
+    if (fixed_bad == 0) {
+        printf("Pipelined, %d ms settle:               %6u ms, %.2f times faster\n",
+                SIM_OLD_SETTLE_MS, (unsigned) fixed_ms, (double) old_ms / fixed_ms);
+    }
+    if (slew_bad == 0) {
+        printf("Pipelined, slew model:                %6u ms, %.2f times faster\n",
+                (unsigned) slew_ms, (double) old_ms / slew_ms);
+    }
+    if (back_bad == 0) {
+        printf("Pipelined, slew model, 180 to 0:      %6u ms\n", (unsigned) back_ms);
+    }
+
+    if (fixed_bad != 0 || slew_bad != 0 || back_bad != 0) {
+        printf("FAIL: records that do not match the scene: %d, %d, %d (-1 for missed degrees)\n",
+                fixed_bad, slew_bad, back_bad);
+        failed = 1;
+    } else {
+        printf("All %d records of each sweep hold the readings of their degree\n", SWEEP_DEGREES);
+    }
+
+    return failed;
+
+}
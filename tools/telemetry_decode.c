@@ -0,0 +1,277 @@
+/**
+ * @file telemetry_decode.c
+ * @brief Host side decoder for the binary sweep frames sent by the robot.
+ *
+ * Turns a capture of the robot's serial output back into the text tables the robot sends in text mode,
+ * including the map changes.
+ * Text that is not part of a frame, like command replies, is passed through unchanged.
+ *
+ * Build: cc -o telemetry_decode telemetry_decode.c
+ * Usage: telemetry_decode [capture file]   (reads standard input without a file)
+ *
+ * Define TELEMETRY_DECODE_LIBRARY to leave out main and use the decoder from other programs.
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/28/2018
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "telemetry_decode.h"
+
+/// Returns the CRC-16/CCITT of length bytes
+/** @param data The bytes to check.
+ * @param length The number of bytes.
+ * @return The CRC
+ */
+uint16_t telemetry_crc(const uint8_t *data, int length)
+{
+
+    uint16_t crc = 0xFFFF;
+    int i, bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+
+}
+
+/// Reads a little-endian 16 bit value
+static int get16(const uint8_t *data)
+{
+
+    return data[0] | (data[1] << 8);
+
+}
+
+/// Decodes one frame
+/** @param frame TELEMETRY_FRAME_SIZE bytes starting with the sync byte.
+ * @param out Filled in with the frame contents.
+ * @return 1 if the sync byte, type, and CRC are valid, 0 if not
+ */
+int telemetry_decode(const uint8_t *frame, telemetry_frame_t *out)
+{
+
+    int i;
+
+    if (frame[0] != TELEMETRY_SYNC
+            || get16(&frame[TELEMETRY_FRAME_SIZE - 2]) != telemetry_crc(frame, TELEMETRY_FRAME_SIZE - 2)) {
+        return 0;
+    }
+
+    out->type = frame[1];
+    out->sequence = get16(&frame[2]);
+
+    switch (out->type) {
+    case TELEMETRY_SAMPLE:
+        out->data.sample.degree = frame[4];
+        out->data.sample.echo = frame[5] & 1;
+        out->data.sample.ir_mm = get16(&frame[6]);
+        out->data.sample.ping_mm = get16(&frame[8]);
+        out->data.sample.echo_us = get16(&frame[10]);
+        return 1;
+    case TELEMETRY_OBJECT:
+        out->data.object.start_degree = frame[4];
+        out->data.object.end_degree = frame[5];
+        out->data.object.mean_mm = get16(&frame[6]);
+        out->data.object.min_mm = get16(&frame[8]);
+        out->data.object.width_mm = get16(&frame[10]);
+        return 1;
+    case TELEMETRY_SWEEP_END:
+        out->data.end.samples = frame[4];
+        out->data.end.dropped = frame[5];
+        out->data.end.sweep_ms = get16(&frame[6]);
+        out->data.end.bytes = get16(&frame[8]);
+        out->data.end.cycles = get16(&frame[10]);
+        return 1;
+    case TELEMETRY_GRID:
+        out->data.grid.first = get16(&frame[4]);
+        out->data.grid.count = frame[6];
+        if (out->data.grid.count > TELEMETRY_GRID_CELLS) {
+            return 0;
+        }
+        for (i = 0; i < out->data.grid.count; i++) {
+            out->data.grid.states[i] = (frame[7 + i / 4] >> ((i % 4) * 2)) & 3;
+        }
+        return 1;
+    case TELEMETRY_GRID_END:
+        out->data.grid_end.width = frame[4];
+        out->data.grid_end.height = frame[5];
+        out->data.grid_end.cell_mm = get16(&frame[6]);
+        out->data.grid_end.cells = get16(&frame[8]);
+        out->data.grid_end.robot_cell = get16(&frame[10]) == 0xFFFF ? -1 : get16(&frame[10]);
+        return 1;
+    default:
+        return 0;
+    }
+
+}
+
+/// Prepares a stream for telemetry_feed
+void telemetry_stream_init(telemetry_stream_t *stream,
+                           void (*on_frame)(const telemetry_frame_t *frame, void *context),
+                           void (*on_text)(int byte, void *context), void *context)
+{
+
+    memset(stream, 0, sizeof(*stream));
+    stream->next_sequence = -1;
+    stream->on_frame = on_frame;
+    stream->on_text = on_text;
+    stream->context = context;
+
+}
+
+/// Adds one received byte to the stream
+/** Bytes are collected from a sync byte until a whole frame has arrived. If the frame does not decode,
+ * the sync byte is passed on as text and the rest of the bytes are searched again for a sync byte.
+ * @param stream The stream.
+ * @param byte The byte received.
+ */
+void telemetry_feed(telemetry_stream_t *stream, uint8_t byte)
+{
+
+    telemetry_frame_t frame;
+
+    stream->buffer[stream->length++] = byte;
+
+    while (stream->length > 0) {
+        if (stream->buffer[0] == TELEMETRY_SYNC) {
+            if (stream->length < TELEMETRY_FRAME_SIZE) {
+                return;
+            }
+            if (telemetry_decode(stream->buffer, &frame)) {
+                if (stream->next_sequence >= 0 && frame.sequence != stream->next_sequence) {
+                    stream->lost += (frame.sequence - stream->next_sequence) & 0xFFFF;
+                }
+                stream->next_sequence = (frame.sequence + 1) & 0xFFFF;
+                stream->frames++;
+                stream->length = 0;
+                stream->on_frame(&frame, stream->context);
+                return;
+            }
+            stream->crc_errors++;
+        }
+
+        // Not the start of a frame
+        stream->on_text(stream->buffer[0], stream->context);
+        stream->length--;
+        memmove(stream->buffer, stream->buffer + 1, stream->length);
+    }
+
+}
+
+#ifndef TELEMETRY_DECODE_LIBRARY
+
+// Most objects held until the end of a sweep
+#define MAX_OBJECTS 256
+
+/// Objects of the sweep being decoded, printed after the sweep summary like the robot does in text mode
+typedef struct {
+    telemetry_frame_t objects[MAX_OBJECTS];
+    int count;
+} sweep_t;
+
+/// Prints a frame in the same format the robot uses in text mode
+static void print_frame(const telemetry_frame_t *frame, void *context)
+{
+
+    sweep_t *sweep = context;
+    int i;
+
+    switch (frame->type) {
+    case TELEMETRY_SAMPLE:
+        printf("%d\t%d.%d\t\t%d.%d\n\r", frame->data.sample.degree,
+               frame->data.sample.ir_mm / 10, frame->data.sample.ir_mm % 10,
+               frame->data.sample.ping_mm / 10, frame->data.sample.ping_mm % 10);
+        break;
+    case TELEMETRY_OBJECT:
+        if (sweep->count < MAX_OBJECTS) {
+            sweep->objects[sweep->count++] = *frame;
+        }
+        break;
+    case TELEMETRY_SWEEP_END:
+        printf("Sweep time: %d ms\n\rSamples: %d of 181\n\r",
+               frame->data.end.sweep_ms, frame->data.end.samples);
+        for (i = 0; i < sweep->count; i++) {
+            const telemetry_frame_t *object = &sweep->objects[i];
+            printf("\nNEW OBJECT:\n\rObject: %d\n\rAvg_Ping: %d.%d\n\rMin_Ping: %d.%d\n\rWidth: %d.%d\n\rStart: %d\n\rEnd: %d\n\rSamples: %d\n\r",
+                   i + 1, object->data.object.mean_mm / 10, object->data.object.mean_mm % 10,
+                   object->data.object.min_mm / 10, object->data.object.min_mm % 10,
+                   object->data.object.width_mm / 10, object->data.object.width_mm % 10,
+                   object->data.object.start_degree, object->data.object.end_degree,
+                   object->data.object.end_degree - object->data.object.start_degree + 1);
+        }
+        if (frame->data.end.dropped > 0) {
+            printf("\n%d more objects were not recorded.\n\r", frame->data.end.dropped);
+        }
+        printf("Telemetry: %d bytes, %d cycles formatting per record\n\r",
+               frame->data.end.bytes, frame->data.end.cycles);
+        sweep->count = 0;
+        break;
+    case TELEMETRY_GRID:
+        printf("Grid: %d ", frame->data.grid.first);
+        for (i = 0; i < frame->data.grid.count; i++) {
+            putchar('0' + frame->data.grid.states[i]);
+        }
+        printf("\n\r");
+        break;
+    case TELEMETRY_GRID_END:
+        printf("Grid end: %d x %d cells of %d mm, %d sent, robot at %d\n\r",
+               frame->data.grid_end.width, frame->data.grid_end.height, frame->data.grid_end.cell_mm,
+               frame->data.grid_end.cells, frame->data.grid_end.robot_cell);
+        break;
+    }
+
+}
+
+/// Passes text through unchanged
+static void print_text(int byte, void *context)
+{
+
+    (void) context;
+    putchar(byte);
+
+}
+
+int main(int argc, char **argv)
+{
+
+    static sweep_t sweep;
+    telemetry_stream_t stream;
+    FILE *input = stdin;
+    int byte;
+
+    if (argc > 1) {
+        input = fopen(argv[1], "rb");
+        if (input == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    telemetry_stream_init(&stream, print_frame, print_text, &sweep);
+
+    while ((byte = getc(input)) != EOF) {
+        telemetry_feed(&stream, (uint8_t) byte);
+    }
+
+    // Flush any partial frame as text
+    while (stream.length > 0) {
+        print_text(stream.buffer[0], NULL);
+        stream.length--;
+        memmove(stream.buffer, stream.buffer + 1, stream.length);
+    }
+
+    fprintf(stderr, "%ld frames, %ld lost, %ld CRC errors\n", stream.frames, stream.lost, stream.crc_errors);
+
+    return 0;
+
+}
+
+#endif
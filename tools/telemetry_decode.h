@@ -0,0 +1,99 @@
+/*
+ * telemetry_decode.h
+ *
+ *  Created on: Apr 28, 2018
+ *      Author: mmorth
+ *
+ * Host side decoder for the binary sweep frames sent by telemetry.c.
+ * Has no hardware dependencies. The layout must match telemetry.h.
+ */
+
+#ifndef TELEMETRY_DECODE_H_
+#define TELEMETRY_DECODE_H_
+
+#include <stdint.h>
+
+#define TELEMETRY_FRAME_SIZE 14
+#define TELEMETRY_SYNC 0xA5
+
+#define TELEMETRY_SAMPLE 1
+#define TELEMETRY_OBJECT 2
+#define TELEMETRY_SWEEP_END 3
+#define TELEMETRY_GRID 4
+#define TELEMETRY_GRID_END 5
+
+// Most cell states in a TELEMETRY_GRID frame
+#define TELEMETRY_GRID_CELLS 20
+
+/// One decoded frame
+typedef struct {
+    int type;           // TELEMETRY_SAMPLE, TELEMETRY_OBJECT, TELEMETRY_SWEEP_END, TELEMETRY_GRID, or TELEMETRY_GRID_END
+    int sequence;       // Sequence number of the frame
+    union {
+        struct {
+            int degree;
+            int echo;       // 1 if the ping got an echo
+            int ir_mm;
+            int ping_mm;
+            int echo_us;    // Width of the echo in microseconds
+        } sample;
+        struct {
+            int start_degree;
+            int end_degree;
+            int mean_mm;
+            int min_mm;
+            int width_mm;
+        } object;
+        struct {
+            int samples;    // Degrees sampled by the sweep
+            int dropped;    // Objects found after the robot's object list was full
+            int sweep_ms;   // Time the sweep took
+            int bytes;      // Bytes sent for the sweep, including this frame
+            int cycles;     // Average clock cycles spent formatting each frame
+        } end;
+        struct {
+            int first;      // Index of the first cell, row by row from the lower left corner
+            int count;      // Cells in states
+            uint8_t states[TELEMETRY_GRID_CELLS];   // 0 unknown, 1 free, 2 occupied
+        } grid;
+        struct {
+            int width;      // Cells across the grid
+            int height;     // Cells up the grid
+            int cell_mm;    // Size of each cell
+            int cells;      // Cells sent since the last end
+            int robot_cell; // Cell the robot is in, or -1 off the grid
+        } grid_end;
+    } data;
+} telemetry_frame_t;
+
+/// State of a byte stream being decoded
+typedef struct {
+    uint8_t buffer[TELEMETRY_FRAME_SIZE];
+    int length;         // Bytes in buffer
+    int next_sequence;  // Expected sequence number, or -1 before the first frame
+    long frames;        // Frames decoded
+    long lost;          // Frames missing from the sequence numbers
+    long crc_errors;    // Sync bytes followed by a bad CRC
+
+    // Called for each decoded frame
+    void (*on_frame)(const telemetry_frame_t *frame, void *context);
+    // Called for each byte that is not part of a frame, such as the robot's text replies
+    void (*on_text)(int byte, void *context);
+    void *context;
+} telemetry_stream_t;
+
+// Returns the CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of length bytes
+uint16_t telemetry_crc(const uint8_t *data, int length);
+
+// Decodes one frame. Returns 1 if the sync byte and CRC are valid, 0 if not.
+int telemetry_decode(const uint8_t *frame, telemetry_frame_t *out);
+
+// Prepares a stream for telemetry_feed with the functions to call
+void telemetry_stream_init(telemetry_stream_t *stream,
+                           void (*on_frame)(const telemetry_frame_t *frame, void *context),
+                           void (*on_text)(int byte, void *context), void *context);
+
+// Adds one received byte to the stream, calling on_frame or on_text as frames and text are found
+void telemetry_feed(telemetry_stream_t *stream, uint8_t byte);
+
+#endif /* TELEMETRY_DECODE_H_ */
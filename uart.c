@@ -2,14 +2,44 @@
  * @file uart.c
  * @brief This file contains the source code for using the uart.
  *
+ * Sent bytes are copied into a ring buffer and the UART1 interrupt moves them into the 16 byte hardware FIFO,
+ * so sending does not wait for the bytes to go out unless the buffer is full.
+ * Received bytes are moved from the FIFO into another ring buffer by the same interrupt, so typed ahead
+ * bytes are kept until they are read.
+ *
  * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
  *
  * @date 4/12/2018
  */
 #include "uart.h"
 #include "lcd.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
 // #include "button.h"
 
+#define TX_MASK (UART_TX_BUFFER_SIZE - 1)
+#define RX_MASK (UART_RX_BUFFER_SIZE - 1)
+
+// Bytes waiting to be moved into the FIFO. The head is written by the program, the tail by the interrupt.
+static volatile char tx_buffer[UART_TX_BUFFER_SIZE];
+static volatile uint16_t tx_head = 0;
+static volatile uint16_t tx_tail = 0;
+
+static uart_tx_policy_t tx_policy = UART_TX_BLOCK;
+static int tx_high_water = 0;
+static uint32_t tx_dropped = 0;
+
+// Bytes received but not read yet. The head is written by the interrupt, the tail by the program.
+static volatile char rx_buffer[UART_RX_BUFFER_SIZE];
+static volatile uint16_t rx_head = 0;
+static volatile uint16_t rx_tail = 0;
+
+static volatile uint32_t rx_dropped = 0;
+static volatile uint32_t rx_errors = 0;
+
+// Current operator link baud rate
+static uint32_t baud_rate = UART_DEFAULT_BAUD;
+
 
 /// Sets all necessary registers to enable the uart 1 module
 /** This method initializes all necessary registers for the uart.
@@ -40,13 +70,10 @@ void uart_init(void)
     //set pin 1 to Txor output
     GPIO_PORTB_DIR_R |= BIT1;
 
-    //calculate baudrate
-    uint16_t iBRD= 8;
-
-    //use equations
-    uint16_t fBRD= 44;
+    //calculate baudrate from the system clock
+    uint16_t iBRD, fBRD;
+    uart_baudDivisors(SysCtlClockGet(), UART_DEFAULT_BAUD, &iBRD, &fBRD);
 
-    //use equations
     //turn off uart1 while we set it up
     UART1_CTL_R &= ~(UART_CTL_UARTEN);
 
@@ -54,8 +81,24 @@ void uart_init(void)
     UART1_IBRD_R = iBRD;
     UART1_FBRD_R = fBRD;
 
-    //set frame, 8 data bits, 1 stop bit, no parity, no FIFO
-    UART1_LCRH_R = UART_LCRH_WLEN_8 ;
+    //set frame, 8 data bits, 1 stop bit, no parity, FIFO on
+    UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;
+
+    //interrupt when the transmit FIFO is down to 2 bytes or the receive FIFO has 8 bytes
+    UART1_IFLS_R = UART_IFLS_TX1_8 | UART_IFLS_RX4_8;
+
+    //transmit interrupt is only enabled while there are bytes in the buffer.
+    //the receive timeout interrupt picks up bytes that do not fill the receive FIFO to 8.
+    UART1_IM_R = UART_IM_RXIM | UART_IM_RTIM;
+
+    //lowest priority, below the system tick
+    NVIC_PRI1_R = (NVIC_PRI1_R & 0xFF1FFFFF) | 0x00600000;
+
+    //enable IRQ 6 (UART1)
+    NVIC_EN0_R |= 0x00000040;
+
+    IntRegister(INT_UART1, UART1_Handler);
+    IntMasterEnable();
 
     //use system clock as source
     UART1_CC_R = UART_CC_CS_SYSCLK;
@@ -65,8 +108,211 @@ void uart_init(void)
 
 } // END of uart_init()
 
+/// Works out the UART divisors for a baud rate
+/** This method uses BRD = clock / (16 * baud), split into a 16 bit integer part and a 6 bit fraction.
+ * @param clock The UART clock in Hz, normally SysCtlClockGet().
+ * @param baud The baud rate wanted.
+ * @param ibrd Set to the integer divisor.
+ * @param fbrd Set to the fractional divisor in 64ths.
+ * @return 1, or 0 if the divisor is out of range or the rate is off by more than UART_MAX_BAUD_ERROR
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/1/2018
+ */
+int uart_baudDivisors(uint32_t clock, uint32_t baud, uint16_t *ibrd, uint16_t *fbrd)
+{
+
+    //divisor in 64ths, rounded: 64 * clock / (16 * baud)
+    uint32_t divisor = (clock * 4 + baud / 2) / baud;
+
+    *ibrd = divisor >> 6;
+    *fbrd = divisor & 0x3F;
+
+    if (divisor < 64 || divisor > 0x3FFFFF) {
+        return 0;
+    }
+
+    //check how close the rate the divisor makes is to the one asked for
+    uint32_t actual = (clock * 4) / divisor;
+    uint32_t error = (actual > baud) ? actual - baud : baud - actual;
+
+    return error * 1000 / baud <= UART_MAX_BAUD_ERROR;
+
+}
+
+/// Changes the operator link baud rate
+/** This method waits for everything buffered to be sent, then reprograms the divisors.
+ * Received bytes not read yet are thrown away since they were at the old rate.
+ * @param baud The new baud rate.
+ * @return 1, or 0 if the rate cannot be made from the system clock
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/1/2018
+ */
+int uart_setBaud(uint32_t baud)
+{
+
+    uint16_t iBRD, fBRD;
+
+    if (!uart_baudDivisors(SysCtlClockGet(), baud, &iBRD, &fBRD)) {
+        return 0;
+    }
+
+    uart_flush();
+
+    UART1_CTL_R &= ~(UART_CTL_UARTEN);
+    UART1_IBRD_R = iBRD;
+    UART1_FBRD_R = fBRD;
+
+    //the divisors only take effect when the line control is written
+    UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;
+    UART1_CTL_R |= UART_CTL_UARTEN;
+
+    rx_tail = rx_head;
+    baud_rate = baud;
+
+    return 1;
+
+}
+
+/// Returns the operator link baud rate
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/1/2018
+ */
+uint32_t uart_getBaud(void)
+{
+
+    return baud_rate;
+
+}
+
+/// Switches to a new baud rate if the ground station can keep up
+/** The handshake is:
+ * 1. The robot switches to the new rate and sends "BAUD?" every UART_BAUD_PROBE_MS.
+ * 2. The ground station, after switching too, answers with a line "OK".
+ * 3. If "OK" arrives within UART_BAUD_CONFIRM_MS with no receive errors, the robot sends "BAUD OK" and keeps the rate.
+ *    Otherwise it switches back to the old rate and sends "BAUD FAILED".
+ * The ground station steps up through rates this way until one fails.
+ * @param baud The new baud rate.
+ * @return 1 if the new rate was kept, 0 if the robot is back at the old rate
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 5/1/2018
+ */
+int uart_negotiate(uint32_t baud)
+{
+
+    uint32_t previous = baud_rate;
+
+    if (!uart_setBaud(baud)) {
+        uart_sendStr("BAUD FAILED\n\r");
+        return 0;
+    }
+
+    uint32_t errors = rx_errors;
+    uint32_t start = timer_getMillis();
+    uint32_t last_probe = start - UART_BAUD_PROBE_MS;
+
+    //last two bytes received, to find "OK" at the end of a line
+    char before = 0, last = 0;
+    int confirmed = 0;
+
+    while (!confirmed && timer_getMillis() - start < UART_BAUD_CONFIRM_MS) {
+        if (timer_getMillis() - last_probe >= UART_BAUD_PROBE_MS) {
+            uart_sendStr("BAUD?\n\r");
+            last_probe = timer_getMillis();
+        }
+
+        int data = uart_tryReceive();
+        if (data < 0) {
+            continue;
+        }
+        if ((data == '\r' || data == '\n') && before == 'O' && last == 'K') {
+            confirmed = 1;
+        }
+        before = last;
+        last = data;
+    }
+
+    if (confirmed && rx_errors == errors) {
+        uart_sendStr("BAUD OK\n\r");
+        return 1;
+    }
+
+    uart_setBaud(previous);
+    uart_sendStr("BAUD FAILED\n\r");
+    return 0;
+
+}
+
+/// Moves buffered bytes into the transmit FIFO
+/** This method fills the FIFO from the ring buffer and enables the transmit interrupt while bytes are left.
+ * Called from the interrupt, or from the program with the transmit interrupt masked.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+static void tx_fill(void)
+{
+
+    while (tx_tail != tx_head && !(UART1_FR_R & UART_FR_TXFF)) {
+        UART1_DR_R = tx_buffer[tx_tail];
+        tx_tail = (tx_tail + 1) & TX_MASK;
+    }
+
+    if (tx_tail != tx_head) {
+        UART1_IM_R |= UART_IM_TXIM;
+    } else {
+        UART1_IM_R &= ~UART_IM_TXIM;
+    }
+
+}
+
+/// Starts sending the buffered bytes
+/** This method masks the transmit interrupt so the FIFO is only filled by one side at a time.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+static void tx_start(void)
+{
+
+    UART1_IM_R &= ~UART_IM_TXIM;
+    tx_fill();
+
+}
+
+/// Adds a byte to the transmit buffer
+/** When the buffer is full this waits for room or drops the byte, depending on the policy.
+ * @param data the byte to add
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+static void tx_put(char data)
+{
+
+    uint16_t next = (tx_head + 1) & TX_MASK;
+
+    if (next == tx_tail) {
+        if (tx_policy == UART_TX_DROP) {
+            tx_dropped++;
+            return;
+        }
+
+        //wait for the interrupt to make room
+        tx_start();
+        while (next == tx_tail) {
+
+        }
+    }
+
+    tx_buffer[tx_head] = data;
+    tx_head = next;
+
+    int used = (tx_head - tx_tail) & TX_MASK;
+    if (used > tx_high_water) {
+        tx_high_water = used;
+    }
+
+}
+
 /// Sends a character to Putty.
-/** This method sends a single 8 bit character over the uart 1 module.
+/** This method buffers a single 8 bit character to be sent over the uart 1 module.
  * @param data the data to be sent out over uart 1
  * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
  * @date 4/12/2018
@@ -74,42 +320,52 @@ void uart_init(void)
 void uart_sendChar(char data)
 {
 
-    //wait until there is room to send data
-    while(UART1_FR_R & 0x20){
-
-    }
-
-    //send data
-    UART1_DR_R = data;
+    tx_put(data);
+    tx_start();
 
 }
 
 /// Receives character
-/** This method uses polling to receive an 8 bit character over uart 1 module.
- * @return the character received or a -1 if error occurred
+/** This method waits for a byte to be received over uart 1 module and takes it from the receive buffer.
+ * @return the character received
  * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
  * @date 4/12/2018
  */
 int uart_receive(void)
 {
 
-    char data = 0;
-
-     //&& !button_pressed()
+    int data;
 
     //wait to receive
-    while(UART1_FR_R & UART_FR_RXFE){
+    while ((data = uart_tryReceive()) < 0) {
 
     }
 
-    // Get and return data
-    data = (char)(UART1_DR_R & 0xFF);
+    return data;
+
+}
+
+/// Receives character if one is waiting
+/** This method takes the next byte from the receive buffer without waiting.
+ * @return the character received, or -1 if none is waiting
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/30/2018
+ */
+int uart_tryReceive(void)
+{
+
+    if (rx_tail == rx_head) {
+        return -1;
+    }
+
+    char data = rx_buffer[rx_tail];
+    rx_tail = (rx_tail + 1) & RX_MASK;
     return data;
 
 }
 
 /// Sends string through uart
-/** This method sends an entire string of character over uart 1 module
+/** This method buffers an entire string of character to be sent over uart 1 module
  * @param data pointer to the first index of the string to be sent
  * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
  * @date 4/12/2018
@@ -117,10 +373,115 @@ int uart_receive(void)
 void uart_sendStr(const char *data)
 {
     
-    //wait until there is room to send data
     while (data[0] != '\0') {
-        uart_sendChar(data[0]);
+        tx_put(data[0]);
         data++;
     }
+    tx_start();
+
+}
+
+/// Waits until everything has been sent
+/** This method waits for the buffer and FIFO to empty and the last byte to leave the shift register.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+void uart_flush(void)
+{
+
+    while (tx_tail != tx_head || (UART1_FR_R & UART_FR_BUSY)) {
+
+    }
+
+}
+
+/// Sets what happens when the transmit buffer is full
+/** @param policy UART_TX_BLOCK to wait for room or UART_TX_DROP to drop and count the byte
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+void uart_setTxPolicy(uart_tx_policy_t policy)
+{
+
+    tx_policy = policy;
+
+}
+
+/// Returns the most bytes that have been waiting in the transmit buffer at once
+/** Use this to size UART_TX_BUFFER_SIZE. A value of UART_TX_BUFFER_SIZE - 1 means the buffer has been full.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+int uart_txHighWater(void)
+{
+
+    return tx_high_water;
+
+}
+
+/// Returns the number of bytes dropped because the transmit buffer was full
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+uint32_t uart_txDropped(void)
+{
+
+    return tx_dropped;
+
+}
+
+/// Returns the number of bytes dropped because the receive buffer was full
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/30/2018
+ */
+uint32_t uart_rxDropped(void)
+{
+
+    return rx_dropped;
+
+}
+
+/// Returns the number of bytes dropped because of receive errors
+/** @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/30/2018
+ */
+uint32_t uart_rxErrors(void)
+{
+
+    return rx_errors;
+
+}
+
+/// Handles the UART1 interrupt
+/** This method moves received bytes into the receive buffer and refills the transmit FIFO when it runs low.
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ * @date 4/29/2018
+ */
+void UART1_Handler(void)
+{
+
+    if (UART1_MIS_R & (UART_MIS_RXMIS | UART_MIS_RTMIS)) {
+        UART1_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC;
+
+        while (!(UART1_FR_R & UART_FR_RXFE)) {
+            uint32_t data = UART1_DR_R;
+            uint16_t next = (rx_head + 1) & RX_MASK;
+
+            //the error flags are in bits 11:8 of each received byte
+            if (data & (UART_DR_OE | UART_DR_BE | UART_DR_PE | UART_DR_FE)) {
+                rx_errors++;
+            } else if (next == rx_tail) {
+                rx_dropped++;
+            } else {
+                rx_buffer[rx_head] = data & 0xFF;
+                rx_head = next;
+            }
+        }
+    }
+
+    if (UART1_MIS_R & UART_MIS_TXMIS) {
+        UART1_ICR_R = UART_ICR_TXIC;
+        tx_fill();
+    }
 
 }
@@ -3,7 +3,7 @@
 *   uart.h
 *
 *   Used to set up the RS232 connector and WIFI module
-*   uses UART1 at 115200
+*   uses UART1 at 115200, which can be raised with uart_negotiate
 *
 *
 *   @author Dane Larson
@@ -16,13 +16,68 @@
 #include "Timer.h"
 #include <inc/tm4c123gh6pm.h>
 
+// Bytes the transmit ring buffer holds. Must be a power of 2.
+#define UART_TX_BUFFER_SIZE 512
+
+// Bytes the receive ring buffer holds. Must be a power of 2.
+#define UART_RX_BUFFER_SIZE 256
+
+// Rate the operator link starts at and falls back to
+#define UART_DEFAULT_BAUD 115200
+
+// Largest difference between the requested and actual baud rate, in tenths of a percent
+#define UART_MAX_BAUD_ERROR 25
+
+// Time the ground station has to confirm a new baud rate, and how often the robot asks for it
+#define UART_BAUD_CONFIRM_MS 1000
+#define UART_BAUD_PROBE_MS 100
+
+// What uart_sendChar does when the transmit buffer is full
+typedef enum {
+    UART_TX_BLOCK,  // Wait for the interrupt to make room (default). Never send from an interrupt with this policy.
+    UART_TX_DROP    // Drop the byte and count it in uart_txDropped
+} uart_tx_policy_t;
+
 void uart_init(void);
 
+// Works out the UART divisors for a baud rate. Returns 1, or 0 if the clock cannot make the rate closely enough.
+int uart_baudDivisors(uint32_t clock, uint32_t baud, uint16_t *ibrd, uint16_t *fbrd);
+
+// Changes the operator link baud rate once everything buffered has been sent. Returns 0 if the rate cannot be made.
+int uart_setBaud(uint32_t baud);
+
+uint32_t uart_getBaud(void);
+
+// Switches to a baud rate and keeps it if the ground station confirms it, otherwise switches back. Returns 1 if kept.
+int uart_negotiate(uint32_t baud);
+
 void uart_sendChar(char data);
 
 int uart_receive(void);
 
+// Returns the next received byte, or -1 if none is waiting
+int uart_tryReceive(void);
+
 void uart_sendStr(const char *data);
 
+// Waits until every buffered byte has been sent
+void uart_flush(void);
+
+void uart_setTxPolicy(uart_tx_policy_t policy);
+
+// Most bytes that have been waiting in the transmit buffer at once
+int uart_txHighWater(void);
+
+// Bytes dropped because the transmit buffer was full
+uint32_t uart_txDropped(void);
+
+// Bytes dropped because the receive buffer was full
+uint32_t uart_rxDropped(void);
+
+// Bytes dropped because of framing, parity, break, or overrun errors
+uint32_t uart_rxErrors(void);
+
+void UART1_Handler(void);
+
 
 #endif /* UART_H_ */
@@ -1,354 +1,1216 @@
-/**
- * @file ui.c
- * @brief This file contains the source code for the user interface
- *
- * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
- *
- * @date 4/14/2018
- */
-
-// Include all necessary files
-#include "movement.h"
-#include "detect.h"
-#include "Timer.h"
-#include "lcd.h"
-#include <stdbool.h>
-#include "driverlib/interrupt.h"
-#include <math.h>
-#include "distance.h"
-#include "ping.h"
-#include "pwm.h"
-#include "open_interface.h"
-#include "ui.h"
-#include <string.h>
-#include "uart.h"
-
-// The sensor data variable
-oi_t *sensor_data;
-int amount = 0;
-
-// Define a constant for PI
-#define M_PI 3.14159265358979323846
-
-///// Accepts input for moving and sweeping the robot.
-///**
-// * This method is used to accept inputs for moving, turning, stopping sweeping, and sending the finish command to the robot.
-// * This method also sends back information about the status of the sensors.
-// * The following information below explains which button to press for each command.
-// * p = sweep
-// * c = send finish command
-// * f = move forward
-// * b = move backward
-// * t = turn
-// * s = stop
-// * @param sensor The Roomba sensor information.
-// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
-// * @date 4/12/2018
-// */
-void robot_command()
-{
-
-    // Signal to mission control that a new command has been sent.
-    uart_sendStr("New Command: \n\r");
-
-    // Receive the command
-    char command = uart_receive();
-
-    if (command == 'p')
-    { // get sweep information
-        sweep_info();
-        uart_sendStr("Sweep Done.\n\r");
-    }
-    else if (command == 'c')
-    { // robot is in finishing position
-        finish();
-        uart_sendStr("Retrieval Complete.\n\r");
-    }
-
-    else if (command == 'f')
-    { // move robot forward
-        uart_sendStr("Enter amount to move forward:");
-        amount = (uart_receive() - '0') * 100;
-        uart_sendStr("\n\r");
-
-        // Correct amount if a larger value was accidentally entered
-        if (amount > 400)
-        {
-            amount = 400;
-        }
-
-        int dist_moved = move_forward_amount(sensor_data, amount);
-        uart_sendStr("\n\rDistance moved: ");
-        char dist[20];
-        sprintf(dist, "%d", dist_moved);
-        uart_sendStr(dist);
-        uart_sendStr("\n\r");
-    }
-
-    else if (command == 'l')
-    { // turn left
-        uart_sendStr("Enter amount to turn left:");
-        amount = (uart_receive() - '0') * 10;
-
-        // Correct amount if a larger value was accidentally entered
-        if (amount > 90 || amount < 10)
-        {
-            uart_sendStr("\n\rInvalid input.\n\r");
-
-        }
-        else{
-        uart_sendStr("\n\r");
-        turn(sensor_data, amount);
-        uart_sendStr("Turn Complete.\n\r");
-        }
-    }
-
-    else if (command == 'r')
-    { // turn right
-        uart_sendStr("Enter amount to turn right:");
-        amount = (uart_receive() - '0') * -10;
-
-        // Correct amount if a larger value was accidentally entered
-        if (amount < -90 || amount > -10)
-        {
-            uart_sendStr("\n\rInvalid input.\n\r");
-        }
-        else{
-        uart_sendStr("\n\r");
-        turn(sensor_data, amount);
-        uart_sendStr("Turn Complete.\n\r");
-        }
-    }
-
-    else if (command == 's')
-    { // stop robot
-        oi_setWheels(0, 0);
-        uart_sendStr("Retrieval Complete.\n\r");
-    }
-
-}
-
-///// Flashes the power light and plays song for robot.
-///** This method signals that the robot is in the finishing location by playing a "We Are the Champions" by Queen and flashing the power LED.
-// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
-// * @date 4/8/2018
-// */
-void finish()
-{
-    // Turn on the LED
-    oi_setLeds(0, 0, 0, 255);
-    timer_waitMillis(250);
-    oi_setLeds(0, 0, 0, 0);
-    timer_waitMillis(250);
-    oi_setLeds(0, 0, 0, 255);
-    timer_waitMillis(250);
-    oi_setLeds(0, 0, 0, 0);
-
-    unsigned char notes[41] = { 62, 61, 62, 61, 57, 54, 59, 54, 57, 62, 64, 66,
-                                69, 66, 59, 61, 59, 59, 57, 59, 57, 55, 67, 66,
-                                67, 66, 64, 66, 62, 67, 66, 62, 67, 65, 62, 67,
-                                65, 62, 60, 57, 62 };
-
-    unsigned char duration[41] = { 32, 16, 16, 32, 32, 32, 32, 16, 32, 16, 16,
-                                   32, 32, 16, 16, 16, 32, 32, 32, 16, 16, 32,
-                                   32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
-                                   32, 32, 32, 32, 32, 16, 16, 64 };
-
-    // Load the song
-    oi_loadSong(1, 41, notes, duration);
-
-    // Play the song
-    oi_play_song(1);
-}
-
-///// Sweep for tall objects.
-///**
-// * This method is used to make the servo, ping, and ir sensors sweep and detect tall objects that are 180 degrees in front of the robot.
-// * It sends to Putty the detected object information as well as the degree location of the servo,
-// * the distance reading on the ir sensor, and the distance reading on the ping sensor.
-// * The sweep distance is between 10-50cm in front of the robot.
-// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
-// * @date 4/8/2018
-// */
-void sweep_info()
-{
-    // Move the servo to 0 degrees and wait until the servo moves to that position.
-    move_servo(0);
-
-    // Stores the degree measurement
-    char degree = 0;
-
-    // Set objects array element to 0.
-    char element = 0;
-
-    // Sets the object number equal to 0.
-    char object_num = 1;
-
-    // Stores the starting degree position of the detected object.
-    char start_degree = 0;
-
-    // Stores the number of degrees the current object has been detected for.
-    int detected_degrees = 0;
-
-    /** Stores the information for each object detected */
-    float objects[100];
-
-    // Stores the average ping distance
-    float average_ping = 0;
-
-    float ping_sum = 0;
-
-    // Sweep for each degree between 0 and 180 degrees
-    for (degree = 0; degree <= 180; degree++)
-    {
-        // Move servo to degree position
-        move_servo(degree);
-
-        // Determine IR sensor values
-        adc_receive();
-        int quantization = ADC_read(0);
-        double ir_distance = convert_distance(quantization);
-
-        // Determine Ping sensor values
-        double time = ping_read();
-        double ping_distance = cycle2dist(time);
-
-        // Determine degree width of object
-        if (ir_distance <= 50 && ping_distance <= 50 && ir_distance >= 10
-                && degree != 180)
-        {
-
-            // Store the starting degree of the object
-            if (detected_degrees == 0)
-            {
-                start_degree = degree;
-            }
-
-            // increment number of degrees the object has been detected
-            detected_degrees++;
-            ping_sum = ping_sum + ping_distance;
-
-        }
-        else
-        {
-            // Check for faulty data
-            if (detected_degrees >= 5)
-            { // valid data. Process
-
-                average_ping = ping_sum / detected_degrees;
-
-                // Determine front linear width of object
-                double object_width = average_ping * 2
-                        * tan((detected_degrees / 2.0) * (M_PI / 180));
-
-                // initialize and set the for loop variable
-                int i = 0;
-
-                // Store the object information
-                for (i = 0; i < 4; i++)
-                {
-                    if (i == 0)
-                    { // store the object number
-                        objects[element] = (double) object_num;
-                    }
-                    else if (i == 1)
-                    { // store the distance the object is away from the sensor
-                        objects[element] = (double) average_ping;
-                    }
-                    else if (i == 2)
-                    { // store the linear width of the object
-                        objects[element] = (double) object_width;
-                    }
-                    else
-                    { // store the angular range
-                        objects[element] = (double) start_degree;
-                        element++;
-                        objects[element] = (double) degree - 1; // ending degree
-                    }
-                    element++;
-                }
-
-                // increase object number
-                object_num++;
-
-                // Reset number of degrees object has been detected to zero
-                detected_degrees = 0;
-
-                average_ping = 0;
-                ping_sum = 0;
-
-            }
-            else
-            { // faulty data. Do not process
-              // Reset number of degrees object has been detected to zero
-                detected_degrees = 0;
-                average_ping = 0;
-                ping_sum = 0;
-            }
-        }
-
-        // Send data to Putty
-        char message[100];
-        sprintf(message, "%d\t%.2lf\t\t%.2lf\n\r", degree, ir_distance,
-                ping_distance);
-        uart_sendStr(message);
-
-    }
-
-    // Move the servo to 0 degrees and wait until the servo moves to that position.
-    move_servo(0);
-
-    // Send the object information back to Putty
-    char object_message[100];
-
-    int i = 0;
-
-    for (i = 0; i < element; i = i + 5)
-    {
-        sprintf(object_message,
-                "\nNEW OBJECT:\n\rObject: %.2lf\n\rAvg_Ping: %.2lf\n\rWidth: %.2lf\n\rStart: %.2lf\n\rEnd: %.2lf\n\r",
-                objects[i], objects[i + 1], objects[i + 2], objects[i + 3],
-                objects[i + 4]);
-        uart_sendStr(object_message);
-    }
-
-}
-
-///// Main method
-///** Main method for Mars Rover project. This calls and runs all the information.
-// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
-// * @date 4/8/2018
-// */
-void main()
-{
-    // Initialize the button and lcd
-    lcd_init();
-
-    // Initialize the uart
-    uart_init();
-
-    //Initialize the open interface
-    sensor_data = oi_alloc();
-    oi_init(sensor_data);
-
-    // Initialize the IR sensor
-    adc_init();
-
-    // Initialize the Ping sensor
-    ping_init();
-    timer3_init();
-
-    // Initialize the servo
-    timer1_init();
-    gpio_init();
-
-    // Move servo to the initial position of 0 degrees
-    move_servo(0);
-
-    // Loop forever
-    while (1)
-    {
-        // Receive the signal on how to move the robot
-        robot_command();
-    }
-}
+/**
+ * @file ui.c
+ * @brief This file contains the source code for the user interface
+ *
+ * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+ *
+ * @date 4/14/2018
+ */
+
+// Include all necessary files
+#include "movement.h"
+#include "detect.h"
+#include "Timer.h"
+#include "lcd.h"
+#include <stdbool.h>
+#include "driverlib/interrupt.h"
+#include <math.h>
+#include "distance.h"
+#include "ping.h"
+#include "pwm.h"
+#include "open_interface.h"
+#include "ui.h"
+#include <string.h>
+#include "uart.h"
+#include "sweep.h"
+#include "fusion.h"
+#include "telemetry.h"
+#include "command.h"
+#include "motion.h"
+#include "odometry.h"
+#include "grid.h"
+#include "plan.h"
+#include "finish.h"
+#include "sched.h"
+
+// The sensor data variable
+oi_t *sensor_data;
+int amount = 0;
+
+// 1 to alternate the sweep direction instead of returning the servo to 0 after each sweep
+int sweep_bidirectional = 0;
+
+// Bytes sent by the bench command when no amount is given
+#define LINK_BENCHMARK_BYTES 8192
+
+// How often the command task checks for a new command line
+#define COMMAND_POLL_MS 10
+
+// How often the sweep task sends the degrees that have completed
+#define SWEEP_SEND_MS 5
+
+// Pass of the sweep the sweep task is sending
+#define SWEEP_PASS_NONE 0   // No sweep is running
+#define SWEEP_PASS_ONLY 1   // The only pass of sweep_info or sweep_range
+#define SWEEP_PASS_COARSE 2 // The coarse pass of sweep_adaptive
+#define SWEEP_PASS_FINE 3   // A sector of the fine pass of sweep_adaptive
+
+// Toggles of the power LED at the finish, and the time between them
+#define FINISH_FLASHES 3
+#define FINISH_FLASH_MS 250
+
+// Toggles of the power LED so far
+static int finish_flashes = 0;
+
+// 1 once mission control has been told the robot is ready for a command
+static int command_prompted = 0;
+
+// Pass of the sweep being sent, the degrees sent so far, and the time the sweep started
+static int sweep_pass = SWEEP_PASS_NONE;
+static int sweep_sent = 0;
+static uint32_t sweep_started_ms = 0;
+
+// First and last degree of each sector of the fine pass of sweep_adaptive, and the next sector to sweep
+static int sector_start[SWEEP_DEGREES / 2 + 1];
+static int sector_end[SWEEP_DEGREES / 2 + 1];
+static int sectors = 0;
+static int sector_next = 0;
+
+// Function to call once the sweep has been sent, or 0 to reply "Sweep Done."
+static void (*sweep_then)() = 0;
+
+// 1 if the finish zone found by z is also the goal of the path
+static int zone_plan = 0;
+
+// Degrees the cmp command turns there and back
+static int cmp_degrees = 0;
+
+// Define a constant for PI
+#define M_PI 3.14159265358979323846
+
+///// Measures the operator link throughput.
+///**
+// * This method sends "BENCH bytes", then that many pattern bytes, then "END" with the time taken,
+// * the bytes per second, and the error counts so far. Pattern byte i is ' ' + i % 95, except that the last two bytes
+// * of every 64 are "\n\r".
+// * The ground station checks the pattern to count corrupted bytes.
+// * @param bytes The number of pattern bytes to send.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/1/2018
+// */
+static void link_benchmark(int bytes)
+{
+    char message[150];
+    int i = 0;
+
+    sprintf(message, "BENCH %d\n\r", bytes);
+    uart_sendStr(message);
+    uart_flush();
+
+    uint32_t start_ms = timer_getMillis();
+    for (i = 0; i < bytes; i++)
+    {
+        if (i % 64 == 62)
+        {
+            uart_sendChar('\n');
+        }
+        else if (i % 64 == 63)
+        {
+            uart_sendChar('\r');
+        }
+        else
+        {
+            uart_sendChar(' ' + (i % 95));
+        }
+    }
+    uart_flush();
+    uint32_t elapsed_ms = timer_getMillis() - start_ms;
+
+    if (elapsed_ms == 0)
+    {
+        elapsed_ms = 1;
+    }
+    sprintf(message,
+            "\n\rEND %lu baud, %d bytes, %lu ms, %lu bytes/s, RX errors %lu, RX dropped %lu, TX dropped %lu\n\r",
+            (unsigned long) uart_getBaud(), bytes, (unsigned long) elapsed_ms,
+            (unsigned long) bytes * 1000 / elapsed_ms,
+            (unsigned long) uart_rxErrors(), (unsigned long) uart_rxDropped(),
+            (unsigned long) uart_txDropped());
+    uart_sendStr(message);
+}
+
+///// Sends how the last move went.
+///**
+// * This method sends the amount asked for and moved, how long the move took, and how long the robot was busy with it.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/2/2018
+// */
+static void send_move_report()
+{
+    char message[100];
+    sprintf(message, "%s: asked %d, moved %d, %lu ms, busy %lu us\n\r",
+            move_report.scripted ? "Script" : "Poll", move_report.requested,
+            move_report.moved, (unsigned long) move_report.duration_ms,
+            (unsigned long) move_report.busy_us);
+    uart_sendStr(message);
+}
+
+///// Plans the path to the goal from where the robot is and sends it.
+///**
+// * This method sends each waypoint, then the cells expanded, the cells that changed, and the time taken.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/6/2018
+// */
+static void send_plan()
+{
+    char message[100];
+    odometry_pose_t pose;
+    int i;
+
+    odometry_get(&pose);
+    uint32_t start_ms = timer_getMillis();
+    int result = plan_replan(pose.x >> ODOMETRY_SHIFT, pose.y >> ODOMETRY_SHIFT);
+    uint32_t plan_ms = timer_getMillis() - start_ms;
+
+    for (i = 0; result == PLAN_OK && i < plan_stats.waypoints; i++)
+    {
+        sprintf(message, "Waypoint %d: %d, %d\n\r", i + 1,
+                plan_waypoints[i].x_mm, plan_waypoints[i].y_mm);
+        uart_sendStr(message);
+    }
+
+    sprintf(message, "Plan: result %d, %d expanded, %d changed, heap %d of %d, %lu ms\n\r",
+            result, plan_stats.expanded, plan_stats.changed,
+            plan_stats.heap_high, PLAN_HEAP_SIZE, (unsigned long) plan_ms);
+    uart_sendStr(message);
+}
+
+///// Tells mission control that a move or sweep is still running.
+///**
+// * The move or sweep runs from its task after the command that started it returns, so the next command may come in first.
+// * @return 1 if a move or sweep is running, 0 if a new one can start.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/9/2018
+// */
+static int busy()
+{
+    if (move_busy() || sweep_pass != SWEEP_PASS_NONE)
+    {
+        uart_sendStr("Busy.\n\r");
+        return 1;
+    }
+    return 0;
+}
+
+///// Sends the distance the f command moved.
+///** This method is called by the move task once the move and any backing up are over.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/9/2018
+// */
+static void forward_done()
+{
+    uart_sendStr("\n\rDistance moved: ");
+    char dist[20];
+    sprintf(dist, "%d", move_distance);
+    uart_sendStr(dist);
+    uart_sendStr("\n\r");
+}
+
+///// Sends how the turn of the l, r, or t command went.
+///** This method is called by the move task once the turn is over.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/9/2018
+// */
+static void turn_done()
+{
+    uart_sendStr("Turn Complete.\n\r");
+    send_move_report();
+}
+
+///// Turns back with a script once the polled turn of the cmp command is over.
+///** This method is called by the move task. It reports the first turn and starts the second, which sends its report when done.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/9/2018
+// */
+static void cmp_back()
+{
+    send_move_report();
+
+    // The mode is only read when a move starts
+    move_mode_t mode = move_mode;
+    move_mode = MOVE_SCRIPT;
+    turn(sensor_data, -cmp_degrees, send_move_report);
+    move_mode = mode;
+}
+
+///// Looks for the finish zone in the sweep of the z command.
+///** This method is called by the sweep task once the sweep and its objects have been sent.
+// * It sends where the zone is, and plans a path to the middle of it if asked to.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/9/2018
+// */
+static void find_zone()
+{
+    char message[120];
+    finish_zone_t zone;
+
+    // The objects have been found, so go back to the usual range
+    object_range_mm = OBJECT_MAX_MM;
+
+    if (finish_find(objects, object_count, &zone) == 0)
+    {
+        sprintf(message, "No finish zone in %d narrow objects.\n\r",
+                zone.candidates);
+        uart_sendStr(message);
+        return;
+    }
+    sprintf(message,
+            "Finish zone: %d posts, middle %d mm forward %d mm left, bearing %d, heading %d, off by %d mm\n\r",
+            zone.posts, zone.x_mm, zone.y_mm, zone.bearing, zone.heading,
+            zone.error_mm);
+    uart_sendStr(message);
+
+    if (zone_plan)
+    {
+        // Turn the middle of the zone from the robot into the odometry frame
+        odometry_pose_t pose;
+        odometry_get(&pose);
+        int32_t c = odometry_cos(pose.heading);
+        int32_t s = odometry_sin(pose.heading);
+        if (plan_set_goal((pose.x >> ODOMETRY_SHIFT) + ((zone.x_mm * c - zone.y_mm * s) >> 15),
+                          (pose.y >> ODOMETRY_SHIFT) + ((zone.x_mm * s + zone.y_mm * c) >> 15)) != PLAN_OK)
+        {
+            uart_sendStr("Goal is off the map.\n\r");
+            return;
+        }
+        send_plan();
+    }
+}
+
+///// Accepts input for moving and sweeping the robot.
+///**
+// * This method is used to accept inputs for moving, turning, stopping sweeping, and sending the finish command to the robot.
+// * This method also sends back information about the status of the sensors.
+// * Each command is a line with the command name followed by integer arguments, such as "f 275".
+// * Moves and sweeps are started and run from their own tasks once the command returns, so the next command is read while they run.
+// * Commands that move the wheels or the servo reply "Busy." until the move or sweep is over, except s, which stops the move.
+// * The following information below explains which command to send.
+// * p or sweep = sweep, or "sweep start end [step]" to sweep part of the range
+// * c = send finish command
+// * f mm = move forward up to 400mm
+// * l degrees, r degrees = turn left or right up to 90 degrees
+// * t degrees = turn, positive turns left
+// * s = stop, including a move started by go or spin
+// * go mm = start driving forward (negative for backward) and return while the robot moves
+// * spin degrees = start turning (positive turns left) and return while the robot turns
+// * w = report the state of the move started by go or spin
+// * script = toggle between polling and Roomba script moves for turns
+// * cmp degrees = turn by polling, turn back with a script, and report both
+// * m = toggle between bidirectional and return-to-zero sweeps
+// * a = adaptive sweep
+// * x = time the IR and PING distance conversions
+// * e = toggle between text and binary sweep data
+// * baud rate = switch the operator link to a new baud rate if the ground station confirms it
+// * bench [bytes] = measure the operator link throughput
+// * q = report the bytes and parse time of each sensor query preset
+// * u = report the transmit buffer high-water mark, dropped bytes, and OI stream frames
+// * k = calibrate the servo slew rate (object about 20cm away at 180 degrees, nothing else in range)
+// * o = report the odometry pose and velocity
+// * g = send the map changes, "g 1" to send the whole map, "g 0" to forget the map
+// * plan x y = plan a path to x mm forward and y mm left of the starting pose, replanned after each sweep
+// * plan = replan to the same goal, "plan 0" to forget the goal
+// * z = sweep farther than usual and look for the finish zone, "z 1" to also plan a path to it
+// * zone length width [tolerance] = set the spacing of the finish zone posts in mm
+// * tasks = report the runtime of each scheduled task and the idle time, "tasks 0" to start the counts over
+// * @param sensor The Roomba sensor information.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/12/2018
+// */
+void robot_command()
+{
+
+    // Receive the command
+    command_t command;
+    command_result_t result = command_receive(&command);
+
+    if (result != COMMAND_OK)
+    { // blank lines get no reply
+        if (result == COMMAND_TOO_LONG)
+        {
+            uart_sendStr("Invalid input: the line or command name is too long.\n\r");
+        }
+        else if (result == COMMAND_TOO_MANY_ARGS)
+        {
+            char message[64];
+            sprintf(message, "Invalid input: more than %d arguments.\n\r", COMMAND_MAX_ARGS);
+            uart_sendStr(message);
+        }
+        else if (result == COMMAND_BAD_NUMBER)
+        {
+            uart_sendStr("Invalid input: an argument is not a whole number.\n\r");
+        }
+    }
+
+    else if ((strcmp(command.name, "p") == 0 || strcmp(command.name, "sweep") == 0)
+            && command.argc == 0)
+    { // get sweep information
+        if (!busy())
+        {
+            sweep_info();
+        }
+    }
+
+    else if (strcmp(command.name, "p") == 0 || strcmp(command.name, "sweep") == 0)
+    { // sweep part of the range
+        int step = (command.argc >= 3) ? command.argv[2] : 1;
+        if (command.argc < 2 || command.argc > 3 || command.argv[0] < 0
+                || command.argv[0] > 180 || command.argv[1] < 0
+                || command.argv[1] > 180 || step < 1)
+        {
+            uart_sendStr("Usage: sweep [start end [step]]\n\r");
+        }
+        else if (!busy())
+        {
+            sweep_range(command.argv[0], command.argv[1], step);
+        }
+    }
+
+    else if (strcmp(command.name, "a") == 0)
+    { // get adaptive sweep information
+        if (!busy())
+        {
+            sweep_adaptive();
+        }
+    }
+    else if (strcmp(command.name, "c") == 0)
+    { // robot is in finishing position
+        finish();
+        uart_sendStr("Retrieval Complete.\n\r");
+    }
+
+    else if (strcmp(command.name, "f") == 0)
+    { // move robot forward
+        if (command.argc != 1 || command.argv[0] <= 0)
+        {
+            uart_sendStr("Usage: f millimeters\n\r");
+            return;
+        }
+        amount = command.argv[0];
+
+        // Correct amount if a larger value was accidentally entered
+        if (amount > 400)
+        {
+            amount = 400;
+        }
+
+        if (!busy() && !move_forward_amount(sensor_data, amount, forward_done))
+        {
+            uart_sendStr("The move could not start.\n\r");
+        }
+    }
+
+    else if (strcmp(command.name, "l") == 0 || strcmp(command.name, "r") == 0
+            || strcmp(command.name, "t") == 0)
+    { // turn left for l or positive t, right for r or negative t
+        if (command.argc != 1)
+        {
+            uart_sendStr("Usage: l degrees, r degrees, or t degrees (positive turns left)\n\r");
+            return;
+        }
+        amount = (command.name[0] == 'r') ? -command.argv[0] : command.argv[0];
+
+        // Correct amount if a larger value was accidentally entered
+        if (amount > 90 || amount < -90 || amount == 0
+                || (command.name[0] != 't' && command.argv[0] < 0))
+        {
+            uart_sendStr("Invalid input.\n\r");
+        }
+        else if (!busy() && !turn(sensor_data, amount, turn_done))
+        {
+            uart_sendStr("The move could not start.\n\r");
+        }
+    }
+
+    else if (strcmp(command.name, "script") == 0)
+    { // toggle how moves are stopped
+        move_mode = (move_mode == MOVE_POLL) ? MOVE_SCRIPT : MOVE_POLL;
+        if (move_mode == MOVE_SCRIPT)
+        {
+            uart_sendStr("Moves: Roomba script.\n\r");
+        }
+        else
+        {
+            uart_sendStr("Moves: polling.\n\r");
+        }
+    }
+
+    else if (strcmp(command.name, "cmp") == 0)
+    { // compare polling and script turns
+        if (command.argc != 1 || command.argv[0] == 0 || command.argv[0] > 90
+                || command.argv[0] < -90)
+        {
+            uart_sendStr("Usage: cmp degrees\n\r");
+            return;
+        }
+        if (busy())
+        {
+            return;
+        }
+
+        // Turn by polling, and turn back with a script once the move task is done with the first turn
+        move_mode_t mode = move_mode;
+        cmp_degrees = command.argv[0];
+        move_mode = MOVE_POLL;
+        if (!turn(sensor_data, cmp_degrees, cmp_back))
+        {
+            uart_sendStr("The move could not start.\n\r");
+        }
+        move_mode = mode;
+    }
+
+    else if (strcmp(command.name, "s") == 0)
+    { // stop robot, along with the move being run
+        move_stop();
+        uart_sendStr("Retrieval Complete.\n\r");
+    }
+
+    else if (strcmp(command.name, "go") == 0)
+    { // start driving without waiting, stopping for bumps, cliffs, and tape
+        if (command.argc != 1 || command.argv[0] == 0 || command.argv[0] > 400
+                || command.argv[0] < -400)
+        {
+            uart_sendStr("Usage: go millimeters\n\r");
+            return;
+        }
+        if (busy())
+        {
+            return;
+        }
+        if (command.argv[0] > 0)
+        {
+            motion_start_profile(command.argv[0], 110, 100,
+                    MOTION_STOP_BUMP | MOTION_STOP_CLIFF | MOTION_STOP_TAPE, 2700);
+        }
+        else
+        {
+            motion_start_profile(command.argv[0], -110, -100, 0, 0);
+        }
+        uart_sendStr("Moving.\n\r");
+    }
+
+    else if (strcmp(command.name, "spin") == 0)
+    { // start turning without waiting
+        if (command.argc != 1 || command.argv[0] == 0 || command.argv[0] > 180
+                || command.argv[0] < -180)
+        {
+            uart_sendStr("Usage: spin degrees\n\r");
+            return;
+        }
+        if (busy())
+        {
+            return;
+        }
+        motion_start_turn(command.argv[0], 250);
+        uart_sendStr("Turning.\n\r");
+    }
+
+    else if (strcmp(command.name, "w") == 0)
+    { // report the state of the move
+        static const char * const states[] = { "idle", "running", "done",
+                                               "hazard", "cancelled",
+                                               "failed" };
+        char message[60];
+        sprintf(message, "Move: %s, %d so far\n\r", states[motion_status()],
+                motion_progress());
+        uart_sendStr(message);
+    }
+
+    else if (strcmp(command.name, "o") == 0)
+    { // report the odometry pose and velocity
+        odometry_pose_t pose;
+        int speed;
+        int turn_rate;
+        char message[80];
+        odometry_get(&pose);
+        odometry_velocity(&speed, &turn_rate);
+        sprintf(message, "Pose: x %d mm, y %d mm, heading %d.%d, %d mm/s, %d deg/s\n\r",
+                (int) (pose.x >> ODOMETRY_SHIFT), (int) (pose.y >> ODOMETRY_SHIFT),
+                odometry_heading_tenths(pose.heading) / 10,
+                abs(odometry_heading_tenths(pose.heading) % 10), speed,
+                turn_rate / 10);
+        uart_sendStr(message);
+    }
+
+    else if (strcmp(command.name, "g") == 0)
+    { // send the map changes, "g 1" to send the whole map, "g 0" to forget it
+        char message[80];
+        if (command.argc > 0 && command.argv[0] == 0)
+        {
+            grid_clear();
+            uart_sendStr("Map cleared.\n\r");
+            return;
+        }
+        if (command.argc > 0)
+        {
+            grid_mark_all();
+        }
+        int deltas = grid_send();
+        sprintf(message, "Map: %d deltas, last sweep %d rays, %d cells changed, %lu cycles\n\r",
+                deltas, grid_stats.rays, grid_stats.changed,
+                (unsigned long) grid_stats.cycles);
+        uart_sendStr(message);
+    }
+
+    else if (strcmp(command.name, "plan") == 0)
+    { // plan a path to a goal
+        if (command.argc == 1 && command.argv[0] == 0)
+        {
+            plan_clear();
+            uart_sendStr("Goal cleared.\n\r");
+            return;
+        }
+        if (command.argc == 2
+                && plan_set_goal(command.argv[0], command.argv[1]) != PLAN_OK)
+        {
+            uart_sendStr("Goal is off the map.\n\r");
+            return;
+        }
+        if (command.argc != 0 && command.argc != 2)
+        {
+            uart_sendStr("Usage: plan x y, plan to replan, or plan 0 to forget the goal\n\r");
+            return;
+        }
+        send_plan();
+    }
+
+    else if (strcmp(command.name, "z") == 0)
+    { // look for the finish zone
+        if (busy())
+        {
+            return;
+        }
+
+        // Far posts are past the usual object range. find_zone looks for the zone once the sweep is sent.
+        object_range_mm = FINISH_RANGE_MM;
+        zone_plan = (command.argc > 0 && command.argv[0] != 0);
+        sweep_then = find_zone;
+        sweep_info();
+    }
+
+    else if (strcmp(command.name, "zone") == 0)
+    { // set the finish zone layout
+        if (command.argc < 2 || command.argv[0] <= 0 || command.argv[1] <= 0)
+        {
+            uart_sendStr("Usage: zone length width [tolerance]\n\r");
+            return;
+        }
+        finish_geometry.length_mm = command.argv[0];
+        finish_geometry.width_mm = command.argv[1];
+        if (command.argc > 2)
+        {
+            finish_geometry.tolerance_mm = command.argv[2];
+        }
+        uart_sendStr("Zone set.\n\r");
+    }
+
+    else if (strcmp(command.name, "k") == 0)
+    { // calibrate the servo slew rate
+        char message[50];
+        if (busy())
+        {
+            return;
+        }
+        int us_per_degree = servo_calibrate();
+        if (us_per_degree == 0)
+        {
+            sprintf(message, "Calibration failed. Slew: %d us/degree\n\r",
+                    servo_us_per_degree);
+        }
+        else
+        {
+            sprintf(message, "Slew: %d us/degree\n\r", us_per_degree);
+        }
+        uart_sendStr(message);
+    }
+
+    else if (strcmp(command.name, "x") == 0)
+    { // time the distance conversions
+        uint32_t ir_double, ir_table, ping_double, ping_int;
+        conversion_benchmark(&ir_double, &ir_table, &ping_double, &ping_int);
+
+        char message[100];
+        sprintf(message,
+                "IR: %lu cycles (pow), %lu cycles (table)\n\rPING: %lu cycles (double), %lu cycles (integer)\n\r",
+                (unsigned long) ir_double, (unsigned long) ir_table,
+                (unsigned long) ping_double, (unsigned long) ping_int);
+        uart_sendStr(message);
+    }
+
+    else if (strcmp(command.name, "m") == 0)
+    { // toggle the sweep mode
+        sweep_bidirectional = !sweep_bidirectional;
+        if (sweep_bidirectional)
+        {
+            uart_sendStr("Sweep mode: bidirectional.\n\r");
+        }
+        else
+        {
+            uart_sendStr("Sweep mode: return to zero.\n\r");
+        }
+    }
+
+    else if (strcmp(command.name, "u") == 0)
+    { // report the buffer use and link errors
+        char message[128];
+        sprintf(message, "TX buffer: %d of %d bytes at most, %lu dropped\n\r",
+                uart_txHighWater(), UART_TX_BUFFER_SIZE - 1,
+                (unsigned long) uart_txDropped());
+        uart_sendStr(message);
+        sprintf(message, "RX: %lu dropped, %lu errors\n\r",
+                (unsigned long) uart_rxDropped(),
+                (unsigned long) uart_rxErrors());
+        uart_sendStr(message);
+
+        oi_rx_stats_t oi_stats;
+        oi_rxStats(&oi_stats);
+        sprintf(message, "OI: %lu packets, %lu dropped, %lu resyncs\n\r",
+                (unsigned long) oi_stats.packets,
+                (unsigned long) oi_stats.dropped,
+                (unsigned long) oi_stats.resyncs);
+        uart_sendStr(message);
+        sprintf(message, "OI: %lu framing errors, %lu timeouts, %lu stray\n\r",
+                (unsigned long) oi_stats.framing_errors,
+                (unsigned long) oi_stats.timeouts,
+                (unsigned long) oi_stats.stray);
+        uart_sendStr(message);
+
+        oi_tx_stats_t oi_tx;
+        oi_txStats(&oi_tx);
+        sprintf(message, "OI TX: %lu commands, %lu coalesced, %lu dropped, %lu of %d bytes at most\n\r",
+                (unsigned long) oi_tx.commands,
+                (unsigned long) oi_tx.coalesced,
+                (unsigned long) oi_tx.dropped,
+                (unsigned long) oi_tx.high_water, OI_TX_BUFFER_SIZE - 1);
+        uart_sendStr(message);
+    }
+
+    else if (strcmp(command.name, "e") == 0)
+    { // toggle the sweep data encoding
+        telemetry_binary = !telemetry_binary;
+        if (telemetry_binary)
+        {
+            uart_sendStr("Sweep data: binary frames.\n\r");
+        }
+        else
+        {
+            uart_sendStr("Sweep data: text.\n\r");
+        }
+    }
+
+    else if (strcmp(command.name, "q") == 0)
+    { // compare the cost of each sensor query preset
+        const char *names[OI_PRESET_COUNT] = { "odometry", "hazards", "motion", "everything" };
+        char message[120];
+        int preset;
+
+        if (busy())
+        {
+            return;
+        }
+
+        // A move cannot run without the stream
+        motion_cancel();
+        oi_streamStop();
+        for (preset = 0; preset < OI_PRESET_COUNT; preset++)
+        {
+            oi_query_cost_t cost;
+            oi_queryBenchmark(sensor_data, (oi_preset_t) preset, &cost);
+            sprintf(message,
+                    "%s: %d bytes sent, %d bytes received, %lu ms round trip, %lu cycles parsing\n\r",
+                    names[preset], cost.request_bytes, cost.response_bytes,
+                    (unsigned long) cost.round_trip_ms,
+                    (unsigned long) cost.parse_cycles);
+            uart_sendStr(message);
+        }
+        oi_streamPreset(OI_PRESET_MOTION);
+    }
+
+    else if (strcmp(command.name, "baud") == 0)
+    { // change the operator link rate, or report it with no argument
+        char message[50];
+        if (command.argc == 1 && command.argv[0] > 0)
+        {
+            sprintf(message, "BAUD %d\n\r", command.argv[0]);
+            uart_sendStr(message);
+            uart_negotiate(command.argv[0]);
+        }
+        sprintf(message, "Baud: %lu\n\r", (unsigned long) uart_getBaud());
+        uart_sendStr(message);
+    }
+
+    else if (strcmp(command.name, "tasks") == 0)
+    { // report where the processor's time goes
+        char message[200];
+        sched_stats_t stats;
+        sched_load_t load;
+        uint32_t busy_us = 0;
+        int i;
+
+        for (i = 0; sched_get_stats(i, &stats); i++)
+        {
+            sprintf(message,
+                    "%s: every %lu ms, %lu runs, %lu us average, %lu us most, %lu ms late at most, %lu late, %lu overruns\n\r",
+                    stats.name, (unsigned long) stats.period_ms,
+                    (unsigned long) stats.runs,
+                    (unsigned long) (stats.runs ? stats.total_us / stats.runs : 0),
+                    (unsigned long) stats.max_us,
+                    (unsigned long) stats.max_late_ms,
+                    (unsigned long) stats.late,
+                    (unsigned long) stats.overruns);
+            uart_sendStr(message);
+            busy_us += stats.total_us;
+        }
+
+        sched_get_load(&load);
+        sprintf(message, "Load: %lu ms, %lu ms in tasks, %lu ms idle, %lu ms waiting in sleeps\n\r",
+                (unsigned long) load.elapsed_ms,
+                (unsigned long) (busy_us / 1000),
+                (unsigned long) (load.idle_us / 1000),
+                (unsigned long) (load.sleep_us / 1000));
+        uart_sendStr(message);
+
+        if (command.argc == 1 && command.argv[0] == 0)
+        {
+            sched_reset_stats();
+        }
+    }
+
+    else if (strcmp(command.name, "bench") == 0)
+    { // measure the operator link throughput
+        link_benchmark((command.argc == 1 && command.argv[0] > 0) ? command.argv[0] : LINK_BENCHMARK_BYTES);
+    }
+
+    else
+    {
+        uart_sendStr("Unknown command.\n\r");
+    }
+
+}
+
+///// Plays the finish song.
+///** This method plays "We Are the Champions" by Queen once the power LED is done flashing.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/8/2018
+// */
+static void finish_song()
+{
+    unsigned char notes[41] = { 62, 61, 62, 61, 57, 54, 59, 54, 57, 62, 64, 66,
+                                69, 66, 59, 61, 59, 59, 57, 59, 57, 55, 67, 66,
+                                67, 66, 64, 66, 62, 67, 66, 62, 67, 65, 62, 67,
+                                65, 62, 60, 57, 62 };
+
+    unsigned char duration[41] = { 32, 16, 16, 32, 32, 32, 32, 16, 32, 16, 16,
+                                   32, 32, 16, 16, 16, 32, 32, 32, 16, 16, 32,
+                                   32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+                                   32, 32, 32, 32, 32, 16, 16, 64 };
+
+    // Load the song
+    oi_loadSong(1, 41, notes, duration);
+
+    // Play the song
+    oi_play_song(1);
+}
+
+///// Flashes the power light.
+///** This method is a deferred callback that toggles the power LED every FINISH_FLASH_MS,
+// * then plays the song after FINISH_FLASHES toggles.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/8/2018
+// */
+static void finish_flash()
+{
+    finish_flashes++;
+
+    // The LED started on, so odd toggles turn it off
+    oi_setLeds(0, 0, 0, (finish_flashes % 2) ? 0 : 255);
+
+    if (finish_flashes < FINISH_FLASHES)
+    {
+        sched_after("flash", finish_flash, FINISH_FLASH_MS);
+    }
+    else
+    {
+        finish_song();
+    }
+}
+
+///// Flashes the power light and plays song for robot.
+///** This method signals that the robot is in the finishing location by playing a "We Are the Champions" by Queen and flashing the power LED.
+// * The flashes and the song run from the scheduler, so this returns right away.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/8/2018
+// */
+void finish()
+{
+    // Turn on the LED
+    oi_setLeds(0, 0, 0, 255);
+    finish_flashes = 0;
+
+    if (sched_after("flash", finish_flash, FINISH_FLASH_MS) < 0)
+    {
+        finish_song();
+    }
+}
+
+///// Starts a sweep in the direction set by the sweep mode.
+///**
+// * Return-to-zero sweeps always run from 0 to 180 degrees.
+// * Bidirectional sweeps start where the servo was left by the last sweep.
+// * @param step The number of degrees between samples.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/21/2018
+// */
+static void start_sweep(int step)
+{
+    if (!sweep_bidirectional || direction == 1)
+    {
+        sweep_start_step(0, 180, step);
+    }
+    else
+    {
+        sweep_start_step(180, 0, step);
+    }
+}
+
+///// Has the sweep task send the sweep that was just started.
+///**
+// * @param pass The pass of the sweep, SWEEP_PASS_ONLY or SWEEP_PASS_COARSE.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/9/2018
+// */
+static void send_sweep(int pass)
+{
+    sweep_sent = 0;
+    sweep_pass = pass;
+}
+
+///// Leaves the servo ready for the next sweep.
+///**
+// * Return-to-zero sweeps move the servo back to 0 degrees.
+// * Bidirectional sweeps leave the servo where it is and start the next sweep from the nearest end.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/21/2018
+// */
+static void finish_sweep()
+{
+    if (sweep_bidirectional)
+    {
+        direction = (angle < 90);
+    }
+    else
+    {
+        // Move the servo to 0 degrees. The next sweep waits for it to get there.
+        servo_start(0);
+    }
+}
+
+///// Finds the objects in the last sweep, sends them to Putty, adds the sweep to the map, and replans the path.
+///**
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/21/2018
+// */
+static void send_objects()
+{
+    int count = detect_objects();
+
+    int i = 0;
+
+    // Send the object information back to Putty
+    for (i = 0; i < count; i++)
+    {
+        telemetry_object(&objects[i]);
+    }
+
+    telemetry_end(objects_dropped);
+
+    // Add the sweep to the map, and keep the ground station's copy up to date
+    grid_add_sweep();
+    if (telemetry_binary)
+    {
+        grid_send();
+    }
+
+    // The sweep may have blocked or cleared part of the path
+    if (plan_has_goal())
+    {
+        send_plan();
+    }
+
+}
+
+///// Sweep for tall objects.
+///**
+// * This method is used to make the servo, ping, and ir sensors sweep and detect tall objects that are 180 degrees in front of the robot.
+// * It sends to Putty the detected object information as well as the degree location of the servo,
+// * the distance reading on the ir sensor, and the distance reading on the ping sensor.
+// * The sweep distance is between 10-50cm in front of the robot.
+// * This method starts the sweep and returns. The sweep task sends the data and the objects.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/8/2018
+// */
+void sweep_info()
+{
+    // Sweep and send the data for each degree to Putty as it completes.
+    telemetry_begin();
+    start_sweep(1);
+    send_sweep(SWEEP_PASS_ONLY);
+}
+
+///// Sweep for tall objects in part of the range.
+///**
+// * This method sweeps from the start degree to the end degree, sampling every step degrees,
+// * and sends to Putty the same data and object information as sweep_info for that part of the range.
+// * This method starts the sweep and returns. The sweep task sends the data and the objects.
+// * @param start The first degree to sample.
+// * @param end The last degree to sample. May be below start to sweep toward 0.
+// * @param step The number of degrees between samples.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/30/2018
+// */
+void sweep_range(int start, int end, int step)
+{
+    telemetry_begin();
+    sweep_clear();
+    sweep_start_step(start, end, step);
+    send_sweep(SWEEP_PASS_ONLY);
+}
+
+///// Sweep for tall objects, only sampling every degree around object edges.
+///**
+// * This method makes a coarse sweep that samples every SWEEP_COARSE_STEP degrees, then sweeps every degree
+// * between two neighbouring coarse samples that disagree on whether there is an object, to find the object edges.
+// * The degrees between two that agree are filled in from the nearer one when the objects are found.
+// * It sends to Putty the same data and object information as sweep_info, plus the number of samples taken.
+// * This method starts the coarse pass and returns. The sweep task starts the fine pass once the coarse pass is sent.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/21/2018
+// */
+void sweep_adaptive()
+{
+    sweep_started_ms = timer_getMillis();
+
+    // Coarse pass
+    telemetry_begin();
+    sweep_clear();
+    start_sweep(SWEEP_COARSE_STEP);
+    send_sweep(SWEEP_PASS_COARSE);
+}
+
+///// Finds the sectors of the fine pass of an adaptive sweep.
+///**
+// * An object edge lies between two neighbouring coarse samples where one sees an object and the other does not.
+// * Every degree between them goes into a sector.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/21/2018
+// */
+static void find_sectors()
+{
+    // Stores whether each degree needs to be sampled in the fine pass
+    char refine[SWEEP_DEGREES];
+
+    int degree = 0;
+    int i = 0;
+
+    fusion_run();
+    memset(refine, 0, sizeof(refine));
+    for (degree = 0; degree < 180; degree += SWEEP_COARSE_STEP)
+    {
+        int next = (degree + SWEEP_COARSE_STEP > 180) ? 180 : degree + SWEEP_COARSE_STEP;
+        if (object_at(degree) != object_at(next))
+        {
+            for (i = degree + 1; i < next; i++)
+            {
+                refine[i] = 1;
+            }
+        }
+    }
+
+    // Group the degrees to refine into sectors
+    sectors = 0;
+    for (degree = 0; degree <= 180; degree++)
+    {
+        if (refine[degree] && (degree == 0 || !refine[degree - 1]))
+        {
+            sector_start[sectors] = degree;
+        }
+        if (refine[degree] && (degree == 180 || !refine[degree + 1]))
+        {
+            sector_end[sectors] = degree;
+            sectors++;
+        }
+    }
+    sector_next = 0;
+}
+
+///// Starts the next sector of the fine pass of an adaptive sweep.
+///**
+// * The sectors are swept starting with the one nearest the servo.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/21/2018
+// */
+static void sweep_sector()
+{
+    if (angle >= 90)
+    {
+        int sector = sectors - 1 - sector_next;
+        sweep_start(sector_end[sector], sector_start[sector]);
+    }
+    else
+    {
+        sweep_start(sector_start[sector_next], sector_end[sector_next]);
+    }
+    sector_next++;
+}
+
+///// Sends the readings of the running sweep to Putty as they complete, as text or binary frames.
+///** This method is the periodic sweep task. It sends the degrees completed since it last ran without waiting for more.
+// * Once a pass is over it starts the next one, and after the last one it sends the objects and replies "Sweep Done.",
+// * or calls the function the command left in sweep_then instead.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/21/2018
+// */
+static void sweep_task()
+{
+    sweep_sample_t *sample;
+
+    if (sweep_pass == SWEEP_PASS_NONE)
+    {
+        return;
+    }
+
+    while ((sample = sweep_poll()) != 0)
+    {
+        telemetry_sample(sample);
+        sweep_sent++;
+    }
+
+    if (!sweep_is_done())
+    {
+        return;
+    }
+
+    // Refine the edges found by the coarse pass, one sector per pass
+    if (sweep_pass == SWEEP_PASS_COARSE)
+    {
+        find_sectors();
+        sweep_pass = SWEEP_PASS_FINE;
+    }
+    if (sweep_pass == SWEEP_PASS_FINE && sector_next < sectors)
+    {
+        sweep_sector();
+        return;
+    }
+
+    finish_sweep();
+
+    telemetry_summary((sweep_pass == SWEEP_PASS_ONLY) ? sweep_time() : timer_getMillis() - sweep_started_ms,
+                      sweep_sent);
+    sweep_pass = SWEEP_PASS_NONE;
+
+    send_objects();
+
+    void (*then)() = sweep_then;
+    sweep_then = 0;
+    if (then)
+    {
+        then();
+    }
+    else
+    {
+        uart_sendStr("Sweep Done.\n\r");
+    }
+}
+
+///// Runs the next command once it has been received.
+///** This method is the periodic command task. It prompts mission control for a command, takes in the received bytes,
+// * and runs a command once a whole line is queued. Nothing waits for bytes, so the other tasks keep running.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 5/8/2018
+// */
+static void command_task()
+{
+    if (!command_prompted)
+    {
+        // Signal to mission control that a new command has been sent.
+        uart_sendStr("New Command: \n\r");
+        command_prompted = 1;
+    }
+
+    command_poll();
+
+    if (command_pending())
+    {
+        robot_command();
+        command_prompted = 0;
+    }
+}
+
+///// Main method
+///** Main method for Mars Rover project. This calls and runs all the information.
+// * @author Matthew Dickey, Yung-Hsueh Lee, Matthew Orth, and Katelyn Perkins
+// * @date 4/8/2018
+// */
+void main()
+{
+    // Initialize the button and lcd
+    lcd_init();
+
+    // Initialize the uart
+    uart_init();
+
+    // Start the millisecond system tick
+    timer_tickInit();
+
+    //Initialize the open interface
+    sensor_data = oi_alloc();
+    oi_init(sensor_data);
+
+    // Have the Roomba stream the bump, cliff, and odometry packets the movement loops use
+    oi_streamPreset(OI_PRESET_MOTION);
+
+    // Step moves and sweeps from the system tick
+    if (!motion_init(sensor_data) || !sweep_init())
+    {
+        uart_sendStr("No free tick hook, moves or sweeps will not run.\n\r");
+    }
+
+    // Initialize the IR sensor and sample it in the background
+    adc_init();
+    adc_dma_init();
+
+    // Initialize the Ping sensor
+    ping_init();
+    timer3_init();
+
+    // Initialize the servo
+    timer1_init();
+    gpio_init();
+
+    // Run the timer wheel from the system tick
+    sched_init();
+
+    // Move servo to the initial position of 0 degrees
+    move_servo(0);
+
+    // Run the moves and send the sweeps from their own tasks
+    if (!move_init() || sched_every("sweep", sweep_task, SWEEP_SEND_MS) < 0)
+    {
+        uart_sendStr("No free task, moves or sweeps will not finish.\n\r");
+    }
+
+    // Receive the signal on how to move the robot
+    sched_every("command", command_task, COMMAND_POLL_MS);
+
+    // Run the tasks forever
+    sched_run();
+}
@@ -1,18 +1,25 @@
-/*
- * Header file for UI.c file
-*/
-
-#ifndef UI_H_
-#define UI_H_
-
-// Sends commands to the robot
-void robot_command();
-
-// Signals the robot is in the finishing location by sounding the alarm and flashing the LED.
-void finish();
-
-// Sweeps for objects. Returns:
-// Object distances away from robot, linear widths, degree width, and object number
-void sweep_info();
-
-#endif /* UI_H_ */
+/*
+ * Header file for UI.c file
+*/
+
+#ifndef UI_H_
+#define UI_H_
+
+// Sends commands to the robot
+void robot_command();
+
+// Signals the robot is in the finishing location by sounding the alarm and flashing the LED.
+void finish();
+
+// Sweeps for objects. Returns:
+// Object distances away from robot, linear widths, degree width, and object number
+void sweep_info();
+
+// Sweeps for objects like sweep_info between the start and end degree, sampling every step degrees
+void sweep_range(int start, int end, int step);
+
+// Sweeps for objects like sweep_info, but only samples every degree near objects.
+// Also sends the number of samples taken.
+void sweep_adaptive();
+
+#endif /* UI_H_ */